@@ -0,0 +1,183 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <vector>
+
+#import "POPAnimatorPrivate.h"
+#import "POPBasicAnimationInternal.h"
+#import "POPBenchmarkHarness.h"
+#import "POPDecayAnimationInternal.h"
+#import "POPSpringAnimationInternal.h"
+
+using namespace POP::Benchmark;
+
+@interface POPAnimator (Benchmark)
+- (void)_processPendingList;
+@end
+
+// a display frame at 60 Hz
+static const CFTimeInterval kFrameDt = 1. / 60.;
+
+// arbitrary media time the benchmark clock starts from
+static const CFTimeInterval kBeginTime = 1000;
+
+/**
+ Synthetic animation target, values written to plain memory.
+ */
+@interface POPBenchmarkTarget : NSObject
+{
+@public
+  CGFloat _values[2];
+}
+@end
+
+@implementation POPBenchmarkTarget
+@end
+
+static POPAnimatableProperty *benchmarkProperty()
+{
+  return [POPAnimatableProperty propertyWithName:@"com.facebook.pop.benchmark.point" initializer:^(POPMutableAnimatableProperty *prop) {
+    prop.readBlock = ^(id obj, CGFloat values[]) {
+      values[0] = ((POPBenchmarkTarget *)obj)->_values[0];
+      values[1] = ((POPBenchmarkTarget *)obj)->_values[1];
+    };
+    prop.writeBlock = ^(id obj, const CGFloat values[]) {
+      ((POPBenchmarkTarget *)obj)->_values[0] = values[0];
+      ((POPBenchmarkTarget *)obj)->_values[1] = values[1];
+    };
+    prop.threshold = 0.01;
+  }];
+}
+
+/**
+ Returns the animation of the scene mix.
+ */
+static POPPropertyAnimation *benchmarkAnimation(NSUInteger idx)
+{
+  const SceneAnimation params(idx);
+  POPPropertyAnimation *anim;
+  switch (params.kind) {
+    case SceneAnimation::kSpring: {
+      POPSpringAnimation *spring = [POPSpringAnimation animation];
+      spring.dynamicsTension = params.tension;
+      spring.dynamicsFriction = params.friction;
+      spring.dynamicsMass = 1;
+      spring.toValue = [NSValue valueWithCGPoint:CGPointMake(params.toValue[0], params.toValue[1])];
+      anim = spring;
+      break;
+    }
+    case SceneAnimation::kDecay: {
+      POPDecayAnimation *decay = [POPDecayAnimation animation];
+      decay.velocity = [NSValue valueWithCGPoint:CGPointMake(params.velocity[0], params.velocity[1])];
+      anim = decay;
+      break;
+    }
+    case SceneAnimation::kBasic: {
+      POPBasicAnimation *basic = [POPBasicAnimation easeInEaseOutAnimation];
+      basic.duration = params.duration;
+      basic.toValue = [NSValue valueWithCGPoint:CGPointMake(params.toValue[0], params.toValue[1])];
+      anim = basic;
+      break;
+    }
+  }
+  anim.property = benchmarkProperty();
+  anim.fromValue = [NSValue valueWithCGPoint:CGPointMake(params.fromValue[0], params.fromValue[1])];
+  anim.removedOnCompletion = YES;
+  return anim;
+}
+
+/**
+ Headless animator at a fixed animation count, advanced by an explicit clock rather than the display link.
+ */
+struct POPBenchmarkScene
+{
+  POPAnimator *animator;
+  NSMutableArray *targets;
+  CFTimeInterval time;
+  NSUInteger added;
+
+  explicit POPBenchmarkScene(NSUInteger count) : time(kBeginTime), added(0)
+  {
+    animator = [[POPAnimator alloc] init];
+    animator.disableDisplayLink = YES;
+    targets = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      POPBenchmarkTarget *target = [[POPBenchmarkTarget alloc] init];
+      [targets addObject:target];
+      add(target);
+    }
+    start();
+  }
+
+  void add(POPBenchmarkTarget *target)
+  {
+    [animator addAnimation:benchmarkAnimation(added++) forObject:target key:@"benchmark"];
+  }
+
+  // starts pending animations at the current time, as the run loop observer would
+  void start()
+  {
+    animator.beginTime = time;
+    [animator _processPendingList];
+    animator.beginTime = 0;
+  }
+
+  void render()
+  {
+    time += kFrameDt;
+    [animator renderTime:time];
+  }
+
+  // replaces the animations of count targets, round robin
+  void churn(NSUInteger count)
+  {
+    @autoreleasepool {
+      for (NSUInteger idx = 0; idx < count; idx++) {
+        POPBenchmarkTarget *target = targets[(added + idx) % targets.count];
+        [animator removeAnimationForObject:target key:@"benchmark"];
+      }
+      for (NSUInteger idx = 0; idx < count; idx++) {
+        add(targets[added % targets.count]);
+      }
+      start();
+    }
+  }
+};
+
+int main(int argc, const char *argv[])
+{
+  Options options;
+  if (!options.parse(argc, argv)) {
+    fprintf(stderr, "usage: %s [--quick] [--filter name] [--samples frames]\n", argv[0]);
+    return 1;
+  }
+
+  SceneRunner runner(options);
+  printf("state bytes: spring %zu, decay %zu, basic %zu\n", sizeof(_POPSpringAnimationState), sizeof(_POPDecayAnimationState), sizeof(_POPBasicAnimationState));
+  runner.printHeader();
+
+  const std::vector<size_t> counts = runner.counts();
+  for (size_t count : counts) {
+    if (runner.selected("step")) {
+      @autoreleasepool {
+        runner.step<POPBenchmarkScene>(count);
+      }
+    }
+  }
+  for (size_t count : counts) {
+    if (runner.selected("churn")) {
+      @autoreleasepool {
+        runner.churn<POPBenchmarkScene>(count);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,346 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef POP_POPBenchmarkHarness_h
+#define POP_POPBenchmarkHarness_h
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace POP {
+namespace Benchmark {
+
+  /**
+   Keeps a value alive and opaque to the optimizer.
+   */
+  template <typename T>
+  inline void doNotOptimize(T const &value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T *sink;
+    sink = &value;
+#endif
+  }
+
+  /**
+   Prevents the optimizer from caching memory across iterations.
+   */
+  inline void clobberMemory()
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+  }
+
+  inline double nowSeconds()
+  {
+    using namespace std::chrono;
+    return duration_cast<duration<double>>(steady_clock::now().time_since_epoch()).count();
+  }
+
+  /**
+   Harness options, parsed from the command line.
+   */
+  struct Options
+  {
+    // substring a benchmark name must contain to run
+    std::string filter;
+    // timed samples per benchmark
+    unsigned samples;
+    // target duration of a single sample, in seconds
+    double sampleTime;
+
+    Options() : samples(15), sampleTime(0.01) {}
+
+    // returns false on unrecognized arguments
+    bool parse(int argc, const char *argv[])
+    {
+      for (int idx = 1; idx < argc; idx++) {
+        const char *arg = argv[idx];
+        if (0 == strcmp(arg, "--quick")) {
+          samples = 3;
+          sampleTime = 0.001;
+        } else if (0 == strcmp(arg, "--filter") && idx + 1 < argc) {
+          filter = argv[++idx];
+        } else if (0 == strcmp(arg, "--samples") && idx + 1 < argc) {
+          samples = std::max(1, atoi(argv[++idx]));
+        } else if (0 == strcmp(arg, "--sample-time") && idx + 1 < argc) {
+          sampleTime = std::max(0.0001, atof(argv[++idx]));
+        } else {
+          return false;
+        }
+      }
+      return true;
+    }
+  };
+
+  /**
+   Statistics of one benchmark, per operation.
+   */
+  struct Result
+  {
+    std::string name;
+    uint64_t iterations; // per sample
+    double median;       // ns/op
+    double min;          // ns/op
+    double max;          // ns/op
+    double mad;          // median absolute deviation, ns/op
+
+    double opsPerSecond() const
+    {
+      return median > 0 ? 1e9 / median : 0;
+    }
+  };
+
+  /**
+   Runs a benchmark body a given number of times. The body performs a single operation per call.
+   */
+  typedef std::function<void(uint64_t iterations)> Body;
+
+  /**
+   Calibrates iteration counts to the sample time, then reports robust per operation statistics across samples.
+   */
+  class Runner
+  {
+    Options _options;
+    std::vector<Result> _results;
+
+    double time(const Body &body, uint64_t iterations)
+    {
+      const double start = nowSeconds();
+      body(iterations);
+      clobberMemory();
+      return nowSeconds() - start;
+    }
+
+    uint64_t calibrate(const Body &body)
+    {
+      uint64_t iterations = 1;
+      for (;;) {
+        const double elapsed = time(body, iterations);
+        if (elapsed >= _options.sampleTime || iterations >= (1ull << 40)) {
+          return iterations;
+        }
+        // grow towards the target, at most 10x per round
+        const double factor = elapsed > 0 ? _options.sampleTime * 1.2 / elapsed : 10;
+        iterations = std::max(iterations + 1, (uint64_t)(iterations * std::min(10.0, factor)));
+      }
+    }
+
+    static double median(std::vector<double> values)
+    {
+      std::sort(values.begin(), values.end());
+      const size_t n = values.size();
+      return 0 == n % 2 ? (values[n / 2 - 1] + values[n / 2]) / 2 : values[n / 2];
+    }
+
+  public:
+    explicit Runner(const Options &options) : _options(options) {}
+
+    void run(const char *name, const Body &body)
+    {
+      if (!_options.filter.empty() && std::string(name).find(_options.filter) == std::string::npos) {
+        return;
+      }
+
+      // warm caches and branch predictors before calibrating
+      body(16);
+      const uint64_t iterations = calibrate(body);
+
+      std::vector<double> samples;
+      for (unsigned idx = 0; idx < _options.samples; idx++) {
+        samples.push_back(time(body, iterations) * 1e9 / iterations);
+      }
+
+      Result result;
+      result.name = name;
+      result.iterations = iterations;
+      result.median = median(samples);
+      result.min = *std::min_element(samples.begin(), samples.end());
+      result.max = *std::max_element(samples.begin(), samples.end());
+
+      std::vector<double> deviations;
+      for (double sample : samples) {
+        deviations.push_back(std::abs(sample - result.median));
+      }
+      result.mad = median(deviations);
+
+      printf("%-40s %12.2f %12.2f %8.1f%% %16.0f %12llu\n", name, result.median, result.min, result.median > 0 ? 100. * result.mad / result.median : 0, result.opsPerSecond(), (unsigned long long)iterations);
+      fflush(stdout);
+      _results.push_back(result);
+    }
+
+    void printHeader() const
+    {
+      printf("%-40s %12s %12s %9s %16s %12s\n", "benchmark", "ns/op", "min ns/op", "+/-", "ops/sec", "iterations");
+    }
+
+    const std::vector<Result> &results() const
+    {
+      return _results;
+    }
+  };
+
+  /**
+   Resident memory of the process in bytes, or 0 where unsupported.
+   */
+  inline uint64_t residentBytes()
+  {
+#if defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (KERN_SUCCESS != task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count)) {
+      return 0;
+    }
+    return info.resident_size;
+#elif defined(__linux__)
+    unsigned long size = 0, resident = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (NULL == f) {
+      return 0;
+    }
+    if (2 != fscanf(f, "%lu %lu", &size, &resident)) {
+      resident = 0;
+    }
+    fclose(f);
+    return (uint64_t)resident * sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+  }
+
+  inline double percentile(std::vector<double> values, double p)
+  {
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(p * (values.size() - 1) + 0.5))];
+  }
+
+  /**
+   Animation of the scene benchmark mix, cycling spring, decay and basic. Parameters keep each animation in flight for the measured frames; drivers map them onto their own animation types.
+   */
+  struct SceneAnimation
+  {
+    enum Kind { kSpring, kDecay, kBasic } kind;
+    double fromValue[2];
+    double toValue[2];   // spring and basic
+    double velocity[2];  // decay
+    double tension;      // spring, a quarter of the default bounciness 4 speed 12 constants
+    double friction;     // spring
+    double duration;     // basic, ease in ease out
+
+    explicit SceneAnimation(size_t idx) : kind((Kind)(idx % 3)), tension(187.9 / 4), friction(24.6 / 4), duration(4)
+    {
+      const double offset = idx % 97;
+      fromValue[0] = offset;
+      fromValue[1] = 0;
+      toValue[0] = kBasic == kind ? offset : 500 + offset;
+      toValue[1] = kBasic == kind ? 200 : 300 - offset;
+      velocity[0] = 2000 + offset;
+      velocity[1] = -1500;
+    }
+  };
+
+  /**
+   Scene benchmarks over animators of increasing animation counts. A scene is constructed with an animation count, and provides render(), advancing a frame, and churn(count), replacing count animations.
+   */
+  class SceneRunner
+  {
+    Options _options;
+
+    template <typename Scene, typename Frame>
+    static std::vector<double> timeFrames(Scene &scene, unsigned frameCount, Frame frame)
+    {
+      std::vector<double> frames;
+      for (unsigned idx = 0; idx < frameCount; idx++) {
+        const double start = nowSeconds();
+        frame(scene);
+        frames.push_back(nowSeconds() - start);
+      }
+      return frames;
+    }
+
+  public:
+    explicit SceneRunner(const Options &options) : _options(options) {}
+
+    // 1k, 10k and 100k animations; only 1k when quick
+    std::vector<size_t> counts() const
+    {
+      if (_options.samples < Options().samples) {
+        return {1000};
+      }
+      return {1000, 10000, 100000};
+    }
+
+    unsigned frameCount() const
+    {
+      return std::max(_options.samples * 4, 8u);
+    }
+
+    bool selected(const char *name) const
+    {
+      return _options.filter.empty() || std::string(name).find(_options.filter) != std::string::npos;
+    }
+
+    void printHeader() const
+    {
+      printf("%-24s %8s %12s %12s %12s %14s\n", "benchmark", "count", "median ms", "p95 ms", "ns/anim", "bytes/anim");
+    }
+
+    void printFrames(const char *name, size_t count, const std::vector<double> &frames, int64_t bytes) const
+    {
+      const double median = percentile(frames, 0.5);
+      printf("%-24s %8lu %12.3f %12.3f %12.1f %14.1f\n", name, (unsigned long)count, median * 1e3, percentile(frames, 0.95) * 1e3, median * 1e9 / count, (double)bytes / count);
+      fflush(stdout);
+    }
+
+    // frames of a scene at a fixed animation count, with memory of building the scene
+    template <typename Scene>
+    void step(size_t count)
+    {
+      const uint64_t initialBytes = residentBytes();
+      Scene scene(count);
+      const int64_t bytes = (int64_t)(residentBytes() - initialBytes);
+      printFrames("step", count, timeFrames(scene, frameCount(), [](Scene &s) { s.render(); }), bytes);
+    }
+
+    // frames replacing a tenth of the animations each, with memory growth over the frames
+    template <typename Scene>
+    void churn(size_t count)
+    {
+      Scene scene(count);
+      const size_t churnCount = std::max((size_t)1, count / 10);
+      const uint64_t initialBytes = residentBytes();
+      const std::vector<double> frames = timeFrames(scene, frameCount(), [churnCount](Scene &s) {
+        s.churn(churnCount);
+        s.render();
+      });
+      printFrames("churn 10%", count, frames, (int64_t)(residentBytes() - initialBytes));
+    }
+  };
+
+}
+}
+
+#endif
@@ -0,0 +1,385 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "POPBenchmarkHarness.h"
+#include "POPMath.h"
+#include "POPSpringSolver.h"
+#include "POPTraceBuffer.h"
+#include "POPVector.h"
+#include "TransformationMatrix.h"
+#include "UnitBezier.h"
+
+using namespace POP;
+using namespace POP::Benchmark;
+
+// a display frame at 60 Hz
+static const double kFrameDt = 1. / 60.;
+
+// spring constants of a default spring animation, bounciness 4 speed 12
+static const double kSpringTension = 187.9;
+static const double kSpringFriction = 24.6;
+
+static void benchmarkSpringSolver(Runner &runner)
+{
+  runner.run("SpringSolver4d::advance rk4", [](uint64_t iterations) {
+    SpringSolver4d solver(kSpringTension, kSpringFriction);
+    solver.setThreshold(0.01);
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      // restart from displacement, keeping each frame representative of an animation in flight
+      SSState4d state;
+      state.p = Vector4d(100, 50, 1, 0.5);
+      state.v = Vector4d(0, 0, 0, 0);
+      solver.advance(state, idx * kFrameDt, kFrameDt);
+      doNotOptimize(state);
+    }
+  });
+
+  runner.run("SpringSolver4d::advance rk4 matrix", [](uint64_t iterations) {
+    SpringSolver4d solver(kSpringTension, kSpringFriction);
+    solver.setThreshold(0.01);
+    solver.setIntegrator(kSpringSolverIntegratorRK4Matrix);
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      SSState4d state;
+      state.p = Vector4d(100, 50, 1, 0.5);
+      state.v = Vector4d(0, 0, 0, 0);
+      solver.advance(state, idx * kFrameDt, kFrameDt);
+      doNotOptimize(state);
+    }
+  });
+
+  runner.run("SpringSolver4d::advance dopri", [](uint64_t iterations) {
+    SpringSolver4d solver(kSpringTension, kSpringFriction);
+    solver.setThreshold(0.01);
+    solver.setIntegrator(kSpringSolverIntegratorDormandPrince);
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      SSState4d state;
+      state.p = Vector4d(100, 50, 1, 0.5);
+      state.v = Vector4d(0, 0, 0, 0);
+      solver.advance(state, idx * kFrameDt, kFrameDt);
+      doNotOptimize(state);
+    }
+  });
+}
+
+// bounciness and speed of the spring grid, from stiff and damped to soft and bouncy
+static const double kGridBounciness[] = {0, 5, 10, 15, 20};
+static const double kGridSpeed[] = {0, 5, 10, 15, 20};
+
+// frames of a 2s animation
+static const unsigned kGridFrameCount = 120;
+
+/**
+ Step counts and accuracy of a whole animation of a grid spring.
+ */
+struct SpringGridRun
+{
+  NSUInteger stepCount;
+  NSUInteger rejectedStepCount;
+  double maxError; // largest position error against the exact solution at frame times
+};
+
+static SpringGridRun runGridSpring(SpringSolverIntegrator integrator, double bounciness, double speed)
+{
+  double tension, friction;
+  POPBouncy3Convert(bounciness, speed, tension, friction);
+  SpringSolver4d solver(tension, friction);
+  solver.setThreshold(0.01);
+  solver.setIntegrator(integrator);
+
+  const double p0 = 100, v0 = -500;
+  SSState4d state;
+  state.p = Vector4d(p0, 0, 0, 0);
+  state.v = Vector4d(v0, 0, 0, 0);
+
+  SpringGridRun run = {0, 0, 0};
+  for (unsigned frame = 0; frame < kGridFrameCount; frame++) {
+    solver.advance(state, frame * kFrameDt, kFrameDt);
+    double p, v;
+    spring_exact(tension, friction, 1, p0, v0, (frame + 1) * kFrameDt, p, v);
+    run.maxError = std::max(run.maxError, std::abs(p - state.p.x));
+  }
+  doNotOptimize(state);
+
+  run.stepCount = solver.stepCount();
+  run.rejectedStepCount = solver.rejectedStepCount();
+  return run;
+}
+
+static void runSpringGrid(SpringSolverIntegrator integrator)
+{
+  for (double bounciness : kGridBounciness) {
+    for (double speed : kGridSpeed) {
+      doNotOptimize(runGridSpring(integrator, bounciness, speed));
+    }
+  }
+}
+
+static void benchmarkSpringGrid(Runner &runner)
+{
+  runner.run("SpringSolver4d grid 2s rk4", [](uint64_t iterations) {
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      runSpringGrid(kSpringSolverIntegratorRK4);
+    }
+  });
+
+  runner.run("SpringSolver4d grid 2s dopri", [](uint64_t iterations) {
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      runSpringGrid(kSpringSolverIntegratorDormandPrince);
+    }
+  });
+}
+
+/**
+ Prints step counts, rejected steps and maximum error of fixed step and adaptive integration per grid spring.
+ */
+static void printSpringGrid(const Options &options)
+{
+  if (!options.filter.empty() && std::string("SpringSolver4d grid").find(options.filter) == std::string::npos) {
+    return;
+  }
+
+  printf("\n%10s %6s %10s %10s %12s %10s %10s %12s\n", "bounciness", "speed", "rk4 steps", "rejected", "max error", "dopri steps", "rejected", "max error");
+  for (double bounciness : kGridBounciness) {
+    for (double speed : kGridSpeed) {
+      const SpringGridRun fixed = runGridSpring(kSpringSolverIntegratorRK4, bounciness, speed);
+      const SpringGridRun adaptive = runGridSpring(kSpringSolverIntegratorDormandPrince, bounciness, speed);
+      printf("%10.0f %6.0f %10lu %10lu %12.3g %11lu %10lu %12.3g\n", bounciness, speed,
+             (unsigned long)fixed.stepCount, (unsigned long)fixed.rejectedStepCount, fixed.maxError,
+             (unsigned long)adaptive.stepCount, (unsigned long)adaptive.rejectedStepCount, adaptive.maxError);
+    }
+  }
+}
+
+static void benchmarkSolverAllocation(Runner &runner)
+{
+  runner.run("SpringSolver4d new/delete", [](uint64_t iterations) {
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      SpringSolver4d *solver = new SpringSolver4d(kSpringTension, kSpringFriction);
+      doNotOptimize(solver);
+      delete solver;
+    }
+  });
+}
+
+static void benchmarkDecay(Runner &runner)
+{
+  runner.run("decay_position count=2", [](uint64_t iterations) {
+    CGFloat x[2] = {0, 0};
+    CGFloat v[2] = {2000, -1500};
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      decay_position(x, v, 2, kFrameDt, 0.998);
+      // keep velocity from underflowing to denormals
+      if (0 == (idx & 127)) {
+        v[0] = 2000;
+        v[1] = -1500;
+      }
+      doNotOptimize(x);
+    }
+  });
+}
+
+static void benchmarkUnitBezier(Runner &runner)
+{
+  runner.run("UnitBezier::solve ease-in-out", [](uint64_t iterations) {
+    WebCore::UnitBezier bezier(0.42, 0, 0.58, 1);
+    const double eps = SOLVE_EPS(0.4);
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      const double t = (idx & 1023) / 1023.;
+      doNotOptimize(bezier.solve(t, eps));
+    }
+  });
+}
+
+static void benchmarkInterpolate(Runner &runner)
+{
+  runner.run("POPInterpolateVector count=4", [](uint64_t iterations) {
+    const CGFloat from[4] = {0, 10, 20, 30};
+    const CGFloat to[4] = {100, 90, 80, 70};
+    CGFloat dst[4];
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      POPInterpolateVector(4, dst, from, to, (idx & 1023) / 1023.);
+      doNotOptimize(dst);
+    }
+  });
+}
+
+static void benchmarkVector(Runner &runner)
+{
+  runner.run("Vector4d arithmetic", [](uint64_t iterations) {
+    Vector4d a(1, 2, 3, 4), b(0.5, 0.25, 0.125, 0.0625);
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      a = a * 0.999 + b * 0.001 - b * 0.0005;
+      doNotOptimize(a);
+    }
+  });
+
+  runner.run("Vector::new_vector count=4", [](uint64_t iterations) {
+    const CGFloat values[4] = {1, 2, 3, 4};
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      VectorRef vec(Vector::new_vector(4, values));
+      doNotOptimize(vec);
+    }
+  });
+
+  runner.run("Vector::new_vector cross thread free", [](uint64_t iterations) {
+    // animations created on the main thread may be freed on another
+    std::vector<Vector *> vecs;
+    vecs.reserve(iterations);
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      vecs.push_back(Vector::new_vector(4, NULL));
+    }
+    std::thread([&vecs]() {
+      for (Vector *vec : vecs) {
+        delete vec;
+      }
+    }).join();
+  });
+
+  runner.run("Vector::operator== count=4", [](uint64_t iterations) {
+    const CGFloat values[4] = {1, 2, 3, 4};
+    VectorRef a(Vector::new_vector(4, values));
+    VectorRef b(Vector::new_vector(4, values));
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      doNotOptimize(*a == *b);
+    }
+  });
+
+  runner.run("Vector::norm count=4", [](uint64_t iterations) {
+    const CGFloat values[4] = {1, 2, 3, 4};
+    VectorRef vec(Vector::new_vector(4, values));
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      doNotOptimize(vec->norm());
+    }
+  });
+
+  runner.run("Vector::subRound count=4", [](uint64_t iterations) {
+    const CGFloat values[4] = {1.3, 2.6, 3.1, 4.8};
+    VectorRef vec(Vector::new_vector(4, values));
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      vec->subRound(2);
+      doNotOptimize(vec->data()[0]);
+    }
+  });
+}
+
+static void benchmarkTraceBuffer(Runner &runner)
+{
+  // allocated once, outside of the timed bodies
+  static TraceBuffer buffer(1 << 16);
+
+  runner.run("TraceBuffer::record step", [](uint64_t iterations) {
+    const double values[2] = {0.001, 0.5};
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      buffer.record(kTraceRecordStep, (uint32_t)(idx & 127), idx * kFrameDt, 0, values, 2);
+    }
+    doNotOptimize(buffer.recordedCount());
+  });
+
+  for (uint64_t idx = 0; idx < buffer.capacity(); idx++) {
+    buffer.record(kTraceRecordStep, (uint32_t)(idx & 127), idx * kFrameDt);
+  }
+
+  runner.run("TraceBuffer::copyRecords 64k", [](uint64_t iterations) {
+    std::vector<TraceRecord> records;
+    records.reserve(buffer.capacity());
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      records.clear();
+      doNotOptimize(buffer.copyRecords(records));
+    }
+  });
+}
+
+static WebCore::TransformationMatrix benchmarkTransform()
+{
+  WebCore::TransformationMatrix m;
+  m.translate3d(10, 20, 30);
+  m.rotate3d(15, 30, 45);
+  m.scale3d(1.5, 0.75, 2);
+  m.applyPerspective(500);
+  return m;
+}
+
+static void benchmarkTransformationMatrix(Runner &runner)
+{
+  runner.run("TransformationMatrix::multiply", [](uint64_t iterations) {
+    const WebCore::TransformationMatrix m = benchmarkTransform();
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      WebCore::TransformationMatrix result = m;
+      result.multiply(m);
+      doNotOptimize(result);
+    }
+  });
+
+  runner.run("TransformationMatrix::inverse", [](uint64_t iterations) {
+    const WebCore::TransformationMatrix m = benchmarkTransform();
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      doNotOptimize(m.inverse());
+    }
+  });
+
+  runner.run("TransformationMatrix::decompose", [](uint64_t iterations) {
+    const WebCore::TransformationMatrix m = benchmarkTransform();
+    WebCore::TransformationMatrix::DecomposedType decomp;
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      doNotOptimize(m.decompose(decomp));
+      doNotOptimize(decomp);
+    }
+  });
+
+  runner.run("TransformationMatrix::recompose", [](uint64_t iterations) {
+    WebCore::TransformationMatrix::DecomposedType decomp;
+    benchmarkTransform().decompose(decomp);
+    WebCore::TransformationMatrix m;
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      m.recompose(decomp);
+      doNotOptimize(m);
+    }
+  });
+}
+
+static void benchmarkBouncy(Runner &runner)
+{
+  runner.run("POPBouncy3NoBounce", [](uint64_t iterations) {
+    for (uint64_t idx = 0; idx < iterations; idx++) {
+      doNotOptimize(POPBouncy3NoBounce(50 + (idx & 511)));
+    }
+  });
+}
+
+int main(int argc, const char *argv[])
+{
+  Options options;
+  if (!options.parse(argc, argv)) {
+    fprintf(stderr, "usage: %s [--quick] [--filter name] [--samples count] [--sample-time seconds]\n", argv[0]);
+    return 1;
+  }
+
+  Runner runner(options);
+  runner.printHeader();
+
+  benchmarkSpringSolver(runner);
+  benchmarkSpringGrid(runner);
+  benchmarkSolverAllocation(runner);
+  benchmarkDecay(runner);
+  benchmarkUnitBezier(runner);
+  benchmarkInterpolate(runner);
+  benchmarkVector(runner);
+  benchmarkTraceBuffer(runner);
+  benchmarkTransformationMatrix(runner);
+  benchmarkBouncy(runner);
+
+  printSpringGrid(options);
+  return 0;
+}
@@ -0,0 +1,201 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include "POPBenchmarkHarness.h"
+#include "POPFrameClock.h"
+#include "POPHeadlessAnimator.h"
+#include "POPSpringInstances.h"
+
+using namespace POP;
+using namespace POP::Benchmark;
+
+// a display frame at 60 Hz
+static const double kFrameDt = 1. / 60.;
+
+// arbitrary time the benchmark clock starts from
+static const double kBeginTime = 1000;
+
+// ease in ease out timing function
+static const double kEaseInEaseOut[4] = {0.42, 0, 0.58, 1};
+
+/**
+ Returns the headless animation of the scene mix.
+ */
+static HeadlessAnimation benchmarkAnimation(size_t idx)
+{
+  const SceneAnimation params(idx);
+  const CGFloat fromValue[2] = {(CGFloat)params.fromValue[0], (CGFloat)params.fromValue[1]};
+  const CGFloat toValue[2] = {(CGFloat)params.toValue[0], (CGFloat)params.toValue[1]};
+  HeadlessAnimation anim;
+  switch (params.kind) {
+    case SceneAnimation::kSpring: {
+      anim = HeadlessAnimation::spring(2, toValue, params.tension, params.friction);
+      break;
+    }
+    case SceneAnimation::kDecay: {
+      const CGFloat velocity[2] = {(CGFloat)params.velocity[0], (CGFloat)params.velocity[1]};
+      anim = HeadlessAnimation::decay(2, velocity);
+      break;
+    }
+    case SceneAnimation::kBasic: {
+      anim = HeadlessAnimation::basic(2, toValue, params.duration, kEaseInEaseOut);
+      break;
+    }
+  }
+  anim.setFromValue(fromValue);
+  return anim;
+}
+
+/**
+ Headless animator at a fixed animation count, writing to a contiguous array of points.
+ */
+struct BenchmarkScene
+{
+  HeadlessAnimator animator;
+  std::vector<CGFloat> values;
+  std::vector<HeadlessAnimationID> animations;
+  double time;
+  size_t added;
+
+  explicit BenchmarkScene(size_t count) : values(count * 2), animations(count), time(kBeginTime), added(0)
+  {
+    for (size_t idx = 0; idx < count; idx++) {
+      add(idx);
+    }
+    render();
+  }
+
+  void add(size_t target)
+  {
+    animations[target] = animator.addAnimation(benchmarkAnimation(added++), &values[target * 2]);
+  }
+
+  void render()
+  {
+    animator.renderTime(time);
+    time += kFrameDt;
+    doNotOptimize(values[0]);
+  }
+
+  // replaces the animations of count targets, round robin
+  void churn(size_t count)
+  {
+    for (size_t idx = 0; idx < count; idx++) {
+      const size_t target = added % animations.size();
+      animator.removeAnimation(animations[target]);
+      add(target);
+    }
+  }
+};
+
+/**
+ Offline rendering at 240 Hz, stepping a manual frame clock as fast as frames render.
+ */
+static void benchmarkClock(const SceneRunner &runner, size_t count)
+{
+  BenchmarkScene scene(count);
+  ManualFrameClock clock(240, scene.time);
+  clock.setFrameCallback([&scene](const FrameTime &frame) {
+    scene.animator.renderTime(frame.timestamp);
+  });
+  clock.setRunning(true);
+
+  std::vector<double> frames;
+  for (unsigned idx = 0; idx < runner.frameCount(); idx++) {
+    const double start = nowSeconds();
+    clock.step();
+    frames.push_back(nowSeconds() - start);
+    doNotOptimize(scene.values[0]);
+  }
+  runner.printFrames("clock 240 Hz", count, frames, 0);
+}
+
+/**
+ Springs of shared dynamics, as per animation springs of the headless animator and as instances advanced by one kernel.
+ */
+static void benchmarkSprings(const SceneRunner &runner, size_t count, bool instanced)
+{
+  const SceneAnimation spring(0);
+  const uint64_t initialBytes = residentBytes();
+  std::vector<CGFloat> values(count * 2);
+  HeadlessAnimator animator;
+  SpringInstances instances(2, spring.tension, spring.friction);
+  for (size_t idx = 0; idx < count; idx++) {
+    const CGFloat offset = idx % 97;
+    const CGFloat fromValue[2] = {offset, 0};
+    const CGFloat toValue[2] = {500 + offset, 300 - offset};
+    if (instanced) {
+      instances.addInstance(fromValue, toValue);
+    } else {
+      HeadlessAnimation anim = HeadlessAnimation::spring(2, toValue, spring.tension, spring.friction);
+      anim.setFromValue(fromValue);
+      animator.addAnimation(anim, &values[idx * 2]);
+    }
+  }
+  const int64_t bytes = (int64_t)(residentBytes() - initialBytes);
+
+  const POPMemoryBinding binding = POPMemoryBindingMake(values.data(), 0, 0, 2, CGFLOAT_IS_DOUBLE ? kPOPScalarTypeDouble : kPOPScalarTypeFloat);
+  double time = kBeginTime;
+  animator.renderTime(time);
+  std::vector<double> frames;
+  for (unsigned idx = 0; idx < runner.frameCount(); idx++) {
+    time += kFrameDt;
+    const double start = nowSeconds();
+    if (instanced) {
+      instances.advance(kFrameDt);
+      instances.write(binding, 2 * sizeof(CGFloat));
+    } else {
+      animator.renderTime(time);
+    }
+    frames.push_back(nowSeconds() - start);
+    doNotOptimize(values[0]);
+  }
+  runner.printFrames(instanced ? "instanced spring" : "spring", count, frames, bytes);
+}
+
+int main(int argc, const char *argv[])
+{
+  Options options;
+  if (!options.parse(argc, argv)) {
+    fprintf(stderr, "usage: %s [--quick] [--filter name] [--samples frames]\n", argv[0]);
+    return 1;
+  }
+
+  SceneRunner runner(options);
+  runner.printHeader();
+
+  const std::vector<size_t> counts = runner.counts();
+  for (size_t count : counts) {
+    if (runner.selected("step")) {
+      runner.step<BenchmarkScene>(count);
+    }
+  }
+  for (size_t count : counts) {
+    if (runner.selected("churn")) {
+      runner.churn<BenchmarkScene>(count);
+    }
+  }
+  for (size_t count : counts) {
+    if (runner.selected("clock")) {
+      benchmarkClock(runner, count);
+    }
+  }
+  for (size_t count : counts) {
+    if (runner.selected("spring")) {
+      benchmarkSprings(runner, count, false);
+    }
+    if (runner.selected("instanced spring")) {
+      benchmarkSprings(runner, count, true);
+    }
+  }
+  return 0;
+}
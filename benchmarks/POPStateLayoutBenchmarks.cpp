@@ -0,0 +1,362 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "POPBenchmarkHarness.h"
+#include "POPVector.h"
+
+using namespace POP;
+using namespace POP::Benchmark;
+
+/**
+ Replicas of property animation states, before and after the hot/cold split, with C++ stand-ins for Objective-C fields. Both step through the same fields, as a spring animation does each frame, so that differences come from layout alone.
+ */
+
+// object and block pointers of the Objective-C states
+typedef void *ObjectRef;
+
+// interleaved layout, callbacks and bookkeeping between the fields read every frame
+struct InterleavedState
+{
+  ObjectRef self;
+  uint32_t type;
+  ObjectRef name;
+  NSUInteger ID;
+  double beginTime;
+  double startTime;
+  double lastTime;
+  ObjectRef delegate;
+  ObjectRef animationDidStartBlock;
+  ObjectRef animationDidReachToValueBlock;
+  ObjectRef completionBlock;
+  ObjectRef animationDidApplyBlock;
+  ObjectRef dict;
+  ObjectRef tracer;
+  CGFloat progress;
+  NSInteger repeatCount;
+  bool active:1;
+  bool paused:1;
+  bool delegateDidApply:1;
+  bool tracing:1;
+
+  // property state
+  ObjectRef property;
+  uint32_t valueType;
+  NSUInteger valueCount;
+  VectorRef fromVec;
+  VectorRef toVec;
+  VectorRef currentVec;
+  VectorRef previousVec;
+  VectorRef previous2Vec;
+  VectorRef velocityVec;
+  VectorRef originalVelocityVec;
+  VectorRef distanceVec;
+  CGFloat roundingFactor;
+  NSUInteger clampMode;
+  ObjectRef progressMarkers;
+  ObjectRef progressMarkerState;
+  NSUInteger progressMarkerCount;
+  NSUInteger nextProgressMarkerIdx;
+  CGFloat dynamicsThreshold;
+
+  virtual ~InterleavedState() {}
+  virtual void advance(double dt);
+
+  bool hasDidApplyBlock() const {
+    return NULL != animationDidApplyBlock;
+  }
+};
+
+// out of line callbacks and bookkeeping, allocated on first use
+struct ColdState
+{
+  ObjectRef name;
+  ObjectRef delegate;
+  ObjectRef animationDidStartBlock;
+  ObjectRef animationDidReachToValueBlock;
+  ObjectRef completionBlock;
+  ObjectRef animationDidApplyBlock;
+  ObjectRef visibilityBlock;
+  ObjectRef dict;
+  ObjectRef tracer;
+};
+
+// hot/cold layout, fields read every frame first
+struct SplitState
+{
+  ObjectRef self;
+  uint8_t type;
+  int8_t priority;
+  bool active:1;
+  bool paused:1;
+  bool delegateDidApply:1;
+  bool tracing:1;
+  bool applyBlock:1;
+  uint16_t preferredFramesPerSecond;
+  double beginTime;
+  double startTime;
+  double lastTime;
+  CGFloat progress;
+  NSInteger repeatCount;
+  NSUInteger ID;
+  ColdState *cold;
+
+  // property state
+  ObjectRef property;
+  NSUInteger valueCount;
+  uint32_t valueType;
+  CGFloat roundingFactor;
+  NSUInteger clampMode;
+  CGFloat dynamicsThreshold;
+  ObjectRef progressMarkerState;
+  NSUInteger progressMarkerCount;
+  NSUInteger nextProgressMarkerIdx;
+  VectorRef currentVec;
+  VectorRef toVec;
+  VectorRef fromVec;
+  VectorRef velocityVec;
+  VectorRef previousVec;
+  VectorRef previous2Vec;
+  VectorRef writtenVec;
+  VectorRef originalVelocityVec;
+  VectorRef distanceVec;
+  ObjectRef progressMarkers;
+
+  SplitState() : cold(NULL) {}
+  virtual ~SplitState() { delete cold; }
+  virtual void advance(double dt);
+
+  bool hasDidApplyBlock() const {
+    return applyBlock;
+  }
+};
+
+// sink of values read while stepping
+static CGFloat gStepSink;
+
+// reads and writes the fields a running spring animation does each frame
+template <typename State>
+static void stepState(State *s, double dt)
+{
+  if (!s->active || s->paused || 0 == s->startTime) {
+    return;
+  }
+
+  const CGFloat *current = s->currentVec->data();
+  const CGFloat *to = s->toVec->data();
+  const CGFloat *velocity = s->velocityVec->data();
+  CGFloat sum = s->beginTime + s->repeatCount + s->roundingFactor + s->clampMode + s->dynamicsThreshold;
+  for (NSUInteger idx = 0; idx < s->valueCount; idx++) {
+    sum += current[idx] + to[idx] + velocity[idx];
+  }
+  s->previous2Vec.swap(s->previousVec);
+  s->lastTime += dt;
+  s->progress = sum * dt;
+
+  if (s->progressMarkerCount > s->nextProgressMarkerIdx || s->delegateDidApply || s->hasDidApplyBlock() || s->tracing) {
+    sum += 1;
+  }
+  gStepSink += sum;
+}
+
+void InterleavedState::advance(double dt)
+{
+  stepState(this, dt);
+}
+
+void SplitState::advance(double dt)
+{
+  stepState(this, dt);
+}
+
+#if defined(__linux__)
+
+/**
+ Hardware cache miss counter of the calling thread; unavailable without perf events, eg in virtual machines.
+ */
+class CacheMissCounter
+{
+  int _fd;
+
+public:
+  CacheMissCounter(uint32_t type, uint64_t config) : _fd(-1)
+  {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    _fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+
+  ~CacheMissCounter()
+  {
+    if (_fd >= 0) {
+      close(_fd);
+    }
+  }
+
+  bool available() const {
+    return _fd >= 0;
+  }
+
+  void start()
+  {
+    if (_fd >= 0) {
+      ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  uint64_t stop()
+  {
+    uint64_t count = 0;
+    if (_fd >= 0) {
+      ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (sizeof(count) != read(_fd, &count, sizeof(count))) {
+        count = 0;
+      }
+    }
+    return count;
+  }
+};
+
+static CacheMissCounter *lastLevelMisses()
+{
+  static CacheMissCounter counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  return &counter;
+}
+
+static CacheMissCounter *l1dMisses()
+{
+  static CacheMissCounter counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+  return &counter;
+}
+
+#endif
+
+/**
+ Allocates count running states scattered across the heap, interleaved with unrelated allocations as in an application, and shuffled to defeat prefetching.
+ */
+template <typename State>
+static std::vector<State *> makeStates(size_t count, std::vector<void *> &fillers)
+{
+  std::mt19937 random(1);
+  std::vector<State *> states;
+  states.reserve(count);
+  const CGFloat values[2] = {1, 2};
+  for (size_t idx = 0; idx < count; idx++) {
+    State *s = new State();
+    s->active = true;
+    s->paused = false;
+    s->startTime = 1;
+    s->valueCount = 2;
+    s->currentVec = VectorRef(Vector::new_vector(2, values));
+    s->toVec = VectorRef(Vector::new_vector(2, values));
+    s->fromVec = VectorRef(Vector::new_vector(2, values));
+    s->velocityVec = VectorRef(Vector::new_vector(2, values));
+    s->previousVec = VectorRef(Vector::new_vector(2, values));
+    s->previous2Vec = VectorRef(Vector::new_vector(2, values));
+    states.push_back(s);
+    fillers.push_back(malloc(64 + random() % 256));
+  }
+  std::shuffle(states.begin(), states.end(), random);
+  return states;
+}
+
+template <typename State>
+static void benchmarkLayout(const char *name, size_t count, unsigned passCount)
+{
+  std::vector<void *> fillers;
+  std::vector<State *> states = makeStates<State>(count, fillers);
+
+  // warm up, then keep the fastest pass; count misses over all timed passes
+  for (State *s : states) {
+    s->advance(1. / 60.);
+  }
+
+#if defined(__linux__)
+  lastLevelMisses()->start();
+  l1dMisses()->start();
+#endif
+
+  double best = INFINITY;
+  for (unsigned pass = 0; pass < passCount; pass++) {
+    const double start = nowSeconds();
+    for (State *s : states) {
+      s->advance(1. / 60.);
+    }
+    best = std::min(best, nowSeconds() - start);
+  }
+  doNotOptimize(gStepSink);
+
+  char llc[32] = "-", l1d[32] = "-";
+#if defined(__linux__)
+  const uint64_t llcCount = lastLevelMisses()->stop();
+  const uint64_t l1dCount = l1dMisses()->stop();
+  const double steps = (double)count * passCount;
+  if (lastLevelMisses()->available()) {
+    snprintf(llc, sizeof(llc), "%.2f", llcCount / steps);
+  }
+  if (l1dMisses()->available()) {
+    snprintf(l1d, sizeof(l1d), "%.2f", l1dCount / steps);
+  }
+#endif
+
+  printf("%-24s %8lu %12.1f %16s %16s\n", name, (unsigned long)count, best * 1e9 / count, l1d, llc);
+  fflush(stdout);
+
+  for (State *s : states) {
+    delete s;
+  }
+  for (void *filler : fillers) {
+    free(filler);
+  }
+}
+
+int main(int argc, const char *argv[])
+{
+  Options options;
+  if (!options.parse(argc, argv)) {
+    fprintf(stderr, "usage: %s [--quick] [--filter name] [--samples passes]\n", argv[0]);
+    return 1;
+  }
+
+  printf("state bytes: interleaved %zu, split %zu plus %zu cold on first use\n", sizeof(InterleavedState), sizeof(SplitState), sizeof(ColdState));
+  printf("%-24s %8s %12s %16s %16s\n", "layout", "count", "ns/state", "L1d misses/state", "LLC misses/state");
+
+  std::vector<size_t> counts = {10000, 100000, 1000000};
+  if (options.samples < Options().samples) {
+    counts = {10000};
+  }
+
+  for (size_t count : counts) {
+    if (options.filter.empty() || std::string("interleaved").find(options.filter) != std::string::npos) {
+      benchmarkLayout<InterleavedState>("interleaved", count, options.samples);
+    }
+    if (options.filter.empty() || std::string("split").find(options.filter) != std::string::npos) {
+      benchmarkLayout<SplitState>("split", count, options.samples);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <QuartzCore/QuartzCore.h>
+
+#import <OCMock/OCMock.h>
+
+#import <XCTest/XCTest.h>
+
+#import <pop/POP.h>
+#import <pop/POPAnimatorPrivate.h>
+
+#import "POPAnimatable.h"
+#import "POPAnimationTestsExtras.h"
+#import "POPBaseAnimationTests.h"
+
+static const CGFloat epsilon = 0.0001f;
+
+static POPBasicAnimation *FBTestLinearRadiusAnimation(POPAnimatableProperty *property)
+{
+  POPBasicAnimation *anim = [POPBasicAnimation linearAnimation];
+  anim.property = property;
+  anim.fromValue = @0.0;
+  anim.toValue = @100.0;
+  anim.duration = 1;
+  return anim;
+}
+
+@interface POPAnimationGroupTests : POPBaseAnimationTests
+@end
+
+@implementation POPAnimationGroupTests
+
+- (void)testStagger
+{
+  NSArray *circles = @[[POPAnimatable new], [POPAnimatable new], [POPAnimatable new]];
+
+  POPAnimationGroup *group = [POPAnimationGroup animation];
+  group.stagger = 0.5;
+  for (POPAnimatable *circle in circles) {
+    [group addAnimation:FBTestLinearRadiusAnimation(self.radiusProperty) forObject:circle];
+  }
+  XCTAssertTrue(3 == group.animations.count, @"unexpected animations %@", group.animations);
+
+  __block NSUInteger completionCount = 0;
+  group.completionBlock = ^(POPAnimation *anim, BOOL finished) {
+    XCTAssertTrue(finished, @"unexpected unfinished completion");
+    completionCount++;
+  };
+
+  CALayer *layer = [CALayer layer];
+  [layer pop_addAnimation:group forKey:@"group"];
+
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@0.0, @0.75]);
+  XCTAssertEqualWithAccuracy([circles[0] radius], 75, epsilon);
+  XCTAssertEqualWithAccuracy([circles[1] radius], 25, epsilon);
+  XCTAssertEqualWithAccuracy([circles[2] radius], 0, epsilon);
+  XCTAssertTrue(0 == completionCount, @"unexpected completion");
+
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@1.25, @2.0]);
+  for (POPAnimatable *circle in circles) {
+    XCTAssertEqualWithAccuracy(circle.radius, 100, epsilon);
+  }
+
+  // one aggregate completion
+  XCTAssertTrue(1 == completionCount, @"unexpected completion count %lu", (unsigned long)completionCount);
+  XCTAssertNil([layer pop_animationForKey:@"group"]);
+}
+
+- (void)testOffsetAndSpeed
+{
+  POPAnimatable *circle1 = [POPAnimatable new];
+  POPAnimatable *circle2 = [POPAnimatable new];
+
+  POPAnimationGroup *group = [POPAnimationGroup animation];
+  group.speed = 2;
+  [group addAnimation:FBTestLinearRadiusAnimation(self.radiusProperty) forObject:circle1 offset:1];
+  [group addAnimation:FBTestLinearRadiusAnimation(self.radiusProperty) forObject:circle2];
+
+  id delegate = [OCMockObject niceMockForProtocol:@protocol(POPAnimationDelegate)];
+  [[delegate expect] pop_animationDidStop:group finished:YES];
+  group.delegate = delegate;
+
+  CALayer *layer = [CALayer layer];
+  [layer pop_addAnimation:group forKey:@"group"];
+
+  // group time advances twice as fast
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@0.0, @0.25, @0.75]);
+  XCTAssertEqualWithAccuracy(circle1.radius, 50, epsilon);
+  XCTAssertEqualWithAccuracy(circle2.radius, 100, epsilon);
+
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@1.0]);
+  XCTAssertEqualWithAccuracy(circle1.radius, 100, epsilon);
+  [delegate verify];
+}
+
+- (void)testRemovalStopsChildren
+{
+  POPAnimatable *circle = [POPAnimatable new];
+  POPBasicAnimation *child = FBTestLinearRadiusAnimation(self.radiusProperty);
+
+  id childDelegate = [OCMockObject niceMockForProtocol:@protocol(POPAnimationDelegate)];
+  [[childDelegate expect] pop_animationDidStart:child];
+  [[childDelegate expect] pop_animationDidStop:child finished:NO];
+  child.delegate = childDelegate;
+
+  POPAnimationGroup *group = [POPAnimationGroup animation];
+  [group addAnimation:child forObject:circle];
+
+  id delegate = [OCMockObject niceMockForProtocol:@protocol(POPAnimationDelegate)];
+  [[delegate expect] pop_animationDidStop:group finished:NO];
+  group.delegate = delegate;
+
+  CALayer *layer = [CALayer layer];
+  [layer pop_addAnimation:group forKey:@"group"];
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@0.0, @0.5]);
+  [layer pop_removeAnimationForKey:@"group"];
+
+  [childDelegate verify];
+  [delegate verify];
+}
+
+- (void)testEmptyGroup
+{
+  POPAnimationGroup *group = [POPAnimationGroup animation];
+
+  id delegate = [OCMockObject niceMockForProtocol:@protocol(POPAnimationDelegate)];
+  [[delegate expect] pop_animationDidStop:group finished:YES];
+  group.delegate = delegate;
+
+  CALayer *layer = [CALayer layer];
+  [layer pop_addAnimation:group forKey:@"group"];
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@0.0]);
+
+  [delegate verify];
+}
+
+- (void)testNSCopyingSupportPOPAnimationGroup
+{
+  POPAnimationGroup *group = [POPAnimationGroup animation];
+  configureConcreteAnimation(group);
+  group.stagger = 0.1;
+  group.speed = 0.5;
+  [group addAnimation:FBTestLinearRadiusAnimation(self.radiusProperty) forObject:[POPAnimatable new]];
+
+  [self testCopyingSucceedsForConcreteAnimation:group];
+
+  POPAnimationGroup *copy = [group copy];
+  XCTAssertEqual(copy.stagger, group.stagger);
+  XCTAssertEqual(copy.speed, group.speed);
+  XCTAssertTrue(1 == copy.animations.count, @"unexpected animations %@", copy.animations);
+  XCTAssertTrue(copy.animations.firstObject != group.animations.firstObject, @"expected copied child animation");
+}
+
+@end
@@ -23,6 +23,8 @@
 #import "POPBaseAnimationTests.h"
 #import "POPCGUtils.h"
 #import "POPAnimationInternal.h"
+#import "POPFrameClock.h"
+#import "POPSpringAnimationInternal.h"
 
 using namespace POP;
 
@@ -35,6 +37,10 @@ using namespace POP;
 - (void)setSampleKey:(NSString *)aValue { [self setValue:aValue forUndefinedKey:@"sampleKey"];}
 @end
 
+@interface POPAnimator (TestExtensions)
+- (void)_processPendingList;
+@end
+
 @interface POPAnimationTests : POPBaseAnimationTests
 @end
 
@@ -444,6 +450,552 @@ using namespace POP;
   XCTAssertTrue(1 == didStopEvents.count, @"unexpected stop events %@", didStopEvents);
 }
 
+- (void)testDeferredStart
+{
+  NSUInteger initialCount = self.animator.deferredAnimationCount;
+  POPAnimation *anim = FBTestLinearPositionAnimation(self.beginTime + 1);
+  [anim.tracer start];
+
+  CALayer *layer = [CALayer layer];
+  [layer pop_addAnimation:anim forKey:@"key"];
+
+  // not yet due; parked off the active list
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@0.0, @0.5]);
+  XCTAssertTrue(initialCount + 1 == self.animator.deferredAnimationCount, @"unexpected deferred count %lu", (unsigned long)self.animator.deferredAnimationCount);
+  XCTAssertTrue(0 == [anim.tracer eventsWithType:kPOPAnimationEventDidStart].count);
+  XCTAssertTrue(0 == [anim.tracer eventsWithType:kPOPAnimationEventPropertyWrite].count);
+
+  // due; promoted and started
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@1.0, @1.5]);
+  XCTAssertTrue(initialCount == self.animator.deferredAnimationCount, @"unexpected deferred count %lu", (unsigned long)self.animator.deferredAnimationCount);
+  XCTAssertTrue(1 == [anim.tracer eventsWithType:kPOPAnimationEventDidStart].count);
+  XCTAssertTrue(0 < [anim.tracer eventsWithType:kPOPAnimationEventPropertyWrite].count);
+
+  [layer pop_removeAllAnimations];
+}
+
+- (void)testDeferredRemoval
+{
+  NSUInteger initialCount = self.animator.deferredAnimationCount;
+  POPAnimation *anim1 = FBTestLinearPositionAnimation(self.beginTime + 2);
+  POPAnimation *anim2 = FBTestLinearPositionAnimation(self.beginTime + 1);
+
+  CALayer *layer = [CALayer layer];
+  [layer pop_addAnimation:anim1 forKey:@"key1"];
+  [layer pop_addAnimation:anim2 forKey:@"key2"];
+
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@0.0]);
+  XCTAssertTrue(initialCount + 2 == self.animator.deferredAnimationCount, @"unexpected deferred count %lu", (unsigned long)self.animator.deferredAnimationCount);
+
+  // removal includes deferred animations
+  [layer pop_removeAnimationForKey:@"key1"];
+  XCTAssertTrue(initialCount + 1 == self.animator.deferredAnimationCount, @"unexpected deferred count %lu", (unsigned long)self.animator.deferredAnimationCount);
+
+  [layer pop_removeAllAnimations];
+  XCTAssertTrue(initialCount == self.animator.deferredAnimationCount, @"unexpected deferred count %lu", (unsigned long)self.animator.deferredAnimationCount);
+}
+
+- (void)testAnimatorSpeed
+{
+  // private animator, rendered ahead of media time for deterministic rebasing
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer key:@"key"];
+
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.0, @0.25]);
+  XCTAssertEqualWithAccuracy(layer.position.x, 25, 1e-6);
+
+  // half speed
+  animator.speed = 0.5;
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.75]);
+  XCTAssertEqualWithAccuracy(layer.position.x, 50, 1e-6);
+
+  // double speed
+  animator.speed = 2;
+  POPAnimatorRenderTimes(animator, beginTime, @[@1.0]);
+  XCTAssertEqualWithAccuracy(layer.position.x, 100, 1e-6);
+  XCTAssertNil([animator animationForObject:layer key:@"key"]);
+}
+
+- (void)testAnimatorPaused
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer key:@"key"];
+
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.0, @0.25]);
+  XCTAssertEqualWithAccuracy(layer.position.x, 25, 1e-6);
+
+  // time halts while paused
+  animator.paused = YES;
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.5, @5.0]);
+  XCTAssertEqualWithAccuracy(layer.position.x, 25, 1e-6);
+
+  // and resumes where it left off
+  animator.paused = NO;
+  POPAnimatorRenderTimes(animator, beginTime, @[@5.25]);
+  XCTAssertEqualWithAccuracy(layer.position.x, 50, 1e-6);
+}
+
+- (void)testAnimatorPausedBeforeBeginTime
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  CALayer *layer = [CALayer layer];
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.0]);
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime + 1) forObject:layer key:@"key"];
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.5]);
+
+  // pause across the begin time
+  animator.paused = YES;
+  POPAnimatorRenderTimes(animator, beginTime, @[@1.5, @3.0]);
+  animator.paused = NO;
+
+  // the remaining half second of delay elapses after resuming
+  POPAnimatorRenderTimes(animator, beginTime, @[@3.25]);
+  XCTAssertTrue(1 == animator.deferredAnimationCount, @"unexpected deferred count %lu", (unsigned long)animator.deferredAnimationCount);
+  POPAnimatorRenderTimes(animator, beginTime, @[@3.5, @4.0]);
+  XCTAssertTrue(0 == animator.deferredAnimationCount, @"unexpected deferred count %lu", (unsigned long)animator.deferredAnimationCount);
+  XCTAssertEqualWithAccuracy(layer.position.x, 50, 1e-6);
+
+  // the delay scales with speed
+  animator.speed = 2;
+  CALayer *fastLayer = [CALayer layer];
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime + 5) forObject:fastLayer key:@"key"];
+  POPAnimatorRenderTimes(animator, beginTime, @[@4.25]);
+  XCTAssertTrue(1 == animator.deferredAnimationCount, @"unexpected deferred count %lu", (unsigned long)animator.deferredAnimationCount);
+  POPAnimatorRenderTimes(animator, beginTime, @[@4.5, @4.75]);
+  XCTAssertEqualWithAccuracy(fastLayer.position.x, 50, 1e-6);
+}
+
+- (void)testAnimatorHitchPolicy
+{
+  CFTimeInterval beginTime = self.beginTime + 1000;
+  const CGFloat expected[3][5] = {
+    {10, 50, 60, 70, 80},  // jump, over the entire gap
+    {10, 20, 30, 40, 50},  // clamp, dropping 0.3 of the gap
+    {10, 20, 45, 70, 80},  // spread, catching up the 0.3 over two frames
+  };
+
+  for (NSUInteger policy = kPOPHitchPolicyJump; policy <= kPOPHitchPolicySpread; policy++) {
+    POPAnimator *animator = [[POPAnimator alloc] init];
+    animator.disableDisplayLink = YES;
+    animator.hitchPolicy = (POPHitchPolicy)policy;
+    animator.hitchRecoveryFrameCount = 2;
+    XCTAssertEqual(animator.maximumFrameInterval, 0.1);
+    POPAnimatorSetMetricsEnabled(animator, YES);
+
+    CALayer *layer = [CALayer layer];
+    [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer key:@"key"];
+    POPAnimatorRenderTimes(animator, beginTime, @[@0.0]);
+
+    // a 0.4 second gap after the second frame
+    NSArray *times = @[@0.1, @0.5, @0.6, @0.7, @0.8];
+    for (NSUInteger idx = 0; idx < times.count; idx++) {
+      POPAnimatorRenderTimes(animator, beginTime, @[times[idx]]);
+      XCTAssertEqualWithAccuracy(layer.position.x, expected[policy][idx], 1e-6, @"policy %lu frame %lu", (unsigned long)policy, (unsigned long)idx);
+    }
+
+    POPAnimatorMetrics metrics;
+    POPAnimatorGetMetrics(animator, &metrics);
+    XCTAssertTrue(1 == metrics.hitchCount, @"unexpected hitches %llu", metrics.hitchCount);
+  }
+}
+
+- (void)testAnimatorHitchPolicyPendingRender
+{
+  CFTimeInterval beginTime = self.beginTime + 1000;
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  animator.hitchPolicy = kPOPHitchPolicySpread;
+  animator.hitchRecoveryFrameCount = 2;
+  POPAnimatorSetMetricsEnabled(animator, YES);
+
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer key:@"key"];
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.0, @0.1]);
+
+  // animations added after the gap and between the catch up frames start in pending renders
+  NSArray *pendingTimes = @[@0.5, @0.65];
+  NSArray *times = @[@0.6, @0.7, @0.8];
+  const CGFloat expected[3] = {45, 70, 80};
+  for (NSUInteger idx = 0; idx < times.count; idx++) {
+    if (idx < pendingTimes.count) {
+      [animator addAnimation:FBTestLinearPositionAnimation(0) forObject:[CALayer layer] key:@"key"];
+      animator.beginTime = beginTime + [pendingTimes[idx] doubleValue];
+      [animator _processPendingList];
+      animator.beginTime = 0;
+    }
+    POPAnimatorRenderTimes(animator, beginTime, @[times[idx]]);
+    XCTAssertEqualWithAccuracy(layer.position.x, expected[idx], 1e-6, @"frame %lu", (unsigned long)idx);
+  }
+
+  // the gap counts once, and pending renders pay no installments
+  POPAnimatorMetrics metrics;
+  POPAnimatorGetMetrics(animator, &metrics);
+  XCTAssertTrue(1 == metrics.hitchCount, @"unexpected hitches %llu", metrics.hitchCount);
+}
+
+- (void)testFrameClock
+{
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  // first frame at begin time
+  std::shared_ptr<ManualFrameClock> clock = std::make_shared<ManualFrameClock>(10, beginTime - 0.1);
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  [animator setFrameClock:clock];
+  XCTAssertEqualWithAccuracy(animator.refreshPeriod, 0.1, 1e-9);
+  XCTAssertFalse(clock->isRunning());
+
+  // clock runs while animations do
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer key:@"key"];
+  XCTAssertTrue(clock->isRunning());
+
+  XCTAssertTrue(5 == clock->step(5));
+  XCTAssertEqualWithAccuracy(layer.position.x, 40, 1e-6);
+
+  // a stall without frames
+  clock->advance(0.3);
+  XCTAssertTrue(clock->step());
+  XCTAssertEqualWithAccuracy(layer.position.x, 80, 1e-6);
+
+  // steps until the animation finishes and the clock stops
+  NSUInteger frameCount = 0;
+  while (clock->step()) {
+    frameCount++;
+  }
+  XCTAssertTrue(frameCount >= 2 && frameCount <= 3, @"unexpected frames %lu", (unsigned long)frameCount);
+  XCTAssertEqualWithAccuracy(layer.position.x, 100, 1e-6);
+  XCTAssertFalse(clock->isRunning());
+
+  // animator time carries over to the display link
+  CFTimeInterval time = animator.currentTime;
+  [animator setFrameClock:nullptr];
+  XCTAssertEqualWithAccuracy(animator.currentTime, time, 0.1);
+  XCTAssertFalse(clock->isRunning());
+}
+
+- (void)testPresentationTimeTargeting
+{
+  CFTimeInterval beginTime = self.beginTime + 1000;
+  const CGFloat expected[2][3] = {
+    {0, 0, 10},  // evaluated at frame timestamps, presented a refresh stale
+    {0, 10, 20}, // evaluated at target timestamps
+  };
+
+  for (NSUInteger targeting = 0; targeting < 2; targeting++) {
+    std::shared_ptr<ManualFrameClock> clock = std::make_shared<ManualFrameClock>(10, beginTime - 0.2);
+    POPAnimator *animator = [[POPAnimator alloc] init];
+    animator.targetsPresentationTime = (BOOL)targeting;
+    [animator setFrameClock:clock];
+    CFTimeInterval time = animator.currentTime;
+
+    CALayer *layer = [CALayer layer];
+    [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer key:@"key"];
+
+    // first frame presented at begin time
+    for (NSUInteger idx = 0; idx < 3; idx++) {
+      XCTAssertTrue(clock->step());
+      XCTAssertEqualWithAccuracy(layer.position.x, expected[targeting][idx], 1e-6, @"targeting %lu frame %lu", (unsigned long)targeting, (unsigned long)idx);
+    }
+
+    // current time runs a refresh ahead of the clock while targeting
+    XCTAssertEqualWithAccuracy(animator.currentTime - time, targeting ? 0.4 : 0.3, 1e-6);
+  }
+}
+
+- (void)testPreferredFramesPerSecond
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  POPAnimatorSetMetricsEnabled(animator, YES);
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  // a 30 Hz animation rendered at 60 Hz steps every other frame
+  POPBasicAnimation *anim = FBTestLinearPositionAnimation(beginTime);
+  anim.preferredFramesPerSecond = 30;
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:anim forObject:layer key:@"key"];
+
+  const CGFloat expected[5] = {0, 0, 100. * 2 / 60, 100. * 2 / 60, 100. * 4 / 60};
+  for (NSUInteger idx = 0; idx < 5; idx++) {
+    POPAnimatorRenderTime(animator, beginTime, idx / 60.);
+    XCTAssertEqualWithAccuracy(layer.position.x, expected[idx], 1e-6, @"frame %lu", (unsigned long)idx);
+  }
+
+  POPAnimatorMetrics metrics;
+  POPAnimatorGetMetrics(animator, &metrics);
+  XCTAssertTrue(2 == metrics.throttledStepCount, @"unexpected throttled steps %llu", metrics.throttledStepCount);
+
+  // finishes all the same
+  POPAnimatorRenderDuration(animator, beginTime + 4 / 60., 1, 1 / 60.);
+  XCTAssertEqualWithAccuracy(layer.position.x, 100, 1e-6);
+
+  // the frame clock runs at the lowest rate satisfying all animations
+  std::shared_ptr<ManualFrameClock> clock = std::make_shared<ManualFrameClock>(60, beginTime);
+  POPAnimator *clocked = [[POPAnimator alloc] init];
+  [clocked setFrameClock:clock];
+
+  POPBasicAnimation *slow = FBTestLinearPositionAnimation(0);
+  slow.preferredFramesPerSecond = 15;
+  CALayer *slowLayer = [CALayer layer];
+  [clocked addAnimation:slow forObject:slowLayer key:@"key"];
+  XCTAssertTrue(15 == clock->preferredFramesPerSecond());
+
+  CALayer *fastLayer = [CALayer layer];
+  [clocked addAnimation:FBTestLinearPositionAnimation(0) forObject:fastLayer key:@"key"];
+  XCTAssertTrue(0 == clock->preferredFramesPerSecond());
+
+  [clocked removeAnimationForObject:fastLayer key:@"key"];
+  clock->step();
+  XCTAssertTrue(15 == clock->preferredFramesPerSecond());
+}
+
+- (void)testFrameBudget
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  animator.maximumFrameInterval = 0.075;
+  POPAnimatorSetMetricsEnabled(animator, YES);
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  // a budget spent before any animation steps
+  animator.frameBudget = 1e-9;
+
+  POPBasicAnimation *low = FBTestLinearPositionAnimation(beginTime);
+  low.priority = kPOPAnimationPriorityLow;
+  CALayer *lowLayer = [CALayer layer];
+  [animator addAnimation:low forObject:lowLayer key:@"key"];
+
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer key:@"key"];
+
+  // low priority animations start, then step only once per maximum frame interval, over the skipped time
+  const CGFloat expected[8] = {0, 0, 0, 0, 0, 100. * 5 / 60, 100. * 5 / 60, 100. * 5 / 60};
+  for (NSUInteger idx = 0; idx < 8; idx++) {
+    POPAnimatorRenderTime(animator, beginTime, idx / 60.);
+    XCTAssertEqualWithAccuracy(lowLayer.position.x, expected[idx], 1e-6, @"frame %lu", (unsigned long)idx);
+    XCTAssertEqualWithAccuracy(layer.position.x, 100. * idx / 60, 1e-6, @"frame %lu", (unsigned long)idx);
+  }
+
+  POPAnimatorMetrics metrics;
+  POPAnimatorGetMetrics(animator, &metrics);
+  XCTAssertTrue(6 == metrics.deferredStepCount, @"unexpected deferred steps %llu", metrics.deferredStepCount);
+  XCTAssertTrue(6 == metrics.overBudgetFrameCount, @"unexpected over budget frames %llu", metrics.overBudgetFrameCount);
+
+  // within budget, low priority animations step every frame
+  animator.frameBudget = 1000;
+  POPAnimatorRenderTime(animator, beginTime, 8 / 60.);
+  XCTAssertEqualWithAccuracy(lowLayer.position.x, 100. * 8 / 60, 1e-6);
+  POPAnimatorGetMetrics(animator, &metrics);
+  XCTAssertTrue(6 == metrics.deferredStepCount);
+}
+
+- (void)testVisibilityCulling
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  POPAnimatorSetMetricsEnabled(animator, YES);
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  __block BOOL visible = NO;
+  POPBasicAnimation *anim = FBTestLinearPositionAnimation(beginTime);
+  anim.visibilityBlock = ^BOOL(POPAnimation *a, id obj) {
+    return visible;
+  };
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:anim forObject:layer key:@"key"];
+
+  // animations without a visibility block of their own defer to the animator
+  animator.visibilityBlock = ^BOOL(POPAnimation *a, id obj) {
+    return NO;
+  };
+  CALayer *hiddenLayer = [CALayer layer];
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:hiddenLayer key:@"key"];
+
+  // culled after starting, skipping frames then advancing without writing
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.0, @(1 / 60.), @(2 / 60.), @(3 / 60.), @(4 / 60.), @(5 / 60.), @(9 / 60.)]);
+  XCTAssertEqualWithAccuracy(layer.position.x, 0, 1e-6);
+  XCTAssertEqualWithAccuracy(hiddenLayer.position.x, 0, 1e-6);
+
+  // once visible, writes the value of the current time
+  visible = YES;
+  POPAnimatorRenderTime(animator, beginTime, 0.5);
+  XCTAssertEqualWithAccuracy(layer.position.x, 50, 1e-6);
+  XCTAssertEqualWithAccuracy(hiddenLayer.position.x, 0, 1e-6);
+
+  POPAnimatorMetrics metrics;
+  POPAnimatorGetMetrics(animator, &metrics);
+  XCTAssertTrue(13 == metrics.culledStepCount, @"unexpected culled steps %llu", metrics.culledStepCount);
+
+  // culled animations finish all the same, writing their final value
+  POPAnimatorRenderTime(animator, beginTime, 1.05);
+  XCTAssertEqualWithAccuracy(hiddenLayer.position.x, 100, 1e-6);
+  XCTAssertNil([animator animationForObject:hiddenLayer key:@"key"]);
+}
+
+- (void)testAnimatorMetrics
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+  XCTAssertFalse(POPAnimatorGetMetricsEnabled(animator));
+
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer key:@"key"];
+
+  // nothing accumulates while disabled
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.0]);
+  POPAnimatorMetrics metrics;
+  POPAnimatorGetMetrics(animator, &metrics);
+  XCTAssertTrue(0 == metrics.frameCount);
+  XCTAssertTrue(1 == metrics.activeAnimationCount);
+
+  POPAnimatorSetMetricsEnabled(animator, YES);
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.25, @0.5, @1.0]);
+  POPAnimatorGetMetrics(animator, &metrics);
+  XCTAssertTrue(3 == metrics.frameCount, @"unexpected frames %llu", metrics.frameCount);
+  XCTAssertTrue(3 == metrics.writeCount, @"unexpected writes %llu", metrics.writeCount);
+  XCTAssertTrue(1 == metrics.skippedWriteCount, @"unexpected skipped writes %llu", metrics.skippedWriteCount);
+  XCTAssertTrue(0 == metrics.activeAnimationCount);
+  XCTAssertTrue(metrics.phaseDuration[kPOPAnimatorPhaseFrame] >= metrics.phaseDuration[kPOPAnimatorPhaseWrite]);
+
+  // histogram samples each frame
+  NSUInteger buckets[kPOPAnimatorHistogramBucketCount];
+  POPAnimatorGetHistogram(animator, kPOPAnimatorPhaseFrame, buckets);
+  NSUInteger sampleCount = 0;
+  for (NSUInteger idx = 0; idx < kPOPAnimatorHistogramBucketCount; idx++) {
+    sampleCount += buckets[idx];
+  }
+  XCTAssertTrue(3 == sampleCount);
+  XCTAssertEqualWithAccuracy(POPAnimatorHistogramBucketUpperBound(1), 0.00025, 1e-9);
+  XCTAssertTrue(isinf(POPAnimatorHistogramBucketUpperBound(kPOPAnimatorHistogramBucketCount - 1)));
+
+  POPAnimatorResetMetrics(animator);
+  POPAnimatorGetMetrics(animator, &metrics);
+  XCTAssertTrue(0 == metrics.frameCount && 0 == metrics.writeCount);
+}
+
+- (void)testAnimatorMetricsCountOwnSolverSteps
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  POPAnimatorSetMetricsEnabled(animator, YES);
+  POPAnimator *otherAnimator = [[POPAnimator alloc] init];
+  otherAnimator.disableDisplayLink = YES;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  POPSpringAnimation *spring = [POPSpringAnimation animationWithPropertyNamed:kPOPLayerPositionX];
+  spring.fromValue = @0.0;
+  spring.toValue = @100.0;
+  spring.beginTime = beginTime;
+  POPSpringAnimation *otherSpring = [spring copy];
+
+  // the other animator and a plain solver step within frames of the animator
+  __block CFTimeInterval time = 0;
+  SpringSolver4d *solver = new SpringSolver4d(300, 20, 1);
+  spring.animationDidApplyBlock = ^(POPAnimation *anim) {
+    POPAnimatorRenderTime(otherAnimator, beginTime, time);
+    SSState4d state;
+    state.p = Vector4d(100, 0, 0, 0);
+    state.v = Vector4d::Zero();
+    solver->advance(state, 0, 1. / 60.);
+  };
+  [animator addAnimation:spring forObject:[CALayer layer] key:@"key"];
+  [otherAnimator addAnimation:otherSpring forObject:[CALayer layer] key:@"key"];
+
+  for (NSUInteger idx = 0; idx < 30; idx++) {
+    time = idx / 60.;
+    POPAnimatorRenderTime(animator, beginTime, time);
+  }
+  XCTAssertTrue(solver->stepCount() > 0);
+  delete solver;
+
+  // only steps of the animator's own springs count
+  POPAnimatorMetrics metrics;
+  POPAnimatorGetMetrics(animator, &metrics);
+  const NSUInteger stepCount = static_cast<POPSpringAnimationState *>(POPAnimationGetState(spring))->solver->stepCount();
+  XCTAssertTrue(stepCount > 0);
+  XCTAssertTrue(stepCount == metrics.solverStepCount, @"unexpected solver steps %llu, expected %lu", metrics.solverStepCount, (unsigned long)stepCount);
+}
+
+- (void)testSkipsIdenticalWrites
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  POPAnimatorSetMetricsEnabled(animator, YES);
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  __block NSUInteger readCount = 0;
+  __block NSUInteger writeCount = 0;
+  POPAnimatableProperty *prop = [POPAnimatableProperty propertyWithName:@"counted.value" initializer:^(POPMutableAnimatableProperty *p) {
+    p.readBlock = ^(id obj, CGFloat values[]) {
+      readCount++;
+    };
+    p.writeBlock = ^(id obj, const CGFloat values[]) {
+      writeCount++;
+    };
+    p.threshold = 0.01;
+  }];
+
+  // integral values over 240 frames, repeating each value at least twice
+  POPBasicAnimation *anim = [POPBasicAnimation linearAnimation];
+  anim.property = prop;
+  anim.fromValue = @0.0;
+  anim.toValue = @100.0;
+  anim.duration = 1;
+  anim.beginTime = beginTime;
+  anim.roundingFactor = 1;
+  NSObject *obj = [[NSObject alloc] init];
+  [animator addAnimation:anim forObject:obj key:@"key"];
+
+  for (NSUInteger idx = 0; idx <= 240; idx++) {
+    POPAnimatorRenderTime(animator, beginTime, idx / 240.);
+  }
+  XCTAssertNil([animator animationForObject:obj key:@"key"]);
+
+  // each value written once, without reading the object back, including on completion
+  XCTAssertTrue(101 == writeCount, @"unexpected writes %lu", (unsigned long)writeCount);
+  XCTAssertTrue(0 == readCount, @"unexpected reads %lu", (unsigned long)readCount);
+
+  POPAnimatorMetrics metrics;
+  POPAnimatorGetMetrics(animator, &metrics);
+  XCTAssertTrue(101 == metrics.writeCount, @"unexpected writes %llu", metrics.writeCount);
+  XCTAssertTrue(metrics.skippedWriteCount >= 140, @"unexpected skipped writes %llu", metrics.skippedWriteCount);
+}
+
+- (void)testAllocationReuse
+{
+  POPAllocationStatistics before;
+  POPGetAllocationStatistics(&before);
+
+  // states, solvers and vectors of released animations are reused by the next
+  for (NSUInteger idx = 0; idx < 1000; idx++) {
+    @autoreleasepool {
+      POPSpringAnimation *anim = [POPSpringAnimation animationWithPropertyNamed:kPOPLayerPosition];
+      anim.fromValue = [NSValue valueWithCGPoint:CGPointMake(0, 0)];
+      anim.toValue = [NSValue valueWithCGPoint:CGPointMake(100, 100)];
+    }
+  }
+
+  POPAllocationStatistics after;
+  POPGetAllocationStatistics(&after);
+  const uint64_t allocationCount = after.allocationCount - before.allocationCount;
+  const uint64_t mallocCount = after.mallocCount - before.mallocCount;
+  XCTAssertTrue(allocationCount >= 5000, @"unexpected allocations %llu", allocationCount);
+  XCTAssertTrue(mallocCount < 10, @"unexpected mallocs %llu", mallocCount);
+  XCTAssertTrue(after.freeCount - before.freeCount >= allocationCount, @"unexpected frees %llu", after.freeCount - before.freeCount);
+}
+
 - (void)testAddedKeys
 {
   POPAnimation *anim = FBTestLinearPositionAnimation();
@@ -872,6 +1424,88 @@ using namespace POP;
   XCTAssertTrue(layerValues[0] == toValues[0] && layerValues[1] == toValues[1] && layerValues[2] == toValues[2] && layerValues[3] == toValues[3], @"unexpected last color: [r:%f g:%f b:%f a:%f]", layerValues[0], layerValues[1], layerValues[2], layerValues[3]);
 }
 
+- (void)testMemoryBoundProperty
+{
+  struct Particle { float x; float mass; float y; };
+  Particle particles[2] = {{1, 5, 2}, {3, 5, 4}};
+
+  // animate x and y of the second particle, leaving mass untouched
+  POPAnimatableProperty *prop = [POPAnimatableProperty propertyWithName:@"particle.position" initializer:^(POPMutableAnimatableProperty *p) {
+    p.memoryBinding = POPMemoryBindingMake(particles, sizeof(Particle) + offsetof(Particle, x), offsetof(Particle, y) - offsetof(Particle, x), 2, kPOPScalarTypeFloat);
+    p.threshold = 0.01;
+  }];
+  XCTAssertTrue(2 == prop.memoryBinding.count);
+  XCTAssertNotNil(prop.readBlock);
+  XCTAssertNotNil(prop.writeBlock);
+
+  POPBasicAnimation *anim = [POPBasicAnimation linearAnimation];
+  anim.property = prop;
+  anim.toValue = [NSValue valueWithCGPoint:CGPointMake(13, 24)];
+  anim.duration = 1;
+
+  POPAnimationTracer *tracer = anim.tracer;
+  [tracer start];
+
+  NSObject *obj = [NSObject new];
+  [obj pop_addAnimation:anim forKey:@"position"];
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@0.0, @0.5, @1.0]);
+
+  // from value read from memory
+  XCTAssertEqualObjects(anim.fromValue, [NSValue valueWithCGPoint:CGPointMake(3, 4)]);
+
+  // final value written through the binding
+  XCTAssertEqual(particles[1].x, 13.f);
+  XCTAssertEqual(particles[1].y, 24.f);
+  XCTAssertEqual(particles[1].mass, 5.f);
+  XCTAssertEqual(particles[0].x, 1.f);
+  XCTAssertEqual(particles[0].y, 2.f);
+
+  // writes remain traced
+  XCTAssertTrue(tracer.writeEvents.count >= 2, @"unexpected write events %@", tracer.writeEvents);
+}
+
+- (void)testInvalidMemoryBindingFallsBackToBlocks
+{
+  CGFloat values[2] = {0, 0};
+  __block NSUInteger writeCount = 0;
+
+  // a NULL base is ignored, animating through the blocks
+  POPAnimatableProperty *prop = [POPAnimatableProperty propertyWithName:@"invalid.binding" initializer:^(POPMutableAnimatableProperty *p) {
+    p.memoryBinding = POPMemoryBindingMake(NULL, 0, 0, 2, CGFLOAT_IS_DOUBLE ? kPOPScalarTypeDouble : kPOPScalarTypeFloat);
+    p.readBlock = ^(id obj, CGFloat v[]) {
+      v[0] = values[0];
+      v[1] = values[1];
+    };
+    p.writeBlock = ^(id obj, const CGFloat v[]) {
+      values[0] = v[0];
+      values[1] = v[1];
+      writeCount++;
+    };
+  }];
+  XCTAssertTrue(0 == prop.memoryBinding.count);
+
+  POPBasicAnimation *anim = [POPBasicAnimation linearAnimation];
+  anim.property = prop;
+  anim.toValue = [NSValue valueWithCGPoint:CGPointMake(10, 20)];
+  anim.duration = 1;
+
+  NSObject *obj = [NSObject new];
+  [obj pop_addAnimation:anim forKey:@"invalid"];
+  POPAnimatorRenderTimes(self.animator, self.beginTime, @[@0.0, @0.5, @1.0]);
+  XCTAssertTrue(writeCount > 0);
+  XCTAssertEqual(values[0], (CGFloat)10);
+  XCTAssertEqual(values[1], (CGFloat)20);
+
+  // more than four components are ignored as well; without blocks nothing is written
+  float memory[8] = {0};
+  POPAnimatableProperty *oversized = [POPAnimatableProperty propertyWithName:@"invalid.binding.count" initializer:^(POPMutableAnimatableProperty *p) {
+    p.memoryBinding = POPMemoryBindingMake(memory, 0, 0, 8, kPOPScalarTypeFloat);
+  }];
+  XCTAssertTrue(0 == oversized.memoryBinding.count);
+  XCTAssertNil(oversized.readBlock);
+  XCTAssertNil(oversized.writeBlock);
+}
+
 - (void)testNSCopyingSupportPOPBasicAnimation
 {
   POPBasicAnimation *anim = [POPBasicAnimation animationWithPropertyNamed:@"test_property_name"];
@@ -0,0 +1,147 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <QuartzCore/QuartzCore.h>
+
+#import <XCTest/XCTest.h>
+
+#import <pop/POP.h>
+#import <pop/POPAnimatorPrivate.h>
+
+#import "POPAnimationTestsExtras.h"
+#import "POPBaseAnimationTests.h"
+
+@interface POPAnimatorCaptureTests : POPBaseAnimationTests
+@end
+
+@implementation POPAnimatorCaptureTests
+
+- (void)testReplayMatchesCapture
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  POPAnimatorCapture *capture = [[POPAnimatorCapture alloc] initWithAnimator:animator];
+  [capture start];
+  XCTAssertTrue(capture.isCapturing);
+
+  CALayer *layer1 = [CALayer layer];
+  CALayer *layer2 = [CALayer layer];
+  layer2.position = CGPointMake(10, 10);
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer1 key:@"basic"];
+
+  // spring from current value, with to value updated mid-flight
+  POPSpringAnimation *spring = [POPSpringAnimation animationWithPropertyNamed:kPOPLayerPosition];
+  spring.toValue = [NSValue valueWithCGPoint:CGPointMake(100, 50)];
+  spring.springBounciness = 12;
+  [animator addAnimation:spring forObject:layer2 key:@"spring"];
+
+  NSMutableArray *times = [NSMutableArray array];
+  for (NSUInteger idx = 0; idx < 60; idx++) {
+    [times addObject:@(idx / 60.)];
+  }
+  POPAnimatorRenderTimes(animator, beginTime, times);
+  spring.toValue = [NSValue valueWithCGPoint:CGPointMake(0, 0)];
+  POPAnimatorRenderTimes(animator, beginTime, @[@1.5, @2.0, @2.5]);
+
+  [capture stop];
+  XCTAssertFalse(capture.isCapturing);
+
+  POPAnimatorReplayer *replayer = [[POPAnimatorReplayer alloc] initWithData:[capture data]];
+  XCTAssertTrue([replayer replay]);
+  XCTAssertTrue(63 == replayer.frameCount, @"unexpected frames %lu", (unsigned long)replayer.frameCount);
+  XCTAssertTrue(63 == replayer.frameDurations.count);
+  XCTAssertTrue(0 == replayer.divergentFrameCount, @"unexpected divergence %f", replayer.maximumDivergence);
+}
+
+- (void)testReplayRemoval
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  POPAnimatorCapture *capture = [[POPAnimatorCapture alloc] initWithAnimator:animator];
+  [capture start];
+
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer key:@"key"];
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.0, @0.25]);
+  [animator removeAnimationForObject:layer key:@"key"];
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.5]);
+  [capture stop];
+
+  // a replay still running the removed animation would diverge
+  POPAnimatorReplayer *replayer = [[POPAnimatorReplayer alloc] initWithData:[capture data]];
+  XCTAssertTrue([replayer replay]);
+  XCTAssertTrue(3 == replayer.frameCount);
+  XCTAssertTrue(0 == replayer.divergentFrameCount);
+}
+
+- (void)testReplayHitchPolicy
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  animator.hitchPolicy = kPOPHitchPolicySpread;
+  animator.maximumFrameInterval = 0.05;
+  animator.hitchRecoveryFrameCount = 2;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  POPAnimatorCapture *capture = [[POPAnimatorCapture alloc] initWithAnimator:animator];
+  [capture start];
+
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:FBTestLinearPositionAnimation(beginTime) forObject:layer key:@"key"];
+
+  // a gap spread over the following frames, then clamped after a policy change
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.0, @0.016, @0.3, @0.316, @0.332, @0.348]);
+  animator.hitchPolicy = kPOPHitchPolicyClamp;
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.6, @0.616]);
+  [capture stop];
+
+  // a replay at the default jump policy would diverge
+  POPAnimatorReplayer *replayer = [[POPAnimatorReplayer alloc] initWithData:[capture data]];
+  XCTAssertTrue([replayer replay]);
+  XCTAssertTrue(8 == replayer.frameCount);
+  XCTAssertTrue(0 == replayer.divergentFrameCount, @"unexpected divergence %f", replayer.maximumDivergence);
+}
+
+- (void)testReplayFrameBudget
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  animator.frameBudget = 1e-9;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  POPAnimatorCapture *capture = [[POPAnimatorCapture alloc] initWithAnimator:animator];
+  [capture start];
+
+  // low priority animations over a budget every frame exceeds
+  for (NSUInteger idx = 0; idx < 8; idx++) {
+    POPBasicAnimation *anim = FBTestLinearPositionAnimation(beginTime);
+    anim.priority = kPOPAnimationPriorityLow;
+    [animator addAnimation:anim forObject:[CALayer layer] key:@"key"];
+  }
+  POPAnimatorRenderTimes(animator, beginTime, @[@0.0, @0.016, @0.032, @0.048]);
+  [capture stop];
+
+  // wall time deferrals would not replay
+  POPAnimatorReplayer *replayer = [[POPAnimatorReplayer alloc] initWithData:[capture data]];
+  XCTAssertTrue([replayer replay]);
+  XCTAssertTrue(4 == replayer.frameCount);
+  XCTAssertTrue(0 == replayer.divergentFrameCount, @"unexpected divergence %f", replayer.maximumDivergence);
+}
+
+- (void)testInvalidData
+{
+  XCTAssertFalse([[[POPAnimatorReplayer alloc] initWithData:nil] replay]);
+  XCTAssertFalse([[[POPAnimatorReplayer alloc] initWithData:[@"invalid capture data" dataUsingEncoding:NSUTF8StringEncoding]] replay]);
+}
+
+@end
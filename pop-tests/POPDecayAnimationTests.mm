@@ -501,6 +501,33 @@ static const CGFloat epsilon = 0.0001f;
   XCTAssertTrue(lastValue > toValue, @"unexpected last value:%f", lastValue);
 }
 
+- (void)testConvergesWithinPixel
+{
+  // durations of decays rounding to half points, converging by threshold and within a pixel
+  CFTimeInterval durations[2];
+  for (NSUInteger idx = 0; idx < 2; idx++) {
+    POPDecayAnimation *anim = self._positionXAnimation;
+    anim.roundingFactor = 0.5;
+    anim.convergesWithinPixel = 1 == idx;
+
+    POPAnimationTracer *tracer = anim.tracer;
+    [tracer start];
+
+    CALayer *layer = [CALayer layer];
+    [layer pop_addAnimation:anim forKey:@"key"];
+    POPAnimatorRenderDuration(self.animator, self.beginTime, 8, 1.0/60.0);
+    [tracer stop];
+
+    POPAnimationEvent *startEvent = [[tracer eventsWithType:kPOPAnimationEventDidStart] lastObject];
+    POPAnimationEvent *stopEvent = [[tracer eventsWithType:kPOPAnimationEventDidStop] lastObject];
+    XCTAssertNotNil(stopEvent, @"expected stop event");
+    durations[idx] = stopEvent.time - startEvent.time;
+  }
+
+  // velocity falls from half to a twentieth of a point per second over more than a second
+  XCTAssertTrue(durations[1] < durations[0] - 0.5, @"expected earlier convergence; threshold:%f pixel:%f", durations[0], durations[1]);
+}
+
 - (void)testComputedProperties
 {
   POPDecayAnimation *anim = [POPDecayAnimation animationWithPropertyNamed:kPOPLayerPositionX];
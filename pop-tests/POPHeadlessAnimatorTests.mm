@@ -0,0 +1,171 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <QuartzCore/QuartzCore.h>
+
+#import <XCTest/XCTest.h>
+
+#import <pop/POP.h>
+#import <pop/POPAnimatorPrivate.h>
+
+#import "POPBaseAnimationTests.h"
+#import "POPHeadlessAnimator.h"
+
+using namespace POP;
+
+// frame duration used when stepping animators
+static const CFTimeInterval kFrameDt = 1.0 / 60.0;
+
+@interface POPHeadlessAnimatorTests : POPBaseAnimationTests
+@end
+
+@implementation POPHeadlessAnimatorTests
+
+// steps both animators frame by frame, expecting equal values and completion frame
+- (void)_assertAnimation:(POPPropertyAnimation *)anim matchesHeadless:(const HeadlessAnimation &)headlessAnim
+{
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  CALayer *layer = [CALayer layer];
+  [animator addAnimation:anim forObject:layer key:@"key"];
+
+  HeadlessAnimator headless;
+  CGFloat values[2] = {0, 0};
+  HeadlessAnimationID animationID = headless.addAnimation(headlessAnim, values);
+
+  NSUInteger frame = 0;
+  for (; frame < 600; frame++) {
+    CFTimeInterval time = beginTime + frame * kFrameDt;
+    [animator renderTime:time];
+    headless.renderTime(time);
+
+    XCTAssertEqualWithAccuracy(layer.position.x, values[0], 1e-9, @"frame %lu", (unsigned long)frame);
+    XCTAssertEqualWithAccuracy(layer.position.y, values[1], 1e-9, @"frame %lu", (unsigned long)frame);
+
+    BOOL running = nil != [animator animationForObject:layer key:@"key"];
+    XCTAssertEqual(running, headless.hasAnimation(animationID), @"frame %lu", (unsigned long)frame);
+    if (!running) {
+      break;
+    }
+  }
+  XCTAssertTrue(frame < 600, @"animation did not finish");
+}
+
+- (void)testSpringMatchesAnimator
+{
+  POPSpringAnimation *anim = [POPSpringAnimation animationWithPropertyNamed:kPOPLayerPosition];
+  anim.fromValue = [NSValue valueWithCGPoint:CGPointMake(0, 0)];
+  anim.toValue = [NSValue valueWithCGPoint:CGPointMake(100, 50)];
+  anim.springBounciness = 12;
+
+  const CGFloat fromValue[2] = {0, 0};
+  const CGFloat toValue[2] = {100, 50};
+  HeadlessAnimation headlessAnim = HeadlessAnimation::spring(2, toValue, anim.dynamicsTension, anim.dynamicsFriction, anim.dynamicsMass);
+  headlessAnim.setFromValue(fromValue);
+  headlessAnim.threshold = anim.property.threshold;
+
+  [self _assertAnimation:anim matchesHeadless:headlessAnim];
+}
+
+- (void)testDecayMatchesAnimator
+{
+  POPDecayAnimation *anim = [POPDecayAnimation animationWithPropertyNamed:kPOPLayerPosition];
+  anim.fromValue = [NSValue valueWithCGPoint:CGPointMake(0, 0)];
+  anim.velocity = [NSValue valueWithCGPoint:CGPointMake(1000, -500)];
+
+  const CGFloat fromValue[2] = {0, 0};
+  const CGFloat velocity[2] = {1000, -500};
+  HeadlessAnimation headlessAnim = HeadlessAnimation::decay(2, velocity, anim.deceleration);
+  headlessAnim.setFromValue(fromValue);
+  headlessAnim.threshold = anim.property.threshold;
+
+  [self _assertAnimation:anim matchesHeadless:headlessAnim];
+}
+
+- (void)testBasicMatchesAnimator
+{
+  POPBasicAnimation *anim = [POPBasicAnimation easeInEaseOutAnimation];
+  anim.property = [POPAnimatableProperty propertyWithName:kPOPLayerPosition];
+  anim.fromValue = [NSValue valueWithCGPoint:CGPointMake(0, 0)];
+  anim.toValue = [NSValue valueWithCGPoint:CGPointMake(100, 50)];
+  anim.duration = 0.5;
+
+  float points[4];
+  [anim.timingFunction getControlPointAtIndex:1 values:&points[0]];
+  [anim.timingFunction getControlPointAtIndex:2 values:&points[2]];
+  const double timingControlPoints[4] = {points[0], points[1], points[2], points[3]};
+
+  const CGFloat fromValue[2] = {0, 0};
+  const CGFloat toValue[2] = {100, 50};
+  HeadlessAnimation headlessAnim = HeadlessAnimation::basic(2, toValue, anim.duration, timingControlPoints);
+  headlessAnim.setFromValue(fromValue);
+  headlessAnim.threshold = anim.property.threshold;
+
+  [self _assertAnimation:anim matchesHeadless:headlessAnim];
+}
+
+- (void)testMemoryBinding
+{
+  struct Node { double depth; float position[3]; };
+  Node nodes[4] = {};
+  nodes[2].depth = 7;
+
+  // scatter x and z of the third node, converting to float
+  HeadlessAnimator animator;
+  const POPMemoryBinding binding = POPMemoryBindingMake(nodes, 2 * sizeof(Node) + offsetof(Node, position), 2 * sizeof(float), 2, kPOPScalarTypeFloat);
+  const CGFloat toValue[2] = {10, 20};
+  const double linear[4] = {0, 0, 1, 1};
+  animator.addAnimation(HeadlessAnimation::basic(2, toValue, 1, linear), binding);
+
+  animator.renderTime(self.beginTime);
+  animator.renderTime(self.beginTime + 0.5);
+  XCTAssertEqualWithAccuracy(nodes[2].position[0], 5.f, 1e-3);
+  XCTAssertEqualWithAccuracy(nodes[2].position[2], 10.f, 1e-3);
+
+  animator.renderTime(self.beginTime + 1);
+  XCTAssertTrue(0 == animator.animationCount());
+  XCTAssertEqual(nodes[2].position[0], 10.f);
+  XCTAssertEqual(nodes[2].position[1], 0.f);
+  XCTAssertEqual(nodes[2].position[2], 20.f);
+  XCTAssertEqual(nodes[2].depth, 7.);
+  XCTAssertEqual(nodes[1].position[0], 0.f);
+  XCTAssertEqual(nodes[3].position[0], 0.f);
+}
+
+- (void)testRemovalAndCompletion
+{
+  HeadlessAnimator animator;
+  NSUInteger finishedCount = 0, cancelledCount = 0;
+  animator.setCompletion([&](HeadlessAnimationID animationID, bool finished) {
+    finished ? finishedCount++ : cancelledCount++;
+  });
+
+  CGFloat values[2] = {0, 0};
+  const CGFloat toValue[2] = {10, 10};
+  const double linear[4] = {0, 0, 1, 1};
+  HeadlessAnimationID removedID = animator.addAnimation(HeadlessAnimation::basic(2, toValue, 1, linear), values);
+  animator.addAnimation(HeadlessAnimation::basic(2, toValue, 0.5, linear), values);
+  XCTAssertTrue(2 == animator.animationCount());
+
+  animator.renderTime(self.beginTime);
+  XCTAssertTrue(animator.removeAnimation(removedID));
+  XCTAssertFalse(animator.removeAnimation(removedID));
+  XCTAssertTrue(1 == cancelledCount);
+
+  animator.renderTime(self.beginTime + 0.25);
+  XCTAssertEqualWithAccuracy(values[0], 5., 1e-3);
+  animator.renderTime(self.beginTime + 0.5);
+  XCTAssertTrue(0 == animator.animationCount());
+  XCTAssertTrue(1 == finishedCount);
+  XCTAssertEqual(values[0], 10.);
+}
+
+@end
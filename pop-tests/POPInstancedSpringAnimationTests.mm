@@ -0,0 +1,168 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <QuartzCore/QuartzCore.h>
+
+#import <XCTest/XCTest.h>
+
+#import <pop/POP.h>
+
+#import "POPAnimationTestsExtras.h"
+#import "POPBaseAnimationTests.h"
+
+// frame duration used when stepping animators
+static const CFTimeInterval kFrameDt = 1.0 / 60.0;
+
+@interface POPInstancedSpringAnimationTests : POPBaseAnimationTests
+@end
+
+@implementation POPInstancedSpringAnimationTests
+
+- (void)testMatchesSpringAnimations
+{
+  static const NSUInteger count = 8;
+  CGPoint points[count];
+  NSMutableArray *layers = [NSMutableArray array];
+
+  POPInstancedSpringAnimation *instanced = [POPInstancedSpringAnimation animationWithValueCount:2];
+  instanced.springBounciness = 12;
+  instanced.memoryBinding = POPMemoryBindingMake(points, 0, 0, 2, CGFLOAT_IS_DOUBLE ? kPOPScalarTypeDouble : kPOPScalarTypeFloat);
+  instanced.instanceStride = sizeof(CGPoint);
+  instanced.threshold = [POPAnimatableProperty propertyWithName:kPOPLayerPosition].threshold;
+
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+  CFTimeInterval beginTime = self.beginTime + 1000;
+
+  for (NSUInteger idx = 0; idx < count; idx++) {
+    const CGFloat fromValue[2] = {(CGFloat)idx, 0};
+    const CGFloat toValue[2] = {100 + (CGFloat)idx * 10, 50};
+    const CGFloat velocity[2] = {(CGFloat)idx * 100, -200};
+    XCTAssertEqual([instanced addInstanceWithFromValue:fromValue toValue:toValue velocity:velocity], idx);
+
+    POPSpringAnimation *anim = [POPSpringAnimation animationWithPropertyNamed:kPOPLayerPosition];
+    anim.springBounciness = 12;
+    anim.fromValue = [NSValue valueWithCGPoint:CGPointMake(fromValue[0], fromValue[1])];
+    anim.toValue = [NSValue valueWithCGPoint:CGPointMake(toValue[0], toValue[1])];
+    anim.velocity = [NSValue valueWithCGPoint:CGPointMake(velocity[0], velocity[1])];
+
+    CALayer *layer = [CALayer layer];
+    [layers addObject:layer];
+    [animator addAnimation:anim forObject:layer key:@"key"];
+  }
+  XCTAssertTrue(count == instanced.instanceCount);
+
+  NSObject *owner = [NSObject new];
+  [animator addAnimation:instanced forObject:owner key:@"instanced"];
+
+  NSUInteger frame = 0;
+  for (; frame < 600; frame++) {
+    [animator renderTime:beginTime + frame * kFrameDt];
+
+    // instances step exactly as their own spring animations do while running
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      CALayer *layer = layers[idx];
+      if (nil == [animator animationForObject:layer key:@"key"]) {
+        continue;
+      }
+      XCTAssertEqualWithAccuracy(layer.position.x, points[idx].x, 1e-6, @"frame %lu instance %lu", (unsigned long)frame, (unsigned long)idx);
+      XCTAssertEqualWithAccuracy(layer.position.y, points[idx].y, 1e-6, @"frame %lu instance %lu", (unsigned long)frame, (unsigned long)idx);
+    }
+
+    if (nil == [animator animationForObject:owner key:@"instanced"]) {
+      break;
+    }
+  }
+  XCTAssertTrue(frame < 600, @"animation did not finish");
+  XCTAssertTrue(0 == instanced.activeInstanceCount);
+
+  for (NSUInteger idx = 0; idx < count; idx++) {
+    XCTAssertEqual(points[idx].x, 100 + (CGFloat)idx * 10);
+    XCTAssertEqual(points[idx].y, 50);
+  }
+}
+
+- (void)testPackedInstancesByDefault
+{
+  static const NSUInteger count = 3;
+  float values[count * 2] = {0};
+
+  POPInstancedSpringAnimation *anim = [POPInstancedSpringAnimation animationWithValueCount:2];
+  anim.memoryBinding = POPMemoryBindingMake(values, 0, 0, 2, kPOPScalarTypeFloat);
+  XCTAssertTrue(0 == anim.instanceStride);
+  for (NSUInteger idx = 0; idx < count; idx++) {
+    const CGFloat fromValue[2] = {0, 0};
+    const CGFloat toValue[2] = {(CGFloat)idx + 1, -(CGFloat)idx - 1};
+    [anim addInstanceWithFromValue:fromValue toValue:toValue velocity:NULL];
+  }
+
+  NSObject *owner = [NSObject new];
+  [owner pop_addAnimation:anim forKey:@"instanced"];
+  POPAnimatorRenderDuration(self.animator, self.beginTime, 5, kFrameDt);
+
+  // each instance written to its own packed values
+  for (NSUInteger idx = 0; idx < count; idx++) {
+    XCTAssertEqual(values[idx * 2], (float)idx + 1);
+    XCTAssertEqual(values[idx * 2 + 1], -(float)idx - 1);
+  }
+}
+
+- (void)testInvalidMemoryBindingIgnored
+{
+  POPInstancedSpringAnimation *anim = [POPInstancedSpringAnimation animationWithValueCount:1];
+  anim.memoryBinding = POPMemoryBindingMake(NULL, 0, 0, 1, kPOPScalarTypeFloat);
+  XCTAssertTrue(0 == anim.memoryBinding.count);
+
+  const CGFloat fromValue[1] = {0};
+  const CGFloat toValue[1] = {1};
+  [anim addInstanceWithFromValue:fromValue toValue:toValue velocity:NULL];
+
+  // values remain available unbound
+  NSObject *owner = [NSObject new];
+  [owner pop_addAnimation:anim forKey:@"instanced"];
+  POPAnimatorRenderDuration(self.animator, self.beginTime, 5, kFrameDt);
+  CGFloat values[1];
+  [anim getValues:values forInstanceAtIndex:0];
+  XCTAssertEqual(values[0], 1.);
+}
+
+- (void)testRetargetAndCompletion
+{
+  POPInstancedSpringAnimation *anim = [POPInstancedSpringAnimation animationWithValueCount:1];
+  const CGFloat fromValue[1] = {0};
+  const CGFloat toValue[1] = {1};
+  [anim addInstanceWithFromValue:fromValue toValue:toValue velocity:NULL];
+  [anim addInstanceWithFromValue:fromValue toValue:toValue velocity:NULL];
+
+  __block BOOL finished = NO;
+  anim.completionBlock = ^(POPAnimation *a, BOOL done) {
+    finished = done;
+  };
+
+  NSObject *owner = [NSObject new];
+  [owner pop_addAnimation:anim forKey:@"instanced"];
+
+  POPAnimatorRenderDuration(self.animator, self.beginTime, 0.1, kFrameDt);
+  XCTAssertTrue(2 == anim.activeInstanceCount);
+
+  // retarget one instance midway
+  const CGFloat retargetValue[1] = {-1};
+  [anim setToValue:retargetValue forInstanceAtIndex:1];
+
+  POPAnimatorRenderDuration(self.animator, self.beginTime + 0.1, 5, kFrameDt);
+  XCTAssertTrue(finished);
+
+  CGFloat values[1];
+  [anim getValues:values forInstanceAtIndex:0];
+  XCTAssertEqual(values[0], 1.);
+  [anim getValues:values forInstanceAtIndex:1];
+  XCTAssertEqual(values[0], -1.);
+}
+
+@end
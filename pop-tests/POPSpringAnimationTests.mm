@@ -661,6 +661,66 @@ static BOOL _floatingPointEqual(CGFloat a, CGFloat b)
   XCTAssertEqualObjects(writeEvent.value, anim.toValue, @"unexpected last write event %@", writeEvent);
 }
 
+- (void)testEstimatedSettlingDuration
+{
+  POPSpringAnimation *anim = [POPSpringAnimation animationWithPropertyNamed:kPOPLayerPositionX];
+  XCTAssertEqual(anim.estimatedSettlingDuration, 0.0, @"expected no estimate without values");
+
+  anim.fromValue = @0.0;
+  anim.toValue = @100.0;
+  CFTimeInterval estimate = anim.estimatedSettlingDuration;
+  XCTAssertTrue(estimate > 0 && estimate < 5, @"unexpected estimate:%f", estimate);
+
+  POPAnimationTracer *tracer = anim.tracer;
+  [tracer start];
+
+  CALayer *layer = [CALayer layer];
+  [layer pop_addAnimation:anim forKey:@"key"];
+  POPAnimatorRenderDuration(self.animator, self.beginTime, 5, 1.0/60.0);
+  [tracer stop];
+
+  POPAnimationEvent *startEvent = [[tracer eventsWithType:kPOPAnimationEventDidStart] lastObject];
+  POPAnimationEvent *stopEvent = [[tracer eventsWithType:kPOPAnimationEventDidStop] lastObject];
+  XCTAssertNotNil(stopEvent, @"expected stop event");
+
+  // estimate bounds the actual duration within frame quantization
+  CFTimeInterval actual = stopEvent.time - startEvent.time;
+  XCTAssertTrue(fabs(estimate - actual) < MAX(0.1, 0.25 * actual), @"unexpected estimate:%f actual:%f", estimate, actual);
+}
+
+- (void)testConvergesWithinPixel
+{
+  // durations of a spring converging by threshold, and rounding to half points converging within a pixel
+  CFTimeInterval durations[2];
+  for (NSUInteger idx = 0; idx < 2; idx++) {
+    POPSpringAnimation *anim = [POPSpringAnimation animationWithPropertyNamed:kPOPLayerPositionX];
+    anim.fromValue = @0.0;
+    anim.toValue = @100.0;
+    if (1 == idx) {
+      anim.roundingFactor = 0.5;
+      anim.convergesWithinPixel = YES;
+    }
+
+    POPAnimationTracer *tracer = anim.tracer;
+    [tracer start];
+
+    CALayer *layer = [CALayer layer];
+    [layer pop_addAnimation:anim forKey:@"key"];
+    POPAnimatorRenderDuration(self.animator, self.beginTime, 5, 1.0/60.0);
+    [tracer stop];
+
+    POPAnimationEvent *startEvent = [[tracer eventsWithType:kPOPAnimationEventDidStart] lastObject];
+    POPAnimationEvent *stopEvent = [[tracer eventsWithType:kPOPAnimationEventDidStop] lastObject];
+    XCTAssertNotNil(stopEvent, @"expected stop event");
+    durations[idx] = stopEvent.time - startEvent.time;
+
+    // finishes writing the to value
+    XCTAssertEqual(layer.position.x, 100., @"unexpected final value:%f", layer.position.x);
+  }
+
+  XCTAssertTrue(durations[1] < durations[0], @"expected earlier convergence; threshold:%f pixel:%f", durations[0], durations[1]);
+}
+
 - (void)testNSCopyingSupportPOPSpringAnimation
 {
   POPSpringAnimation *anim = [POPSpringAnimation animationWithPropertyNamed:@"asdf_asdf_asdf"];
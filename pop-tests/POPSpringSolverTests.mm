@@ -0,0 +1,191 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <cmath>
+
+#import <XCTest/XCTest.h>
+
+#import <pop/POPAnimationExtras.h>
+
+#import "POPSpringSolver.h"
+
+using namespace POP;
+
+// frame duration used when stepping solvers
+static const CFTimeInterval kFrameDt = 1.0 / 60.0;
+
+// simulated duration
+static const CFTimeInterval kDuration = 2.0;
+
+typedef struct
+{
+  NSUInteger steps;
+  NSUInteger rejected;
+  double maxError;
+} POPSolverRun;
+
+static POPSolverRun run_solver(SpringSolverIntegrator integrator, CGFloat bounciness, CGFloat speed)
+{
+  CGFloat tension, friction, mass;
+  [POPSpringAnimation convertBounciness:bounciness speed:speed toTension:&tension friction:&friction mass:&mass];
+
+  SpringSolver4d solver(tension, friction, mass);
+  solver.setThreshold(0.01);
+  solver.setIntegrator(integrator);
+
+  const double p0 = 100, v0 = -500;
+  SSState4d state;
+  state.p = Vector4d(p0, 0, 0, 0);
+  state.v = Vector4d(v0, 0, 0, 0);
+
+  POPSolverRun run = {0, 0, 0};
+  CFTimeInterval t = 0;
+  while (t < kDuration) {
+    solver.advance(state, t, kFrameDt);
+    t += kFrameDt;
+
+    double p, v;
+    spring_exact(tension, friction, mass, p0, v0, t, p, v);
+    run.maxError = MAX(run.maxError, fabs(p - state.p.x));
+  }
+
+  run.steps = solver.stepCount();
+  run.rejected = solver.rejectedStepCount();
+  return run;
+}
+
+@interface POPSpringSolverTests : XCTestCase
+@end
+
+@implementation POPSpringSolverTests
+
+- (void)testAdaptiveAccuracy
+{
+  for (CGFloat bounciness = 0; bounciness <= 20; bounciness += 5) {
+    for (CGFloat speed = 0; speed <= 20; speed += 5) {
+      POPSolverRun fixed = run_solver(kSpringSolverIntegratorRK4, bounciness, speed);
+      POPSolverRun adaptive = run_solver(kSpringSolverIntegratorDormandPrince, bounciness, speed);
+
+      // adaptive integration lands on frame times exactly, unlike fixed step interpolation
+      XCTAssertTrue(adaptive.maxError <= fixed.maxError, @"unexpected adaptive error:%g fixed error:%g", adaptive.maxError, fixed.maxError);
+      XCTAssertTrue(adaptive.maxError < 0.1, @"unexpected adaptive error:%g", adaptive.maxError);
+    }
+  }
+}
+
+- (void)testAdaptiveStepCount
+{
+  // soft springs require far fewer steps than fixed 1ms integration
+  POPSolverRun fixed = run_solver(kSpringSolverIntegratorRK4, 4, 12);
+  POPSolverRun adaptive = run_solver(kSpringSolverIntegratorDormandPrince, 4, 12);
+  XCTAssertTrue(adaptive.steps * 4 < fixed.steps, @"unexpected step counts rk4:%lu dopri:%lu", (unsigned long)fixed.steps, (unsigned long)adaptive.steps);
+}
+
+- (void)testAdaptiveConvergence
+{
+  SpringSolver4d solver(300, 20, 1);
+  solver.setThreshold(0.01);
+  solver.setIntegrator(kSpringSolverIntegratorDormandPrince);
+
+  SSState4d state;
+  state.p = Vector4d(100, 100, 0, 0);
+  state.v = Vector4d::Zero();
+
+  CFTimeInterval t = 0;
+  while (!solver.hasConverged() && t < 5) {
+    solver.advance(state, t, kFrameDt);
+    t += kFrameDt;
+  }
+
+  XCTAssertTrue(solver.hasConverged(), @"expected convergence");
+  XCTAssertTrue(t < 5, @"unexpected convergence time:%f", t);
+}
+
+- (void)testTransitionMatrix
+{
+  for (CGFloat bounciness = 0; bounciness <= 20; bounciness += 5) {
+    for (CGFloat speed = 0; speed <= 20; speed += 5) {
+      CGFloat tension, friction, mass;
+      [POPSpringAnimation convertBounciness:bounciness speed:speed toTension:&tension friction:&friction mass:&mass];
+
+      SpringSolver4d rk4(tension, friction, mass), matrix(tension, friction, mass);
+      rk4.setThreshold(0.01);
+      matrix.setThreshold(0.01);
+      matrix.setIntegrator(kSpringSolverIntegratorRK4Matrix);
+
+      SSState4d rk4State, matrixState;
+      rk4State.p = matrixState.p = Vector4d(100, -50, 3, 0);
+      rk4State.v = matrixState.v = Vector4d(300, 0, -20, 1);
+
+      // uneven frames exercise step counts beyond the two cached
+      CFTimeInterval t = 0;
+      for (NSUInteger frame = 0; !rk4.hasConverged() && t < 30; frame++) {
+        const CFTimeInterval dt = kFrameDt * (1 + (frame % 3) * 0.4);
+        rk4.advance(rk4State, t, dt);
+        matrix.advance(matrixState, t, dt);
+        t += dt;
+
+        for (NSUInteger idx = 0; idx < 4; idx++) {
+          XCTAssertEqualWithAccuracy(rk4State.p(idx), matrixState.p(idx), 1e-9);
+          XCTAssertEqualWithAccuracy(rk4State.v(idx), matrixState.v(idx), 1e-9);
+        }
+        XCTAssertEqual(rk4.hasConverged(), matrix.hasConverged(), @"frame %lu", (unsigned long)frame);
+      }
+      XCTAssertEqual(rk4.stepCount(), matrix.stepCount());
+    }
+  }
+}
+
+- (void)testSettlingTimeEstimate
+{
+  for (CGFloat bounciness = 0; bounciness <= 20; bounciness += 5) {
+    for (CGFloat speed = 0; speed <= 20; speed += 5) {
+      CGFloat tension, friction, mass;
+      [POPSpringAnimation convertBounciness:bounciness speed:speed toTension:&tension friction:&friction mass:&mass];
+
+      SpringSolver4d solver(tension, friction, mass);
+      solver.setThreshold(0.01);
+
+      SSState4d state;
+      state.p = Vector4d(100, 50, 0, 0);
+      state.v = Vector4d(-500, 0, 0, 0);
+      CFTimeInterval estimate = solver.settlingTime(state);
+
+      CFTimeInterval t = 0;
+      while (!solver.hasConverged() && t < 30) {
+        solver.advance(state, t, kFrameDt);
+        t += kFrameDt;
+      }
+
+      // estimate is an envelope bound, allow for frame quantization
+      XCTAssertTrue(estimate + 2 * kFrameDt >= t, @"unexpected estimate:%f actual:%f", estimate, t);
+      XCTAssertTrue(estimate <= 1.25 * t + 2 * kFrameDt, @"unexpected estimate:%f actual:%f", estimate, t);
+    }
+  }
+}
+
+- (void)testSettlingTimeEdgeCases
+{
+  SpringSolver4d solver(300, 20, 1);
+  solver.setThreshold(0.01);
+
+  // already at rest
+  SSState4d state;
+  state.p = Vector4d::Zero();
+  state.v = Vector4d::Zero();
+  XCTAssertEqual(solver.settlingTime(state), 0.0);
+
+  // undamped springs never settle
+  SpringSolver4d undamped(300, 0, 1);
+  undamped.setThreshold(0.01);
+  state.p = Vector4d(100, 0, 0, 0);
+  XCTAssertTrue(isinf(undamped.settlingTime(state)));
+}
+
+@end
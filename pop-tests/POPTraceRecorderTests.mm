@@ -0,0 +1,138 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <QuartzCore/QuartzCore.h>
+
+#import <XCTest/XCTest.h>
+
+#import <pop/POP.h>
+#import <pop/POPAnimatorPrivate.h>
+
+#import "POPAnimationTestsExtras.h"
+#import "POPBaseAnimationTests.h"
+
+@interface POPTraceRecorderTests : POPBaseAnimationTests
+@end
+
+@implementation POPTraceRecorderTests
+
+- (void)testDecodedEventsMatchTracer
+{
+  POPBasicAnimation *anim = FBTestLinearPositionAnimation(self.beginTime);
+  POPAnimationTracer *tracer = anim.tracer;
+  [tracer start];
+
+  POPTraceRecorder *recorder = [[POPTraceRecorder alloc] initWithCapacity:1024];
+  [recorder start];
+  XCTAssertTrue(recorder.isRecording);
+
+  CALayer *layer = [CALayer layer];
+  [layer pop_addAnimation:anim forKey:@"key"];
+  POPAnimatorRenderDuration(self.animator, self.beginTime, 1.1, 0.1);
+
+  [tracer stop];
+  [recorder stop];
+  XCTAssertFalse(recorder.isRecording);
+
+  NSDictionary *streams = [POPTraceRecorder eventsFromData:[recorder data]];
+  NSArray *events = streams[@([POPTraceRecorder identifierForAnimation:anim])];
+  NSArray *tracerEvents = [tracer allEvents];
+  XCTAssertTrue(events.count == tracerEvents.count, @"unexpected events %@ expected %@", events, tracerEvents);
+
+  // same types, times and values
+  for (NSUInteger idx = 0; idx < MIN(events.count, tracerEvents.count); idx++) {
+    POPAnimationEvent *event = events[idx];
+    POPAnimationEvent *tracerEvent = tracerEvents[idx];
+    XCTAssertEqual(event.type, tracerEvent.type, @"unexpected event %@ expected %@", event, tracerEvent);
+    XCTAssertEqualWithAccuracy(event.time, tracerEvent.time, 1e-9);
+
+    if (kPOPAnimationEventPropertyWrite == event.type) {
+      CGPoint value = [[(POPAnimationValueEvent *)event value] CGPointValue];
+      CGPoint tracerValue = [[(POPAnimationValueEvent *)tracerEvent value] CGPointValue];
+      XCTAssertEqualWithAccuracy(value.x, tracerValue.x, 1e-4);
+      XCTAssertEqualWithAccuracy(value.y, tracerValue.y, 1e-4);
+    }
+  }
+}
+
+- (void)testOverwritesOldestRecords
+{
+  POPTraceRecorder *recorder = [[POPTraceRecorder alloc] initWithCapacity:10];
+  XCTAssertTrue(16 == recorder.capacity, @"unexpected capacity %lu", (unsigned long)recorder.capacity);
+  [recorder start];
+
+  POPBasicAnimation *anim = FBTestLinearPositionAnimation(self.beginTime);
+  CALayer *layer = [CALayer layer];
+  [layer pop_addAnimation:anim forKey:@"key"];
+  POPAnimatorRenderDuration(self.animator, self.beginTime, 1.1, 1.0 / 60.0);
+  [recorder stop];
+
+  XCTAssertTrue(recorder.droppedCount > 0, @"expected dropped records");
+
+  NSDictionary *streams = [POPTraceRecorder eventsFromData:[recorder data]];
+  NSArray *events = streams[@([POPTraceRecorder identifierForAnimation:anim])];
+  XCTAssertTrue(0 < events.count && events.count <= 16, @"unexpected events %@", events);
+  XCTAssertEqual([events.lastObject type], kPOPAnimationEventDidStop);
+}
+
+- (void)testChromeTraceExport
+{
+  POPTraceRecorder *recorder = [[POPTraceRecorder alloc] initWithCapacity:1024];
+  [recorder start];
+
+  POPBasicAnimation *anim = FBTestLinearPositionAnimation(self.beginTime);
+  CALayer *layer = [CALayer layer];
+  [layer pop_addAnimation:anim forKey:@"key"];
+  POPAnimatorRenderDuration(self.animator, self.beginTime, 1.1, 0.1);
+  [recorder stop];
+
+  NSData *data = [recorder chromeTraceData];
+  XCTAssertNotNil(data);
+  NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL];
+  NSArray *events = trace[@"traceEvents"];
+  XCTAssertTrue(events.count > 0, @"unexpected trace %@", trace);
+
+  NSUInteger animationID = [POPTraceRecorder identifierForAnimation:anim];
+  NSUInteger frameCount = 0, stepCount = 0, addCount = 0, beginCount = 0, endCount = 0;
+  double beginTimestamp = 0, endTimestamp = 0;
+
+  for (NSDictionary *event in events) {
+    NSString *phase = event[@"ph"];
+    if ([phase isEqualToString:@"X"] && [event[@"name"] isEqualToString:@"frame"]) {
+      frameCount++;
+      XCTAssertTrue([event[@"dur"] doubleValue] >= 0);
+    } else if ([phase isEqualToString:@"X"] && animationID == [event[@"args"][@"id"] unsignedIntegerValue]) {
+      stepCount++;
+    } else if ([phase isEqualToString:@"i"] && animationID == [event[@"args"][@"id"] unsignedIntegerValue]) {
+      addCount++;
+    } else if ([phase isEqualToString:@"b"] && animationID == [event[@"id"] unsignedIntegerValue]) {
+      beginCount++;
+      beginTimestamp = [event[@"ts"] doubleValue];
+    } else if ([phase isEqualToString:@"e"] && animationID == [event[@"id"] unsignedIntegerValue]) {
+      endCount++;
+      endTimestamp = [event[@"ts"] doubleValue];
+      XCTAssertEqualObjects(event[@"args"][@"finished"], @YES);
+    }
+  }
+
+  // one step per frame rendering the animation, bracketed by a single lifecycle
+  XCTAssertTrue(frameCount >= stepCount && stepCount > 0, @"unexpected frames %lu steps %lu", (unsigned long)frameCount, (unsigned long)stepCount);
+  XCTAssertTrue(1 == addCount);
+  XCTAssertTrue(1 == beginCount && 1 == endCount);
+  XCTAssertTrue(beginTimestamp <= endTimestamp);
+}
+
+- (void)testInvalidData
+{
+  XCTAssertNil([POPTraceRecorder eventsFromData:nil]);
+  XCTAssertNil([POPTraceRecorder eventsFromData:[@"invalid trace data" dataUsingEncoding:NSUTF8StringEncoding]]);
+  XCTAssertNil([POPTraceRecorder chromeTraceDataFromData:nil]);
+}
+
+@end
@@ -16,14 +16,21 @@
 #import <pop/POPAnimation.h>
 #import <pop/POPAnimationEvent.h>
 #import <pop/POPAnimationExtras.h>
+#import <pop/POPAnimationGroup.h>
 #import <pop/POPAnimationTracer.h>
 #import <pop/POPAnimator.h>
+#import <pop/POPAnimatorCapture.h>
+#import <pop/POPAnimatorMetrics.h>
+#import <pop/POPAnimatorReplayer.h>
 #import <pop/POPBasicAnimation.h>
 #import <pop/POPCustomAnimation.h>
 #import <pop/POPDecayAnimation.h>
 #import <pop/POPGeometry.h>
+#import <pop/POPInstancedSpringAnimation.h>
 #import <pop/POPLayerExtras.h>
+#import <pop/POPMemoryBinding.h>
 #import <pop/POPPropertyAnimation.h>
 #import <pop/POPSpringAnimation.h>
+#import <pop/POPTraceRecorder.h>
 
 #endif /* POP_POP_H */
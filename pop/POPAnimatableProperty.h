@@ -12,6 +12,7 @@
 #import <Foundation/NSObject.h>
 
 #import <pop/POPDefines.h>
+#import <pop/POPMemoryBinding.h>
 
 @class POPMutableAnimatableProperty;
 
@@ -58,6 +59,12 @@
  */
 @property (readonly, nonatomic, assign) CGFloat threshold;
 
+/**
+ @abstract Memory the property animates, independent of the animated object.
+ @discussion When bound, the animator reads and writes values directly, without calling readBlock or writeBlock. Count is zero when unbound. Bindings with a NULL base or a count outside 1 through 4 are invalid and ignored, leaving the property unbound.
+ */
+@property (readonly, nonatomic, assign) POPMemoryBinding memoryBinding;
+
 @end
 
 /**
@@ -85,6 +92,12 @@
  */
 @property (readwrite, nonatomic, assign) CGFloat threshold;
 
+/**
+ @abstract A read-write version of POPAnimatableProperty memoryBinding property.
+ @discussion Read and write blocks accessing the bound memory are provided if not set.
+ */
+@property (readwrite, nonatomic, assign) POPMemoryBinding memoryBinding;
+
 @end
 
 /**
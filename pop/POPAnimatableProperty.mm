@@ -11,6 +11,7 @@
 
 #import <QuartzCore/QuartzCore.h>
 
+#import "POPAnimationKernels.h"
 #import "POPAnimationRuntime.h"
 #import "POPCGUtils.h"
 #import "POPDefines.h"
@@ -1159,6 +1160,11 @@ static NSUInteger staticIndexWithName(NSString *aName)
   return _state->threshold;
 }
 
+- (POPMemoryBinding)memoryBinding
+{
+  return POPMemoryBinding();
+}
+
 @end
 
 #pragma mark - Concrete
@@ -1167,22 +1173,41 @@ static NSUInteger staticIndexWithName(NSString *aName)
  Concrete immutable property class.
  */
 @interface POPConcreteAnimatableProperty : POPAnimatableProperty
-- (instancetype)initWithName:(NSString *)name readBlock:(pop_animatable_read_block)read writeBlock:(pop_animatable_write_block)write threshold:(CGFloat)threshold;
+- (instancetype)initWithName:(NSString *)name readBlock:(pop_animatable_read_block)read writeBlock:(pop_animatable_write_block)write threshold:(CGFloat)threshold memoryBinding:(POPMemoryBinding)binding;
 @end
 
 @implementation POPConcreteAnimatableProperty
 
 // default synthesis
-@synthesize name, readBlock, writeBlock, threshold;
+@synthesize name, readBlock, writeBlock, threshold, memoryBinding;
 
-- (instancetype)initWithName:(NSString *)aName readBlock:(pop_animatable_read_block)aReadBlock writeBlock:(pop_animatable_write_block)aWriteBlock threshold:(CGFloat)aThreshold
+- (instancetype)initWithName:(NSString *)aName readBlock:(pop_animatable_read_block)aReadBlock writeBlock:(pop_animatable_write_block)aWriteBlock threshold:(CGFloat)aThreshold memoryBinding:(POPMemoryBinding)aBinding
 {
   self = [super init];
   if (nil != self) {
+    // invalid bindings are ignored, leaving the property unbound
+    if (!POP::memory_binding_valid(aBinding)) {
+      aBinding = POPMemoryBinding();
+    }
     name = [aName copy];
     readBlock = [aReadBlock copy];
     writeBlock = [aWriteBlock copy];
     threshold = aThreshold;
+    memoryBinding = aBinding;
+
+    // provide blocks for clients of the block interface, such as tracing and capture
+    if (POP::memory_binding_valid(aBinding)) {
+      if (nil == readBlock) {
+        readBlock = [^(id obj, CGFloat values[]) {
+          POP::memory_read(aBinding, values);
+        } copy];
+      }
+      if (nil == writeBlock) {
+        writeBlock = [^(id obj, const CGFloat values[]) {
+          POP::memory_write(aBinding, values);
+        } copy];
+      }
+    }
   }
   return self;
 }
@@ -1193,7 +1218,7 @@ static NSUInteger staticIndexWithName(NSString *aName)
 @implementation POPMutableAnimatableProperty
 
 // default synthesis
-@synthesize name, readBlock, writeBlock, threshold;
+@synthesize name, readBlock, writeBlock, threshold, memoryBinding;
 
 @end
 
@@ -1209,7 +1234,7 @@ static NSUInteger staticIndexWithName(NSString *aName)
 @implementation POPPlaceholderAnimatableProperty
 
 // default synthesis
-@synthesize name, readBlock, writeBlock, threshold;
+@synthesize name, readBlock, writeBlock, threshold, memoryBinding;
 
 @end
 
@@ -1219,7 +1244,7 @@ static NSUInteger staticIndexWithName(NSString *aName)
 @implementation POPAnimatableProperty
 
 // avoid creating backing ivars
-@dynamic name, readBlock, writeBlock, threshold;
+@dynamic name, readBlock, writeBlock, threshold, memoryBinding;
 
 static POPAnimatableProperty *placeholder = nil;
 
@@ -1244,7 +1269,7 @@ static POPAnimatableProperty *placeholder = nil;
 - (id)copyWithZone:(NSZone *)zone
 {
   if ([self isKindOfClass:[POPMutableAnimatableProperty class]]) {
-    POPConcreteAnimatableProperty *copyProperty = [[POPConcreteAnimatableProperty alloc] initWithName:self.name readBlock:self.readBlock writeBlock:self.writeBlock threshold:self.threshold];
+    POPConcreteAnimatableProperty *copyProperty = [[POPConcreteAnimatableProperty alloc] initWithName:self.name readBlock:self.readBlock writeBlock:self.writeBlock threshold:self.threshold memoryBinding:self.memoryBinding];
     return copyProperty;
   } else {
     return self;
@@ -1258,6 +1283,7 @@ static POPAnimatableProperty *placeholder = nil;
   copyProperty.readBlock = self.readBlock;
   copyProperty.writeBlock = self.writeBlock;
   copyProperty.threshold = self.threshold;
+  copyProperty.memoryBinding = self.memoryBinding;
   return copyProperty;
 }
 
@@ -14,6 +14,15 @@
 
 @class CAMediaTimingFunction;
 
+/**
+ @abstract Priorities of animations under the frame budget of their animator.
+ @discussion Priorities are ordered; any value below kPOPAnimationPriorityDefault is low, lower values being deferred first.
+ */
+typedef NS_ENUM(NSInteger, POPAnimationPriority) {
+  kPOPAnimationPriorityLow = -1,    // steps only while frame work is within budget
+  kPOPAnimationPriorityDefault = 0, // steps every frame
+};
+
 /**
  @abstract The abstract animation base class.
  @discussion Instantiate and use one of the concrete animation subclasses.
@@ -64,6 +73,12 @@
  */
 @property (copy, nonatomic) void (^animationDidApplyBlock)(POPAnimation *anim);
 
+/**
+ @abstract Optional block returning whether the animated object is visible, called each frame the animation runs.
+ @discussion Animations of objects not visible are culled: they advance without writing values or calling apply callbacks, at most ten times a second, so they still finish within a tenth of a second of their end, writing their final value. Once visible again, the next frame advances over the culled time and writes values of the current time. Defaults to nil, deferring to the visibilityBlock of the animator.
+ */
+@property (copy, nonatomic) BOOL (^visibilityBlock)(POPAnimation *anim, id obj);
+
 /**
  @abstract Flag indicating whether animation should be removed on completion.
  @discussion Setting to NO can facilitate animation reuse. Defaults to YES.
@@ -104,6 +119,18 @@ When combined with the autoreverses property, a singular animation is effectivel
  */
 @property (assign, nonatomic) BOOL repeatForever;
 
+/**
+ @abstract The rate at which the animation needs to be stepped, in frames per second.
+ @discussion Subtle or slow animations, such as a shimmer loop, may step and write less often than the display refreshes. Skipped frames are integrated on the next step. The animator runs its display link at the lowest rate satisfying all running animations. Zero steps every frame. Defaults to 0.
+ */
+@property (assign, nonatomic) NSInteger preferredFramesPerSecond;
+
+/**
+ @abstract The priority of the animation when frames exceed the animator frame budget.
+ @discussion Running animations of low priority step after all others in a frame, in descending priority, and are deferred once animation work of the frame exceeds the animator frameBudget. Deferred animations advance over the skipped time on their next step, taken at least every maximumFrameInterval of the animator. Animations of default priority or higher always step. Values are clamped to -128 through 127. Defaults to kPOPAnimationPriorityDefault.
+ */
+@property (assign, nonatomic) POPAnimationPriority priority;
+
 @end
 
 /**
@@ -10,6 +10,8 @@
 #import "POPAnimationExtras.h"
 #import "POPAnimationInternal.h"
 
+#import <atomic>
+
 #import <objc/runtime.h>
 
 #import "POPAction.h"
@@ -19,6 +21,9 @@
 
 using namespace POP;
 
+// unique animation identifiers, correlating trace records
+static std::atomic<NSUInteger> _nextAnimationID(0);
+
 #pragma mark - POPAnimation
 
 @implementation POPAnimation
@@ -39,6 +44,7 @@ using namespace POP;
   self = [super init];
   if (nil != self) {
     [self _initState];
+    _state->ID = ++_nextAnimationID;
   }
   return self;
 }
@@ -60,7 +66,7 @@ using namespace POP;
 
 - (id)delegate
 {
-  return _state->delegate;
+  return _state->getDelegate();
 }
 
 - (void)setDelegate:(id)delegate
@@ -118,37 +124,62 @@ using namespace POP;
 }
 
 FB_PROPERTY_GET(POPAnimationState, type, POPAnimationType);
-DEFINE_RW_PROPERTY_OBJ_COPY(POPAnimationState, animationDidStartBlock, setAnimationDidStartBlock:, POPAnimationDidStartBlock);
-DEFINE_RW_PROPERTY_OBJ_COPY(POPAnimationState, animationDidReachToValueBlock, setAnimationDidReachToValueBlock:, POPAnimationDidReachToValueBlock);
-DEFINE_RW_PROPERTY_OBJ_COPY(POPAnimationState, completionBlock, setCompletionBlock:, POPAnimationCompletionBlock);
-DEFINE_RW_PROPERTY_OBJ_COPY(POPAnimationState, animationDidApplyBlock, setAnimationDidApplyBlock:, POPAnimationDidApplyBlock);
-DEFINE_RW_PROPERTY_OBJ_COPY(POPAnimationState, name, setName:, NSString*);
+DEFINE_RW_COLD_PROPERTY_OBJ_COPY(animationDidStartBlock, setAnimationDidStartBlock:, POPAnimationDidStartBlock);
+DEFINE_RW_COLD_PROPERTY_OBJ_COPY(animationDidReachToValueBlock, setAnimationDidReachToValueBlock:, POPAnimationDidReachToValueBlock);
+DEFINE_RW_COLD_PROPERTY_OBJ_COPY(completionBlock, setCompletionBlock:, POPAnimationCompletionBlock);
+DEFINE_RW_COLD_PROPERTY_OBJ_COPY(animationDidApplyBlock, setAnimationDidApplyBlock:, POPAnimationDidApplyBlock, _state->hasDidApplyBlock = NULL != value;);
+DEFINE_RW_COLD_PROPERTY_OBJ_COPY(visibilityBlock, setVisibilityBlock:, POPAnimationVisibilityBlock, _state->hasVisibilityBlock = NULL != value;);
+DEFINE_RW_COLD_PROPERTY_OBJ_COPY(name, setName:, NSString*);
 DEFINE_RW_PROPERTY(POPAnimationState, beginTime, setBeginTime:, CFTimeInterval);
 DEFINE_RW_FLAG(POPAnimationState, removedOnCompletion, removedOnCompletion, setRemovedOnCompletion:);
 DEFINE_RW_FLAG(POPAnimationState, repeatForever, repeatForever, setRepeatForever:);
 
+- (NSInteger)preferredFramesPerSecond
+{
+  return _state->preferredFramesPerSecond;
+}
+
+- (void)setPreferredFramesPerSecond:(NSInteger)preferredFramesPerSecond
+{
+  NSAssert(preferredFramesPerSecond >= 0, @"unexpected negative frame rate %ld", (long)preferredFramesPerSecond);
+  _state->preferredFramesPerSecond = (uint16_t)MIN(MAX(preferredFramesPerSecond, (NSInteger)0), (NSInteger)UINT16_MAX);
+}
+
+- (POPAnimationPriority)priority
+{
+  return (POPAnimationPriority)_state->priority;
+}
+
+- (void)setPriority:(POPAnimationPriority)priority
+{
+  _state->priority = (int8_t)MIN(MAX(priority, (NSInteger)INT8_MIN), (NSInteger)INT8_MAX);
+}
+
 - (id)valueForUndefinedKey:(NSString *)key
 {
-  return _state->dict[key];
+  return _state->cold ? _state->cold->dict[key] : nil;
 }
 
 - (void)setValue:(id)value forUndefinedKey:(NSString *)key
 {
   if (!value) {
-    [_state->dict removeObjectForKey:key];
+    if (_state->cold)
+      [_state->cold->dict removeObjectForKey:key];
   } else {
-    if (!_state->dict)
-      _state->dict = [[NSMutableDictionary alloc] init];
-    _state->dict[key] = value;
+    _POPAnimationColdState *cold = _state->coldState();
+    if (!cold->dict)
+      cold->dict = [[NSMutableDictionary alloc] init];
+    cold->dict[key] = value;
   }
 }
 
 - (POPAnimationTracer *)tracer
 {
-  if (!_state->tracer) {
-    _state->tracer = [[POPAnimationTracer alloc] initWithAnimation:self];
+  _POPAnimationColdState *cold = _state->coldState();
+  if (!cold->tracer) {
+    cold->tracer = [[POPAnimationTracer alloc] initWithAnimation:self];
   }
-  return _state->tracer;
+  return cold->tracer;
 }
 
 - (NSString *)description
@@ -181,8 +212,8 @@ POPAnimationState *POPAnimationGetState(POPAnimation *a)
 
 - (void)_appendDescription:(NSMutableString *)s debug:(BOOL)debug
 {
-  if (_state->name)
-    [s appendFormat:@"; name = %@", _state->name];
+  if (_state->cold && _state->cold->name)
+    [s appendFormat:@"; name = %@", _state->cold->name];
   
   if (!self.removedOnCompletion)
     [s appendFormat:@"; removedOnCompletion = %@", POPStringFromBOOL(self.removedOnCompletion)];
@@ -199,8 +230,9 @@ POPAnimationState *POPAnimationGetState(POPAnimation *a)
     [s appendFormat:@"; beginTime = %f", _state->beginTime];
   }
   
-  for (NSString *key in _state->dict) {
-    [s appendFormat:@"; %@ = %@", key, _state->dict[key]];
+  NSDictionary *dict = _state->cold ? _state->cold->dict : nil;
+  for (NSString *key in dict) {
+    [s appendFormat:@"; %@ = %@", key, dict[key]];
   }
 }
 
@@ -290,11 +322,14 @@ POPAnimationState *POPAnimationGetState(POPAnimation *a)
     copy.animationDidReachToValueBlock = self.animationDidReachToValueBlock;
     copy.completionBlock = self.completionBlock;
     copy.animationDidApplyBlock = self.animationDidApplyBlock;
+    copy.visibilityBlock = self.visibilityBlock;
     copy.removedOnCompletion = self.removedOnCompletion;
     
     copy.autoreverses = self.autoreverses;
     copy.repeatCount = self.repeatCount;
     copy.repeatForever = self.repeatForever;
+    copy.preferredFramesPerSecond = self.preferredFramesPerSecond;
+    copy.priority = self.priority;
   }
     
   return copy;
@@ -42,26 +42,10 @@ CGFloat POPAnimationDragCoefficient()
 
 @implementation POPSpringAnimation (POPAnimationExtras)
 
-static const CGFloat POPBouncy3NormalizationRange = 20.0;
-static const CGFloat POPBouncy3NormalizationScale = 1.7;
-static const CGFloat POPBouncy3BouncinessNormalizedMin = 0.0;
-static const CGFloat POPBouncy3BouncinessNormalizedMax = 0.8;
-static const CGFloat POPBouncy3SpeedNormalizedMin = 0.5;
-static const CGFloat POPBouncy3SpeedNormalizedMax = 200;
-static const CGFloat POPBouncy3FrictionInterpolationMax = 0.01;
-
 + (void)convertBounciness:(CGFloat)bounciness speed:(CGFloat)speed toTension:(CGFloat *)outTension friction:(CGFloat *)outFriction mass:(CGFloat *)outMass
 {
-  double b = POPNormalize(bounciness / POPBouncy3NormalizationScale, 0, POPBouncy3NormalizationRange);
-  b = POPProjectNormal(b, POPBouncy3BouncinessNormalizedMin, POPBouncy3BouncinessNormalizedMax);
-
-  double s = POPNormalize(speed / POPBouncy3NormalizationScale, 0, POPBouncy3NormalizationRange);
-
-  CGFloat tension = POPProjectNormal(s, POPBouncy3SpeedNormalizedMin, POPBouncy3SpeedNormalizedMax);
-  CGFloat friction = POPQuadraticOutInterpolation(b, POPBouncy3NoBounce(tension), POPBouncy3FrictionInterpolationMax);
-
-  tension = POP_ANIMATION_TENSION_FOR_QC_TENSION(tension);
-  friction = POP_ANIMATION_FRICTION_FOR_QC_FRICTION(friction);
+  double tension, friction;
+  POPBouncy3Convert(bounciness, speed, tension, friction);
 
   if (outTension) {
     *outTension = tension;
@@ -0,0 +1,57 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <pop/POPAnimation.h>
+
+/**
+ @abstract POPAnimationGroup is a concrete animation subclass owning a timeline of child animations.
+ @discussion Children are advanced on the group clock with a single animator entry, and completion is reported once for the group. Add the group to any object, typically a common container; each child animates its own object. Child begin times, repeat counts and autoreverses are ignored, use offsets and repeat the group instead.
+ */
+@interface POPAnimationGroup : POPAnimation
+
+/**
+ @abstract Creates and returns an initialized animation group instance.
+ @discussion This is the designated initializer.
+ @return The initialized animation group instance.
+ */
++ (instancetype)animation;
+
+/**
+ @abstract Adds a child animation starting with the group.
+ @param anim The child animation to add.
+ @param obj The object to animate. Weakly referenced; the child stops when the object is deallocated.
+ */
+- (void)addAnimation:(POPAnimation *)anim forObject:(id)obj;
+
+/**
+ @abstract Adds a child animation starting at an offset into the group timeline.
+ @param anim The child animation to add.
+ @param obj The object to animate. Weakly referenced; the child stops when the object is deallocated.
+ @param offset The start offset from the beginning of the group, in seconds of group time.
+ */
+- (void)addAnimation:(POPAnimation *)anim forObject:(id)obj offset:(CFTimeInterval)offset;
+
+/**
+ @abstract The child animations, in order of addition.
+ */
+@property (readonly, nonatomic) NSArray *animations;
+
+/**
+ @abstract Additional start offset applied per child in order of addition, in seconds of group time.
+ @discussion The nth child starts at its offset plus n times the stagger. Defaults to 0.
+ */
+@property (assign, nonatomic) CFTimeInterval stagger;
+
+/**
+ @abstract The rate at which group time advances relative to media time.
+ @discussion Changes take effect from the current group time onwards. Defaults to 1.
+ */
+@property (assign, nonatomic) CGFloat speed;
+
+@end
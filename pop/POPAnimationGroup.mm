@@ -0,0 +1,98 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "POPAnimationGroupInternal.h"
+
+@implementation POPAnimationGroup
+
+#undef __state
+#define __state ((POPAnimationGroupState *)_state)
+
+#pragma mark - Lifecycle
+
++ (instancetype)animation
+{
+  return [[self alloc] init];
+}
+
+- (id)init
+{
+  return [self _init];
+}
+
+- (void)_initState
+{
+  _state = new POPAnimationGroupState(self);
+}
+
+#pragma mark - Properties
+
+DEFINE_RW_PROPERTY(POPAnimationGroupState, stagger, setStagger:, CFTimeInterval);
+DEFINE_RW_PROPERTY(POPAnimationGroupState, speed, setSpeed:, CGFloat);
+
+- (NSArray *)animations
+{
+  return __state->animations();
+}
+
+#pragma mark - Children
+
+- (void)addAnimation:(POPAnimation *)anim forObject:(id)obj
+{
+  [self addAnimation:anim forObject:obj offset:0];
+}
+
+- (void)addAnimation:(POPAnimation *)anim forObject:(id)obj offset:(CFTimeInterval)offset
+{
+  NSAssert(anim != self, @"cannot add group %@ to itself", self);
+  if (!anim || !obj || anim == self) {
+    return;
+  }
+
+  __state->addChild(obj, anim, offset);
+}
+
+#pragma mark - Utility
+
+- (void)_appendDescription:(NSMutableString *)s debug:(BOOL)debug
+{
+  [s appendFormat:@"; animations = %lu", (unsigned long)__state->children.size()];
+  if (__state->stagger)
+    [s appendFormat:@"; stagger = %f", __state->stagger];
+  if (1 != __state->speed)
+    [s appendFormat:@"; speed = %f", __state->speed];
+  if (debug && __state->prepared)
+    [s appendFormat:@"; started = %lu; finished = %lu", (unsigned long)__state->startedCount, (unsigned long)__state->finishedCount];
+}
+
+@end
+
+/**
+ *  Note that child animations are copied, while their objects are shared
+ */
+@implementation POPAnimationGroup (NSCopying)
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+
+  POPAnimationGroup *copy = [super copyWithZone:zone];
+
+  if (copy) {
+    copy.stagger = self.stagger;
+    copy.speed = self.speed;
+
+    for (const POPAnimationGroupChild &child : __state->orderedChildren()) {
+      id obj = child.object;
+      [copy addAnimation:[child.animation copy] forObject:obj offset:child.offset];
+    }
+  }
+
+  return copy;
+}
+
+@end
@@ -0,0 +1,166 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "POPAnimationGroup.h"
+
+#import <algorithm>
+#import <vector>
+
+#import "POPAnimationInternal.h"
+
+struct POPAnimationGroupChild
+{
+  id __weak object;
+  POPAnimation *animation;
+  CFTimeInterval offset;
+  CFTimeInterval time; // offset including stagger, in group time
+  NSUInteger index; // order of addition
+  bool finished;
+
+  POPAnimationGroupChild(id o, POPAnimation *a, CFTimeInterval off, NSUInteger idx) :
+  object(o),
+  animation(a),
+  offset(off),
+  time(off),
+  index(idx),
+  finished(false) {}
+
+  bool operator<(const POPAnimationGroupChild &o) const {
+    return time < o.time;
+  }
+};
+
+struct _POPAnimationGroupState : _POPAnimationState
+{
+  std::vector<POPAnimationGroupChild> children;
+  CFTimeInterval stagger;
+  CGFloat speed;
+  CFTimeInterval baseTime; // media time of group time zero
+  CFTimeInterval localTime; // group time
+  NSUInteger startedCount;
+  NSUInteger finishedCount;
+  bool prepared;
+
+  _POPAnimationGroupState(id __unsafe_unretained anim) :
+  _POPAnimationState(anim),
+  stagger(0),
+  speed(1),
+  baseTime(0),
+  localTime(0),
+  startedCount(0),
+  finishedCount(0),
+  prepared(false)
+  {
+    type = kPOPAnimationGroup;
+  }
+
+  CFTimeInterval childTime(const POPAnimationGroupChild &child) {
+    return child.offset + stagger * child.index;
+  }
+
+  void addChild(id obj, POPAnimation *anim, CFTimeInterval offset)
+  {
+    POPAnimationGroupChild child(obj, anim, offset, children.size());
+    child.time = childTime(child);
+
+    if (!prepared) {
+      children.push_back(child);
+      return;
+    }
+
+    // running; keep children sorted by start time
+    POPAnimationGetState(anim)->reset(true);
+    auto iter = std::upper_bound(children.begin(), children.end(), child);
+    if (iter - children.begin() < (NSInteger)startedCount) {
+      startedCount++;
+    }
+    children.insert(iter, child);
+  }
+
+  std::vector<POPAnimationGroupChild> orderedChildren()
+  {
+    std::vector<POPAnimationGroupChild> ordered(children);
+    std::sort(ordered.begin(), ordered.end(), [](const POPAnimationGroupChild &a, const POPAnimationGroupChild &b) {
+      return a.index < b.index;
+    });
+    return ordered;
+  }
+
+  NSArray *animations()
+  {
+    NSMutableArray *animations = [NSMutableArray arrayWithCapacity:children.size()];
+    for (const POPAnimationGroupChild &child : orderedChildren()) {
+      [animations addObject:child.animation];
+    }
+    return animations;
+  }
+
+  void prepare(CFTimeInterval time)
+  {
+    // sort by start time, such that due children form a prefix
+    for (POPAnimationGroupChild &child : children) {
+      child.time = childTime(child);
+      child.finished = false;
+      POPAnimationGetState(child.animation)->reset(true);
+    }
+    std::stable_sort(children.begin(), children.end());
+
+    baseTime = time;
+    localTime = 0;
+    startedCount = 0;
+    finishedCount = 0;
+    prepared = true;
+  }
+
+  void finishChild(POPAnimationGroupChild &child)
+  {
+    child.finished = true;
+    finishedCount++;
+    progress = (CGFloat)finishedCount / children.size();
+  }
+
+  void willRun(bool started, id obj)
+  {
+    if (started && !prepared) {
+      prepare(startTime);
+    }
+  }
+
+  bool isDone()
+  {
+    return prepared && finishedCount == children.size();
+  }
+
+  void stop(bool removing, bool done)
+  {
+    // stop running children with the group
+    if (removing) {
+      for (NSUInteger idx = 0; idx < startedCount; idx++) {
+        POPAnimationGroupChild &child = children[idx];
+        if (!child.finished) {
+          POPAnimationGetState(child.animation)->stop(true, false);
+          finishChild(child);
+        }
+      }
+    }
+
+    _POPAnimationState::stop(removing, done);
+  }
+
+  void reset(bool all)
+  {
+    _POPAnimationState::reset(all);
+    if (all) {
+      prepared = false;
+      progress = 0;
+    }
+  }
+};
+
+typedef struct _POPAnimationGroupState POPAnimationGroupState;
@@ -15,18 +15,21 @@
 #import "POPAnimationRuntime.h"
 #import "POPAnimationTracerInternal.h"
 #import "POPSpringSolver.h"
+#import "POPTraceBuffer.h"
 
 using namespace POP;
 
 /**
- Enumeration of supported animation types.
+ Enumeration of supported animation types; a byte, sharing a word of animation state with flags.
  */
-enum POPAnimationType
+enum POPAnimationType : uint8_t
 {
   kPOPAnimationSpring,
   kPOPAnimationDecay,
   kPOPAnimationBasic,
   kPOPAnimationCustom,
+  kPOPAnimationGroup,
+  kPOPAnimationInstancedSpring,
 };
 
 typedef struct
@@ -39,6 +42,7 @@ typedef void (^POPAnimationDidStartBlock)(POPAnimation *anim);
 typedef void (^POPAnimationDidReachToValueBlock)(POPAnimation *anim);
 typedef void (^POPAnimationCompletionBlock)(POPAnimation *anim, BOOL finished);
 typedef void (^POPAnimationDidApplyBlock)(POPAnimation *anim);
+typedef BOOL (^POPAnimationVisibilityBlock)(POPAnimation *anim, id obj);
 
 @interface POPAnimation()
 - (instancetype)_init;
@@ -98,6 +102,18 @@ NS_INLINE bool vec_equal(VectorConstRef v1, VectorConstRef v2)
   return *v1 == *v2;
 }
 
+// bitwise equality, telling signed zeros apart
+NS_INLINE bool vec_identical(VectorConstRef v1, VectorConstRef v2)
+{
+  if (v1 == v2) {
+    return true;
+  }
+  if (!v1 || !v2 || v1->size() != v2->size()) {
+    return false;
+  }
+  return 0 == memcmp(v1->data(), v2->data(), v1->size() * sizeof(CGFloat));
+}
+
 NS_INLINE CGFloat * vec_data(VectorRef vec)
 {
   return NULL == vec ? NULL : vec->data();
@@ -185,6 +201,17 @@ extern _POPAnimationState *POPAnimationGetState(POPAnimation *a);
   FB_PROPERTY_GET (stype, flag, ctype) \
   FB_PROPERTY_SET_OBJ_COPY (stype, flag, mutator, ctype, __VA_ARGS__)
 
+#define DEFINE_RW_COLD_PROPERTY_OBJ_COPY(property, mutator, ctype, ...) \
+- (ctype)property { \
+  return _state->cold ? _state->cold->property : nil; \
+} \
+- (void)mutator (ctype)value { \
+  if (value == [self property]) \
+    return; \
+  _state->coldState()->property = [value copy]; \
+  __VA_ARGS__ \
+}
+
 
 /**
  Internal delegate definition.
@@ -193,35 +220,43 @@ extern _POPAnimationState *POPAnimationGetState(POPAnimation *a);
 - (void)pop_animation:(POPAnimation *)anim didReachProgress:(CGFloat)progress;
 @end
 
-struct _POPAnimationState
+/**
+ Animation state rarely accessed while stepping, allocated out of line on first use.
+ */
+struct _POPAnimationColdState
 {
-  id __unsafe_unretained self;
-  POPAnimationType type;
   NSString *name;
-  NSUInteger ID;
-  CFTimeInterval beginTime;
-  CFTimeInterval startTime;
-  CFTimeInterval lastTime;
   id __weak delegate;
   POPAnimationDidStartBlock animationDidStartBlock;
   POPAnimationDidReachToValueBlock animationDidReachToValueBlock;
   POPAnimationCompletionBlock completionBlock;
   POPAnimationDidApplyBlock animationDidApplyBlock;
+  POPAnimationVisibilityBlock visibilityBlock;
   NSMutableDictionary *dict;
   POPAnimationTracer *tracer;
-  CGFloat progress;
-  NSInteger repeatCount;
-  
+
+  POP_POOL_ALLOCATED
+};
+
+/**
+ Fields read or written every frame come first, filling the first 64 bytes along with the vtable pointer; flags pack into the padding after type. Cold fields live behind a pointer. Subclasses likewise order stepping fields first.
+ */
+struct _POPAnimationState
+{
+  id __unsafe_unretained self;
+  POPAnimationType type;
+  int8_t priority;
+
   bool active:1;
   bool paused:1;
   bool removedOnCompletion:1;
-  
+
   bool delegateDidStart:1;
   bool delegateDidStop:1;
   bool delegateDidProgress:1;
   bool delegateDidApply:1;
   bool delegateDidReachToValue:1;
-  
+
   bool additive:1;
   bool didReachToValue:1;
   bool tracing:1; // corresponds to tracer started
@@ -229,24 +264,24 @@ struct _POPAnimationState
   bool autoreverses:1;
   bool repeatForever:1;
   bool customFinished:1;
+  bool hasDidApplyBlock:1; // corresponds to animationDidApplyBlock set
+  bool hasVisibilityBlock:1; // corresponds to visibilityBlock set
+
+  uint16_t preferredFramesPerSecond; // 0 steps every frame
+
+  CFTimeInterval beginTime;
+  CFTimeInterval startTime;
+  CFTimeInterval lastTime;
+  CGFloat progress;
+  NSInteger repeatCount;
+
+  NSUInteger ID;
+  _POPAnimationColdState *cold; // NULL until first written, see coldState()
 
   _POPAnimationState(id __unsafe_unretained anim) :
   self(anim),
   type((POPAnimationType)0),
-  name(nil),
-  ID(0),
-  beginTime(0),
-  startTime(0),
-  lastTime(0),
-  delegate(nil),
-  animationDidStartBlock(nil),
-  animationDidReachToValueBlock(nil),
-  completionBlock(nil),
-  animationDidApplyBlock(nil),
-  dict(nil),
-  tracer(nil),
-  progress(0),
-  repeatCount(0),
+  priority(0),
   active(false),
   paused(true),
   removedOnCompletion(true),
@@ -261,19 +296,35 @@ struct _POPAnimationState
   userSpecifiedDynamics(false),
   autoreverses(false),
   repeatForever(false),
-  customFinished(false) {}
-  
+  customFinished(false),
+  hasDidApplyBlock(false),
+  hasVisibilityBlock(false),
+  preferredFramesPerSecond(0),
+  beginTime(0),
+  startTime(0),
+  lastTime(0),
+  progress(0),
+  repeatCount(0),
+  ID(0),
+  cold(NULL) {}
+
   virtual ~_POPAnimationState()
   {
-    name = nil;
-    dict = nil;
-    tracer = nil;
-    animationDidStartBlock = NULL;
-    animationDidReachToValueBlock = NULL;
-    completionBlock = NULL;
-    animationDidApplyBlock = NULL;
+    delete cold;
+    cold = NULL;
   }
+
+  // states of all animation types share pools, by dynamic size
+  POP_POOL_ALLOCATED
   
+  // allocates cold state on first write; most animations never set a callback, name or key value
+  _POPAnimationColdState *coldState() {
+    if (NULL == cold) {
+      cold = new _POPAnimationColdState();
+    }
+    return cold;
+  }
+
   bool isCustom() {
     return kPOPAnimationCustom == type;
   }
@@ -282,13 +333,35 @@ struct _POPAnimationState
     return 0 != startTime;
   }
 
+  // below default priority animations may be deferred over the animator frame budget
+  bool isDeferrable() {
+    return priority < 0 && isStarted() && active && !paused;
+  }
+
+  // frame rate throttled animations skip frames until their frame interval elapses, within tolerance
+  bool isThrottled(CFTimeInterval time, CFTimeInterval tolerance) {
+    return 0 != preferredFramesPerSecond && time - lastTime < 1. / preferredFramesPerSecond - tolerance;
+  }
+
+  // event time; local once started
+  CFTimeInterval traceTime() {
+    return isStarted() ? lastTime - startTime : lastTime;
+  }
+
+  void traceRecord(POPAnimationEventType eventType, const CGFloat *values = NULL, NSUInteger count = 0, POPValueType valueType = kPOPValueFloat) {
+    TraceBuffer *buffer = TraceBuffer::active();
+    if (NULL != buffer) {
+      buffer->record(eventType, (uint32_t)ID, traceTime(), valueType, values, count);
+    }
+  }
+
   id getDelegate() {
-    return delegate;
+    return cold ? cold->delegate : nil;
   }
   
   void setDelegate(id d) {
-    if (d != delegate) {
-      delegate = d;
+    if (d != getDelegate()) {
+      coldState()->delegate = d;
       delegateDidStart = [d respondsToSelector:@selector(pop_animationDidStart:)];
       delegateDidStop = [d respondsToSelector:@selector(pop_animationDidStop:finished:)];
       delegateDidProgress = [d respondsToSelector:@selector(pop_animation:didReachProgress:)];
@@ -345,7 +418,7 @@ struct _POPAnimationState
     return started;
   }
 
-  void stop(bool removing, bool done) {
+  virtual void stop(bool removing, bool done) {
     if (active)
     {
       // delegate progress one last time
@@ -375,40 +448,48 @@ struct _POPAnimationState
   {
     if (delegateDidStart) {
       ActionEnabler enabler;
-      [delegate pop_animationDidStart:self];
+      [cold->delegate pop_animationDidStart:self];
     }
 
-    POPAnimationDidStartBlock block = animationDidStartBlock;
+    POPAnimationDidStartBlock block = cold ? cold->animationDidStartBlock : NULL;
     if (block != NULL) {
       ActionEnabler enabler;
       block(self);
     }
     
     if (tracing) {
-      [tracer didStart];
+      [cold->tracer didStart];
     }
+    traceRecord(kPOPAnimationEventDidStart);
   }
   
   void handleDidStop(BOOL done)
   {
     if (delegateDidStop) {
       ActionEnabler enabler;
-      [delegate pop_animationDidStop:self finished:done];
+      [cold->delegate pop_animationDidStop:self finished:done];
     }
     
     // add another strong reference to completion block before callout
-    POPAnimationCompletionBlock block = completionBlock;
+    POPAnimationCompletionBlock block = cold ? cold->completionBlock : NULL;
     if (block != NULL) {
       ActionEnabler enabler;
       block(self, done);
     }
     
     if (tracing) {
-      [tracer didStop:done];
+      [cold->tracer didStop:done];
     }
+    CGFloat finished = done;
+    traceRecord(kPOPAnimationEventDidStop, &finished, 1);
   }
 
   /* virtual functions */
+  // accepted solver integration steps since reset, counted by animator metrics
+  virtual NSUInteger solverStepCount() {
+    return 0;
+  }
+
   virtual bool isDone() {
     if (isCustom()) {
       return customFinished;
@@ -434,6 +515,9 @@ struct _POPAnimationState
         computedProgress = true;
         break;
       }
+      case kPOPAnimationInstancedSpring:
+        advanced = advance(time, dt, obj);
+        break;
       case kPOPAnimationCustom: {
         customFinished = [self _advance:obj currentTime:time elapsedTime:dt] ? false : true;
         advanced = true;
@@ -468,13 +552,16 @@ struct _POPAnimationState
   virtual void delegateApply() {
     if (delegateDidApply) {
       ActionEnabler enabler;
-      [delegate pop_animationDidApply:self];
+      [cold->delegate pop_animationDidApply:self];
     }
 
-    POPAnimationDidApplyBlock block = animationDidApplyBlock;
-    if (block != NULL) {
-      ActionEnabler enabler;
-      block(self);
+    // called every frame; avoid loading cold state unless a block is set
+    if (hasDidApplyBlock) {
+      POPAnimationDidApplyBlock block = cold->animationDidApplyBlock;
+      if (block != NULL) {
+        ActionEnabler enabler;
+        block(self);
+      }
     }
   }
   
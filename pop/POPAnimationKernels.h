@@ -0,0 +1,267 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef POP_POPAnimationKernels_h
+#define POP_POPAnimationKernels_h
+
+#include <cmath>
+
+#include "POPMath.h"
+#include "POPMemoryBinding.h"
+#include "POPPlatform.h"
+#include "POPSpringSolver.h"
+#include "POPVector.h"
+
+/**
+ Framework free advance steps of spring, decay and basic animations, operating on plain value arrays. Shared by animation states and the headless animator.
+ */
+
+namespace POP {
+
+  // clamp flags, matching POPAnimationClampFlags
+  enum
+  {
+    kClampStart = 1UL << 0,
+    kClampEnd = 1UL << 1,
+  };
+
+  // minimal velocity factor before decay animation is considered complete, in units / s
+  static const CGFloat kDecayMinimalVelocityFactor = 5.;
+
+  // default decay animation deceleration
+  static const CGFloat kDecayDecelerationDefault = 0.998;
+
+  // progress threshold for computing basic animation done
+  static const CGFloat kBasicProgressThreshold = 1e-6;
+
+  NS_INLINE Vector4d values_to_vector4d(const CGFloat *values, NSUInteger count)
+  {
+    Vector4d v = Vector4d::Zero();
+    for (NSUInteger idx = 0; NULL != values && idx < MIN(count, (NSUInteger)4); idx++) {
+      v(idx) = values[idx];
+    }
+    return v;
+  }
+
+  NS_INLINE void clamp_value(CGFloat &value, CGFloat fromValue, CGFloat toValue, NSUInteger clamp)
+  {
+    bool increasing = (toValue > fromValue);
+
+    // Clamp start of animation.
+    if ((kClampStart & clamp) &&
+        ((increasing && (value < fromValue)) || (!increasing && (value > fromValue)))) {
+      value = fromValue;
+    }
+
+    // Clamp end of animation.
+    if ((kClampEnd & clamp) &&
+        ((increasing && (value > toValue)) || (!increasing && (value < toValue)))) {
+      value = toValue;
+    }
+  }
+
+  NS_INLINE void clamp_values(CGFloat *values, const CGFloat *fromValues, const CGFloat *toValues, NSUInteger count, NSUInteger clamp)
+  {
+    if (0 == clamp)
+      return;
+
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      clamp_value(values[idx], fromValues[idx], toValues[idx], clamp);
+    }
+  }
+
+  /**
+   Advances values and velocity toward to values by dt. Velocity may be NULL.
+   */
+  NS_INLINE void spring_advance(SpringSolver4d &solver, CGFloat *values, CGFloat *velocity, const CGFloat *toValues, NSUInteger count, CFTimeInterval localTime, CFTimeInterval dt)
+  {
+    Vector4d value = values_to_vector4d(values, count);
+    Vector4d toValue = values_to_vector4d(toValues, count);
+
+    SSState4d state;
+    state.p = toValue - value;
+
+    // the solver assumes a spring of size zero
+    // flip the velocity from user perspective to solver perspective
+    state.v = values_to_vector4d(velocity, count) * -1;
+
+    solver.advance(state, localTime, dt);
+    value = toValue - state.p;
+
+    // flip velocity back to user perspective
+    const Vector4d v = state.v * -1;
+
+    for (NSUInteger idx = 0; idx < MIN(count, (NSUInteger)4); idx++) {
+      values[idx] = value(idx);
+      if (NULL != velocity) {
+        velocity[idx] = v(idx);
+      }
+    }
+  }
+
+  /**
+   Returns true if the last two written values are within threshold of the to value and of each other.
+   */
+  NS_INLINE bool spring_converged(const CGFloat *toValues, const CGFloat *previousValues, const CGFloat *previous2Values, NSUInteger count, CGFloat threshold)
+  {
+    if (NULL == previousValues || NULL == previous2Values)
+      return false;
+
+    CGFloat t = threshold / 5;
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      if ((std::abs(toValues[idx] - previousValues[idx]) >= t) || (std::abs(previous2Values[idx] - previousValues[idx]) >= t)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   Returns true once every velocity component is below the minimal decay velocity for threshold.
+   */
+  NS_INLINE bool decay_done(const CGFloat *velocity, NSUInteger count, CGFloat threshold)
+  {
+    CGFloat f = threshold * kDecayMinimalVelocityFactor;
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      if (std::abs(velocity[idx]) >= f)
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   Returns true once the remaining travel of every component, decaying to rest, is below distance.
+   */
+  NS_INLINE bool decay_travel_within(const CGFloat *velocity, NSUInteger count, CGFloat deceleration, CGFloat distance)
+  {
+    // decay_position as dt grows without bound, x = x0 + v0 * deceleration / (1 - deceleration)
+    const CGFloat k = deceleration / (1 - deceleration) / 1000.;
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      if (std::abs(velocity[idx]) * k >= distance)
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   Returns the duration until velocity decays below the minimal decay velocity for threshold.
+   */
+  NS_INLINE CFTimeInterval decay_duration(const CGFloat *velocity, NSUInteger count, CGFloat threshold, CGFloat deceleration)
+  {
+    // compute duration till threshold velocity
+    Vector4d scaledVelocity = values_to_vector4d(velocity, count) / 1000.;
+
+    double k = threshold * kDecayMinimalVelocityFactor / 1000.;
+    double d = log(deceleration) * 1000.;
+    double duration = -INFINITY;
+    for (NSUInteger idx = 0; idx < 4; idx++) {
+      duration = MAX(duration, log(fabs(k / scaledVelocity(idx))) / d);
+    }
+
+    // ensure velocity threshold is exceeded
+    if (std::isnan(duration) || duration < 0) {
+      duration = 0;
+    }
+    return duration;
+  }
+
+  /**
+   Returns timing function progress at localTime, setting timeProgress to the normalized time.
+   */
+  NS_INLINE CGFloat basic_progress(const double timingControlPoints[4], CFTimeInterval duration, CFTimeInterval localTime, CFTimeInterval &timeProgress)
+  {
+    // solve for normalized time, aka progress [0, 1]
+    CGFloat p = 1.0f;
+    if (duration > 0.0f) {
+      // cap local time to duration
+      CFTimeInterval t = MIN(localTime, duration) / duration;
+      p = POPTimingFunctionSolve(timingControlPoints, t, SOLVE_EPS(duration));
+      timeProgress = t;
+    } else {
+      timeProgress = 1.;
+    }
+    return p;
+  }
+
+  NS_INLINE bool basic_done(CFTimeInterval timeProgress)
+  {
+    return timeProgress + kBasicProgressThreshold >= 1.;
+  }
+
+  NS_INLINE bool memory_binding_valid(const POPMemoryBinding &binding)
+  {
+    return NULL != binding.base && binding.count > 0 && binding.count <= 4;
+  }
+
+  NS_INLINE size_t memory_scalar_size(POPScalarType type)
+  {
+    return kPOPScalarTypeFloat == type ? sizeof(float) : sizeof(double);
+  }
+
+  /**
+   Returns true if binding components are packed CGFloats, allowing a single memcpy.
+   */
+  NS_INLINE bool memory_binding_packed(const POPMemoryBinding &binding)
+  {
+    return (CGFLOAT_IS_DOUBLE ? kPOPScalarTypeDouble : kPOPScalarTypeFloat) == binding.type && (0 == binding.stride || sizeof(CGFloat) == binding.stride);
+  }
+
+  /**
+   Copies bound memory to values, converting from the bound scalar type.
+   */
+  NS_INLINE void memory_read(const POPMemoryBinding &binding, CGFloat *values)
+  {
+    const char *p = (const char *)binding.base + binding.offset;
+    if (memory_binding_packed(binding)) {
+      memcpy(values, p, binding.count * sizeof(CGFloat));
+      return;
+    }
+
+    // gather
+    const size_t stride = 0 != binding.stride ? binding.stride : memory_scalar_size(binding.type);
+    for (size_t idx = 0; idx < binding.count; idx++, p += stride) {
+      if (kPOPScalarTypeFloat == binding.type) {
+        float v;
+        memcpy(&v, p, sizeof(v));
+        values[idx] = v;
+      } else {
+        double v;
+        memcpy(&v, p, sizeof(v));
+        values[idx] = v;
+      }
+    }
+  }
+
+  /**
+   Copies values to bound memory, converting to the bound scalar type.
+   */
+  NS_INLINE void memory_write(const POPMemoryBinding &binding, const CGFloat *values)
+  {
+    char *p = (char *)binding.base + binding.offset;
+    if (memory_binding_packed(binding)) {
+      memcpy(p, values, binding.count * sizeof(CGFloat));
+      return;
+    }
+
+    // scatter
+    const size_t stride = 0 != binding.stride ? binding.stride : memory_scalar_size(binding.type);
+    for (size_t idx = 0; idx < binding.count; idx++, p += stride) {
+      if (kPOPScalarTypeFloat == binding.type) {
+        const float v = (float)values[idx];
+        memcpy(p, &v, sizeof(v));
+      } else {
+        const double v = values[idx];
+        memcpy(p, &v, sizeof(v));
+      }
+    }
+  }
+
+}
+
+#endif
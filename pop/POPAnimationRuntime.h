@@ -11,6 +11,7 @@
 
 #import <Foundation/Foundation.h>
 
+#import "POPAnimationKernels.h"
 #import "POPVector.h"
 
 enum POPValueType
@@ -97,6 +98,28 @@ NS_INLINE Vector4r read_values(pop_animatable_read_block read, id obj, size_t co
   return vec;
 }
 
+/**
+ Read bound memory and return a Vector4r.
+ */
+NS_INLINE Vector4r read_values(const POPMemoryBinding &binding, size_t count)
+{
+  Vector4r vec = Vector4r::Zero();
+  POPMemoryBinding b = binding;
+  b.count = MIN(b.count, count);
+  POP::memory_read(b, vec.data());
+  return vec;
+}
+
+/**
+ Write count values to bound memory.
+ */
+NS_INLINE void write_values(const POPMemoryBinding &binding, const CGFloat *values, size_t count)
+{
+  POPMemoryBinding b = binding;
+  b.count = MIN(b.count, count);
+  POP::memory_write(b, values);
+}
+
 NS_INLINE NSString *POPStringFromBOOL(BOOL value)
 {
   return value ? @"YES" : @"NO";
@@ -26,10 +26,7 @@
 
 static POPAnimationEvent *create_event(POPAnimationTracer *self, POPAnimationEventType type, id value = nil, bool recordAnimation = false)
 {
-  bool useLocalTime = 0 != self->_animationState->startTime;
-  CFTimeInterval time = useLocalTime
-    ? self->_animationState->lastTime - self->_animationState->startTime
-    : self->_animationState->lastTime;
+  CFTimeInterval time = self->_animationState->traceTime();
 
   POPAnimationEvent *event;
   __strong POPAnimation* animation = self->_animation;
@@ -9,8 +9,18 @@
 
 #import <Foundation/Foundation.h>
 
+@class POPAnimation;
 @protocol POPAnimatorDelegate;
 
+/**
+ @abstract Handling of long gaps between frames, such as after a main thread stall.
+ */
+typedef NS_ENUM(NSUInteger, POPHitchPolicy) {
+  kPOPHitchPolicyJump = 0, // advance animations over the entire gap in one frame; springs jump with transition matrix powers
+  kPOPHitchPolicyClamp,    // advance by the maximum frame interval and drop the rest of the gap
+  kPOPHitchPolicySpread,   // advance by the maximum frame interval and catch up the rest over the following frames
+};
+
 /**
  @abstract The animator class renders animations.
  */
@@ -39,6 +49,57 @@
  */
 @property (readonly, nonatomic) CFTimeInterval refreshPeriod;
 
+/**
+ @abstract The rate at which animation time advances relative to media time.
+ @discussion Values below 1 slow down and values above 1 fast-forward all animations run by the animator, eg for power saving or UI tests. Changes take effect from the current time in constant time. Begin times convert to animator time when animations are added, so the delay until a begin time scales with speed and halts while paused. Defaults to 1.
+ */
+@property (assign, nonatomic) CGFloat speed;
+
+/**
+ @abstract Flag indicating whether animation time is halted.
+ @discussion Pausing halts all animations run by the animator and suspends its display link; resuming continues animations from where they left off. Defaults to NO.
+ */
+@property (assign, nonatomic, getter=isPaused) BOOL paused;
+
+/**
+ @abstract The current animation time, taking speed and pausing into account.
+ */
+@property (readonly, nonatomic) CFTimeInterval currentTime;
+
+/**
+ @abstract The handling of frames following a gap in animation time longer than maximumFrameInterval.
+ @discussion Clamping and spreading rebase the animator clock as pausing does; dropped time delays begin times of animations not yet started. Defaults to kPOPHitchPolicyJump.
+ */
+@property (assign, nonatomic) POPHitchPolicy hitchPolicy;
+
+/**
+ @abstract The longest gap in animation time between frames advanced as is. Defaults to 0.1 seconds.
+ */
+@property (assign, nonatomic) CFTimeInterval maximumFrameInterval;
+
+/**
+ @abstract The number of frames over which kPOPHitchPolicySpread catches up the remainder of a gap. Defaults to 4.
+ */
+@property (assign, nonatomic) NSUInteger hitchRecoveryFrameCount;
+
+/**
+ @abstract Flag indicating whether display frames evaluate animations at their predicted presentation time.
+ @discussion Frames are presented a refresh after the display link fires, so animations evaluated when it fires show values one refresh stale. Targeting the presentation time instead starts animations on the frame their begin time is presented, and animations added between frames evaluate at the refresh they are expected on screen. Current time may then run up to a refresh ahead of media time. Defaults to YES.
+ */
+@property (assign, nonatomic) BOOL targetsPresentationTime;
+
+/**
+ @abstract Seconds of animation work per frame, beyond which animations of low priority are deferred.
+ @discussion Animations of default priority or higher always step, so frames may still exceed the budget. Zero derives the budget as half the refresh period, leaving the rest of the frame to layout and commit. Not applied while capturing with POPAnimatorCapture, as deferrals depend on wall time and would not replay. Defaults to 0.
+ */
+@property (assign, nonatomic) CFTimeInterval frameBudget;
+
+/**
+ @abstract Optional block returning whether an animated object is visible, for animations without a visibilityBlock of their own.
+ @discussion Animations of objects not visible are culled, see POPAnimation visibilityBlock. Suits long lists with per cell animations, eg returning whether a view has a window and intersects its scroll view bounds. Visibility is not captured by POPAnimatorCapture; captures require culling off, asserting otherwise, and treat all objects as visible. Defaults to nil.
+ */
+@property (copy, nonatomic) BOOL (^visibilityBlock)(POPAnimation *anim, id obj);
+
 @end
 
 /**
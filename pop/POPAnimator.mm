@@ -10,7 +10,9 @@
 #import "POPAnimator.h"
 #import "POPAnimatorPrivate.h"
 
+#import <algorithm>
 #import <list>
+#import <memory>
 #import <vector>
 
 #if !TARGET_OS_IPHONE
@@ -23,8 +25,13 @@
 
 #import "POPAnimation.h"
 #import "POPAnimationExtras.h"
+#import "POPAnimationGroupInternal.h"
+#import "POPAnimatorCaptureInternal.h"
+#import "POPAnimatorMetricsInternal.h"
 #import "POPBasicAnimationInternal.h"
 #import "POPDecayAnimation.h"
+#import "POPDisplayLinkFrameClock.h"
+#import "POPFrameClock.h"
 
 using namespace std;
 using namespace POP;
@@ -48,6 +55,15 @@ using namespace POP;
 static const uint64_t kDisplayTimerFrequency = 60ull; // Hz
 #endif
 
+// frame interval tolerance of throttled animations without a known refresh period
+static const CFTimeInterval kThrottleToleranceDefault = 0.001;
+
+// share of the refresh period derived frame budgets leave to animation work
+static const CFTimeInterval kFrameBudgetRefreshFraction = 0.5;
+
+// interval between steps of culled animations, bounding how late they finish
+static const CFTimeInterval kCulledStepInterval = 0.1;
+
 class POPAnimatorItem
 {
 public:
@@ -56,6 +72,8 @@ public:
   POPAnimation *animation;
   NSInteger refCount;
   id __unsafe_unretained unretainedObject;
+  bool deferred;
+  CFTimeInterval beginOffset; // animator time minus media time when added, mapping begin times into animator time
 
   POPAnimatorItem(id o, NSString *k, POPAnimation *a) POP_NOTHROW
   {
@@ -64,6 +82,8 @@ public:
     animation = a;
     refCount = 1;
     unretainedObject = o;
+    deferred = false;
+    beginOffset = 0;
   }
 
   ~POPAnimatorItem()
@@ -83,6 +103,22 @@ typedef std::list<POPAnimatorItemRef> POPAnimatorItemList;
 typedef POPAnimatorItemList::iterator POPAnimatorItemListIterator;
 typedef POPAnimatorItemList::const_iterator POPAnimatorItemListConstIterator;
 
+// animation not yet due, keyed by begin time in animator time
+struct POPAnimatorDeferredItem
+{
+  CFTimeInterval beginTime;
+  POPAnimatorItemRef item;
+
+  POPAnimatorDeferredItem(CFTimeInterval t, POPAnimatorItemRef i) : beginTime(t), item(i) {}
+
+  // min-heap ordering
+  bool operator<(const POPAnimatorDeferredItem &o) const {
+    return beginTime > o.beginTime;
+  }
+};
+
+typedef std::vector<POPAnimatorDeferredItem> POPAnimatorDeferredHeap;
+
 #if !TARGET_OS_IPHONE
 static BOOL _disableBackgroundThread = YES;
 static uint64_t _displayTimerFrequency = kDisplayTimerFrequency;
@@ -96,30 +132,66 @@ static uint64_t _displayTimerFrequency = kDisplayTimerFrequency;
   CVDisplayLinkRef _displayLink;
   dispatch_source_t _displayTimer;
   BOOL _displayTimerRunning;
-  int32_t _enqueuedRender;
 #endif
+  int32_t _enqueuedRender;
+  std::shared_ptr<FrameClock> _frameClock;
   POPAnimatorItemList _list;
   CFMutableDictionaryRef _dict;
   NSMutableArray *_observers;
   POPAnimatorItemList _pendingList;
+  POPAnimatorDeferredHeap _deferredHeap;
+  BOOL _needsDeferral;
   CFRunLoopObserverRef _pendingListObserver;
-  CFTimeInterval _slowMotionStartTime;
-  CFTimeInterval _slowMotionLastTime;
-  CFTimeInterval _slowMotionAccumulator;
+  CGFloat _speed;
+  BOOL _paused;
+  CGFloat _clockSpeed;
+  CFTimeInterval _clockMediaOrigin;
+  CFTimeInterval _clockTimeOrigin;
+  CFTimeInterval _lastMediaTime;
+  BOOL _targetsPresentationTime;
+  CFTimeInterval _lastTargetTime;
+  NSInteger _preferredFramesPerSecond;
+  NSInteger _displayFramesPerSecond;
+  CFTimeInterval _throttleTolerance;
+  CFTimeInterval _frameBudget;
+  POPAnimationVisibilityBlock _visibilityBlock;
+  POPHitchPolicy _hitchPolicy;
+  CFTimeInterval _maximumFrameInterval;
+  NSUInteger _hitchRecoveryFrameCount;
+  CFTimeInterval _lastFrameTime;
+  CFTimeInterval _hitchDebt;
+  CFTimeInterval _hitchPayment;
   CFTimeInterval _beginTime;
+  POPAnimatorMetricsRecorder _metrics;
+  POPAnimatorCapture *_capture;
   OSSpinLock _lock;
   BOOL _disableDisplayLink;
 }
+- (void)_renderFrame:(const FrameTime &)frame;
 @end
 
 @implementation POPAnimator
 @synthesize delegate = _delegate;
 @synthesize disableDisplayLink = _disableDisplayLink;
 @synthesize beginTime = _beginTime;
+@synthesize speed = _speed;
+@synthesize paused = _paused;
+@synthesize hitchPolicy = _hitchPolicy;
+@synthesize maximumFrameInterval = _maximumFrameInterval;
+@synthesize hitchRecoveryFrameCount = _hitchRecoveryFrameCount;
+@synthesize targetsPresentationTime = _targetsPresentationTime;
+@synthesize frameBudget = _frameBudget;
+@synthesize visibilityBlock = _visibilityBlock;
 
 #if !TARGET_OS_IPHONE
 static CVReturn displayLinkCallback(CVDisplayLinkRef displayLink, const CVTimeStamp *now, const CVTimeStamp *outputTime, CVOptionFlags flagsIn, CVOptionFlags *flagsOut, void *context)
 {
+  // display timer callbacks carry no time stamps, and render at the current time
+  if (NULL != outputTime && ((__bridge POPAnimator *)context)->_targetsPresentationTime) {
+    [(__bridge POPAnimator *)context _renderFrame:display_link_frame_time(now, outputTime)];
+    return kCVReturnSuccess;
+  }
+
   if (_disableBackgroundThread) {
     __unsafe_unretained POPAnimator *pa = (__bridge POPAnimator *)context;
     int32_t* enqueuedRender = &pa->_enqueuedRender;
@@ -140,7 +212,29 @@ static CVReturn displayLinkCallback(CVDisplayLinkRef displayLink, const CVTimeSt
 // call while holding lock
 static void updateDisplayLink(POPAnimator *self)
 {
-  BOOL paused = (0 == self->_observers.count && self->_list.empty()) || self->_disableDisplayLink;
+  BOOL paused = (0 == self->_observers.count && self->_list.empty() && self->_deferredHeap.empty()) || self->_disableDisplayLink || self->_paused;
+
+  // a frame clock stands in for the display link
+  if (self->_frameClock) {
+    if (paused == self->_frameClock->isRunning()) {
+      FBLogAnimInfo(paused ? @"pausing frame clock" : @"unpausing frame clock");
+      self->_frameClock->setRunning(!paused);
+    }
+    paused = YES;
+  }
+
+  // lowest rate satisfying running animations; observers see every frame
+  NSInteger framesPerSecond = 0 != self->_observers.count ? 0 : self->_preferredFramesPerSecond;
+  if (framesPerSecond != self->_displayFramesPerSecond) {
+    FBLogAnimInfo(@"display frame rate %ld", (long)framesPerSecond);
+    self->_displayFramesPerSecond = framesPerSecond;
+    if (self->_frameClock) {
+      self->_frameClock->setPreferredFramesPerSecond(framesPerSecond);
+    }
+#if TARGET_OS_IPHONE
+    display_link_set_preferred_frames_per_second(self->_displayLink, framesPerSecond);
+#endif
+  }
 
 #if TARGET_OS_IPHONE
   if (paused != self->_displayLink.paused) {
@@ -172,15 +266,142 @@ static void updateDisplayLink(POPAnimator *self)
 #endif
 }
 
-static void updateAnimatable(id obj, POPPropertyAnimationState *anim, bool shouldAvoidExtraneousWrite = false)
+// media time to animator time
+static CFTimeInterval clockTime(POPAnimator *self, CFTimeInterval mediaTime)
+{
+  return self->_clockTimeOrigin + (mediaTime - self->_clockMediaOrigin) * self->_clockSpeed;
+}
+
+// rebase clock on speed change, preserving animator time; O(1) regardless of animation count
+static void updateClock(POPAnimator *self, CFTimeInterval mediaTime)
+{
+  CGFloat speed = self->_paused ? 0 : self->_speed;
+
+#if TARGET_IPHONE_SIMULATOR
+  // support slow-motion animations
+  CGFloat f = POPAnimationDragCoefficient();
+  if (f > 1.0) {
+    speed /= f;
+  }
+#endif
+
+  if (speed != self->_clockSpeed) {
+    self->_clockTimeOrigin = clockTime(self, mediaTime);
+    self->_clockMediaOrigin = mediaTime;
+    self->_clockSpeed = speed;
+  }
+}
+
+// rebase clock to bound the animation time step of a frame following a gap, returning the frame animator time; pending renders between frames pay no installments of earlier gaps
+static CFTimeInterval applyHitchPolicy(POPAnimator *self, CFTimeInterval time, bool pending)
+{
+  // no gap without animations running in the previous frame, nor anything to catch up
+  if (0 == self->_lastFrameTime) {
+    self->_hitchDebt = 0;
+    return time;
+  }
+
+  const CFTimeInterval gap = time - self->_lastFrameTime;
+
+  if (0 != self->_hitchDebt && !pending) {
+    // catch up part of an earlier gap
+    const CFTimeInterval payment = MIN(self->_hitchDebt, self->_hitchPayment);
+    self->_hitchDebt -= payment;
+    self->_clockTimeOrigin += payment;
+    time += payment;
+  }
+
+  if (gap <= self->_maximumFrameInterval) {
+    return time;
+  }
+
+  if (self->_metrics.enabled) {
+    self->_metrics.didHitch();
+  }
+
+  if (kPOPHitchPolicyJump != self->_hitchPolicy) {
+    const CFTimeInterval dropped = gap - self->_maximumFrameInterval;
+    self->_clockTimeOrigin -= dropped;
+    time -= dropped;
+
+    if (kPOPHitchPolicySpread == self->_hitchPolicy) {
+      self->_hitchDebt += dropped;
+      self->_hitchPayment = self->_hitchDebt / MAX(self->_hitchRecoveryFrameCount, (NSUInteger)1);
+    }
+  }
+  return time;
+}
+
+// frame rate satisfying both rates, where zero is the display rate and negative none
+static NSInteger combineFrameRates(NSInteger a, NSInteger b)
+{
+  if (a < 0 || b < 0) {
+    return MAX(a, b);
+  }
+  return (0 == a || 0 == b) ? 0 : MAX(a, b);
+}
+
+// visibility of an animated object, per the animation or animator visibility block
+static bool isVisible(POPAnimator *self, POPAnimationState *state, id obj)
+{
+  POPAnimationVisibilityBlock block = state->hasVisibilityBlock ? state->cold->visibilityBlock : self->_visibilityBlock;
+
+  // visibility is not captured; captures require culling off, and all objects are visible while capturing
+  NSCAssert(nil == block || nil == self->_capture, @"visibility block set while capturing %@", self);
+  return nil == block || nil != self->_capture || block(state->self, obj);
+}
+
+// seconds of animation work per frame before low priority animations defer
+static CFTimeInterval frameBudget(POPAnimator *self, CFTimeInterval refreshPeriod)
+{
+  if (0 != self->_frameBudget) {
+    return self->_frameBudget;
+  }
+  return (refreshPeriod > 0 ? refreshPeriod : 1.0 / 60.0) * kFrameBudgetRefreshFraction;
+}
+
+// media time a commit at time is expected on screen, on the refresh grid of the last frame rendered at its target
+static CFTimeInterval presentationTime(POPAnimator *self, CFTimeInterval time)
+{
+  if (!self->_targetsPresentationTime || 0 == self->_lastTargetTime || time <= self->_lastTargetTime) {
+    return time;
+  }
+  CFTimeInterval period = self.refreshPeriod;
+  if (period <= 0) {
+    return time;
+  }
+  return self->_lastTargetTime + ceil((time - self->_lastTargetTime) / period) * period;
+}
+
+// renders a frame at its target presentation time, never before previously rendered time, or at its timestamp
+static void renderFrame(POPAnimator *self, const FrameTime &frame)
+{
+  if (self->_targetsPresentationTime) {
+    CFTimeInterval time = MAX(frame.targetTimestamp, self->_lastMediaTime);
+    self->_lastTargetTime = time;
+    [self renderTime:time];
+  } else {
+    [self renderTime:frame.timestamp];
+  }
+}
+
+// metrics to record into; NULL when disabled
+static POPAnimatorMetricsRecorder *activeMetrics(POPAnimator *self)
+{
+  return self->_metrics.enabled ? &self->_metrics : NULL;
+}
+
+static void updateAnimatable(id obj, POPPropertyAnimationState *anim, bool shouldAvoidExtraneousWrite = false, POPAnimatorMetricsRecorder *metrics = NULL)
 {
   // handle user-initiated stop or pause; halt animation
   if (!anim->active || anim->paused)
     return;
 
   if (anim->hasValue()) {
-    pop_animatable_write_block write = anim->property.writeBlock;
-    if (NULL == write)
+    // memory bound properties write directly, bypassing the write block
+    const bool bound = anim->hasMemoryBinding();
+    pop_animatable_write_block write = bound ? NULL : anim->property.writeBlock;
+    if (!bound && NULL == write)
       return;
 
     // current animation value
@@ -188,15 +409,28 @@ static void updateAnimatable(id obj, POPPropertyAnimationState *anim, bool shoul
 
     if (!anim->additive) {
 
-      // if avoiding extraneous writes and we have a read block defined
+      // skip writing the value last written, bit for bit, without reading the object back
+      if (vec_identical(currentVec, anim->writtenVec)) {
+        // update previous values as if written; support animation convergence
+        anim->previous2Vec = anim->previousVec;
+        anim->previousVec = currentVec;
+        if (metrics) {
+          metrics->didWrite(true);
+        }
+        return;
+      }
+
+      // if avoiding extraneous writes and we can read the object value
       if (shouldAvoidExtraneousWrite) {
 
-        pop_animatable_read_block read = anim->property.readBlock;
-        if (read) {
+        if (anim->canReadValues()) {
           // compare current animation value with object value
           Vector4r currentValue = currentVec->vector4r();
-          Vector4r objectValue = read_values(read, obj, anim->valueCount);
+          Vector4r objectValue = anim->readValues(obj);
           if (objectValue == currentValue) {
+            if (metrics) {
+              metrics->didWrite(true);
+            }
             return;
           }
         }
@@ -207,19 +441,38 @@ static void updateAnimatable(id obj, POPPropertyAnimationState *anim, bool shoul
       anim->previousVec = currentVec;
 
       // write value
-      write(obj, currentVec->data());
+      if (bound) {
+        write_values(anim->memoryBinding, currentVec->data(), anim->valueCount);
+      } else {
+        write(obj, currentVec->data());
+      }
+      anim->writtenVec = currentVec;
+      if (metrics) {
+        metrics->didWrite(false);
+      }
       if (anim->tracing) {
-        [anim->tracer writePropertyValue:POPBox(currentVec, anim->valueType, true)];
+        [anim->cold->tracer writePropertyValue:POPBox(currentVec, anim->valueType, true)];
       }
+      anim->traceValue(kPOPAnimationEventPropertyWrite, currentVec);
     } else {
-      pop_animatable_read_block read = anim->property.readBlock;
-      NSCAssert(read, @"additive requires an animatable property readBlock");
-      if (NULL == read) {
+      const bool canRead = anim->canReadValues();
+      NSCAssert(canRead, @"additive requires an animatable property readBlock or memory binding");
+      if (!canRead) {
+        return;
+      }
+
+      // skip adding no change, without reading the object back
+      if (vec_identical(currentVec, anim->previousVec)) {
+        anim->previous2Vec = anim->previousVec;
+        anim->previousVec = currentVec;
+        if (metrics) {
+          metrics->didWrite(true);
+        }
         return;
       }
 
       // object value
-      Vector4r objectValue = read_values(read, obj, anim->valueCount);
+      Vector4r objectValue = anim->readValues(obj);
 
       // current value
       Vector4r currentValue = currentVec->vector4r();
@@ -232,6 +485,9 @@ static void updateAnimatable(id obj, POPPropertyAnimationState *anim, bool shoul
 
       // avoid writing no change
       if (shouldAvoidExtraneousWrite && currentValue == Vector4r::Zero()) {
+        if (metrics) {
+          metrics->didWrite(true);
+        }
         return;
       }
       
@@ -243,44 +499,137 @@ static void updateAnimatable(id obj, POPPropertyAnimationState *anim, bool shoul
       anim->previousVec = currentVec;
       
       // write value
-      write(obj, currentValue.data());
+      if (bound) {
+        write_values(anim->memoryBinding, currentValue.data(), anim->valueCount);
+      } else {
+        write(obj, currentValue.data());
+      }
+      if (metrics) {
+        metrics->didWrite(false);
+      }
       if (anim->tracing) {
-        [anim->tracer writePropertyValue:POPBox(currentVec, anim->valueType, true)];
+        [anim->cold->tracer writePropertyValue:POPBox(currentVec, anim->valueType, true)];
       }
+      anim->traceValue(kPOPAnimationEventPropertyWrite, currentVec);
     }
   }
 }
 
-static void applyAnimationTime(id obj, POPAnimationState *state, CFTimeInterval time)
+static void applyAnimationTime(id obj, POPAnimationState *state, CFTimeInterval time, POPAnimatorMetricsRecorder *metrics = NULL, bool culled = false)
 {
-  if (!state->advanceTime(time, obj)) {
+  bool advanced;
+  {
+    POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseAdvance);
+    const NSUInteger stepCount = NULL != metrics ? state->solverStepCount() : 0;
+    advanced = state->advanceTime(time, obj);
+
+    // steps of this animation only; solvers reset on repeat count from zero
+    if (NULL != metrics) {
+      const NSUInteger count = state->solverStepCount();
+      metrics->didStepSolver(count >= stepCount ? count - stepCount : count);
+    }
+  }
+
+  // culled animations advance only
+  if (!advanced || culled) {
     return;
   }
   
   POPPropertyAnimationState *ps = dynamic_cast<POPPropertyAnimationState*>(state);
   if (NULL != ps) {
-    updateAnimatable(obj, ps);
+    POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseWrite);
+    updateAnimatable(obj, ps, false, metrics);
   }
   
+  POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseDelegate);
   state->delegateApply();
 }
 
-static void applyAnimationToValue(id obj, POPAnimationState *state)
+static void applyAnimationToValue(id obj, POPAnimationState *state, POPAnimatorMetricsRecorder *metrics = NULL)
 {
   POPPropertyAnimationState *ps = dynamic_cast<POPPropertyAnimationState*>(state);
 
   if (NULL != ps) {
-    
+    POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseWrite);
+
     // finalize progress
     ps->finalizeProgress();
     
     // write to value, updating only if needed
-    updateAnimatable(obj, ps, true);
+    updateAnimatable(obj, ps, true, metrics);
   }
   
+  POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseDelegate);
   state->delegateApply();
 }
 
+// records the cost of a frame step begun at media time
+static void traceStep(POPAnimationState *state, CFTimeInterval stepTime)
+{
+  TraceBuffer *buffer = TraceBuffer::active();
+  if (NULL != buffer && 0 != stepTime) {
+    const CFTimeInterval values[2] = {CACurrentMediaTime() - stepTime, state->traceTime()};
+    buffer->record(kTraceRecordStep, (uint32_t)state->ID, stepTime, 0, values, 2);
+  }
+}
+
+static void applyGroupTime(POPAnimationGroupState *group, CFTimeInterval time, POPAnimatorMetricsRecorder *metrics = NULL)
+{
+  // advance group clock
+  group->localTime += (time - group->lastTime) * group->speed;
+  group->lastTime = time;
+
+  // children are sorted by start time; start those now due
+  const CFTimeInterval localTime = group->localTime;
+  const NSUInteger count = group->children.size();
+  while (group->startedCount < count && group->children[group->startedCount].time <= localTime) {
+    group->startedCount++;
+  }
+
+  const CFTimeInterval childTime = group->baseTime + localTime;
+  for (NSUInteger idx = 0; idx < group->startedCount; idx++) {
+    POPAnimationGroupChild &child = group->children[idx];
+    if (child.finished) {
+      continue;
+    }
+
+    POPAnimationState *state = POPAnimationGetState(child.animation);
+    id obj = child.object;
+    if (nil == obj) {
+      // object exists not; stop animating
+      state->stop(true, false);
+      group->finishChild(child);
+      continue;
+    }
+
+    const CFTimeInterval stepTime = NULL != TraceBuffer::active() ? CACurrentMediaTime() : 0;
+
+    // start at the exact offset, ignoring child begin time
+    {
+      POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseStart);
+      state->startIfNeeded(obj, state->isStarted() ? childTime : group->baseTime + child.time, -state->beginTime);
+    }
+
+    if (state->active && !state->paused) {
+      applyAnimationTime(obj, state, childTime, metrics);
+
+      if (state->isDone()) {
+        // set end value
+        applyAnimationToValue(obj, state, metrics);
+
+        POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseDelegate);
+        state->stop(true, true);
+        group->finishChild(child);
+      }
+    }
+
+    traceStep(state, stepTime);
+  }
+
+  POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseDelegate);
+  group->delegateApply();
+}
+
 static POPAnimation *deleteDictEntry(POPAnimator *self, id __unsafe_unretained obj, NSString *key, BOOL cleanup = YES)
 {
   POPAnimation *anim = nil;
@@ -309,6 +658,52 @@ static POPAnimation *deleteDictEntry(POPAnimator *self, id __unsafe_unretained o
   return anim;
 }
 
+// call while holding lock
+static void deferItems(POPAnimator *self)
+{
+  if (!self->_needsDeferral) {
+    return;
+  }
+  self->_needsDeferral = NO;
+
+  // move items not yet due from list to heap
+  for (auto iter = self->_list.begin(); iter != self->_list.end();) {
+    POPAnimatorItemRef item = *iter;
+    if (!item->deferred) {
+      iter++;
+    } else {
+      item->deferred = false;
+      self->_deferredHeap.push_back(POPAnimatorDeferredItem(POPAnimationGetState(item->animation)->beginTime + item->beginOffset, item));
+      push_heap(self->_deferredHeap.begin(), self->_deferredHeap.end());
+      iter = self->_list.erase(iter);
+    }
+  }
+}
+
+// call while holding lock
+static void promoteItems(POPAnimator *self, CFTimeInterval time)
+{
+  // move due items from heap back to list
+  while (!self->_deferredHeap.empty() && self->_deferredHeap.front().beginTime <= time) {
+    pop_heap(self->_deferredHeap.begin(), self->_deferredHeap.end());
+    self->_list.push_back(self->_deferredHeap.back().item);
+    self->_deferredHeap.pop_back();
+  }
+}
+
+// call while holding lock
+static void removeDeferredItems(POPAnimator *self, BOOL (^predicate)(POPAnimatorItemRef item))
+{
+  auto end = remove_if(self->_deferredHeap.begin(), self->_deferredHeap.end(), [predicate](const POPAnimatorDeferredItem &d) {
+    return (bool)predicate(d.item);
+  });
+
+  if (end != self->_deferredHeap.end()) {
+    self->_deferredHeap.erase(end, self->_deferredHeap.end());
+    make_heap(self->_deferredHeap.begin(), self->_deferredHeap.end());
+  }
+}
+
 static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shouldRemove, bool finished)
 {
   // remove
@@ -378,7 +773,7 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
   if (nil == self) return nil;
 
 #if TARGET_OS_IPHONE
-  _displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(render)];
+  _displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(_renderDisplayLink:)];
   _displayLink.paused = YES;
   [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
 #else
@@ -407,6 +802,10 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
 
   _dict = POPDictionaryCreateMutableWeakPointerToStrongObject(5);
   _lock = OS_SPINLOCK_INIT;
+  _speed = _clockSpeed = 1;
+  _maximumFrameInterval = 0.1;
+  _hitchRecoveryFrameCount = 4;
+  _targetsPresentationTime = YES;
 
   return self;
 }
@@ -429,6 +828,10 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
   
   _dict = POPDictionaryCreateMutableWeakPointerToStrongObject(5);
   _lock = OS_SPINLOCK_INIT;
+  _speed = _clockSpeed = 1;
+  _maximumFrameInterval = 0.1;
+  _hitchRecoveryFrameCount = 4;
+  _targetsPresentationTime = YES;
   
   return self;
 }
@@ -436,6 +839,10 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
 
 - (void)dealloc
 {
+  if (_frameClock) {
+    _frameClock->setRunning(false);
+    _frameClock->setFrameCallback(nullptr);
+  }
 #if TARGET_OS_IPHONE
   [_displayLink invalidate];
 #else
@@ -459,12 +866,19 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
 - (void)_processPendingList
 {
   // rendering pending animations
-  CFTimeInterval time = [self _currentRenderTime];
-  [self _renderTime:(0 != _beginTime) ? _beginTime : time items:_pendingList];
+  CFTimeInterval time = (0 != _beginTime) ? _beginTime : presentationTime(self, [self _currentRenderTime]);
+  [_capture animator:self willRenderTime:time pending:YES];
+  updateClock(self, time);
+  time = applyHitchPolicy(self, clockTime(self, time), true);
+  [self _renderTime:time items:_pendingList pending:YES];
+  [_capture animatorDidRender:self];
 
   // lock
   OSSpinLockLock(&_lock);
 
+  // a gap handled here is not handled again by the next frame
+  _lastFrameTime = _list.empty() ? 0 : time;
+
   // clear list and observer
   _pendingList.clear();
   [self _clearPendingListObserver];
@@ -507,15 +921,34 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
   OSSpinLockUnlock(&_lock);
 }
 
-- (void)_renderTime:(CFTimeInterval)time items:(std::list<POPAnimatorItemRef>)items
+- (void)_renderTime:(CFTimeInterval)time items:(std::list<POPAnimatorItemRef>)items pending:(BOOL)pending
 {
+  POPAnimatorMetricsRecorder *metrics = activeMetrics(self);
+  if (metrics) {
+    metrics->beginFrame();
+  }
+  const CFTimeInterval frameBeginTime = CACurrentMediaTime();
+
+  // throttled animations step within half a refresh of their frame interval
+  const CFTimeInterval refreshPeriod = self.refreshPeriod;
+  _throttleTolerance = refreshPeriod > 0 ? refreshPeriod / 2 : kThrottleToleranceDefault;
+  NSInteger framesPerSecond = -1;
+
+  TraceBuffer *trace = TraceBuffer::active();
+  if (NULL != trace) {
+    trace->record(kTraceRecordFrameBegin, 0, CACurrentMediaTime());
+  }
+
   // begin transaction with actions disabled
   [CATransaction begin];
   [CATransaction setDisableActions:YES];
 
   // notify delegate
   __strong __typeof__(_delegate) delegate = _delegate;
-  [delegate animatorWillAnimate:self];
+  {
+    POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseDelegate);
+    [delegate animatorWillAnimate:self];
+  }
 
   // lock
   OSSpinLockLock(&_lock);
@@ -532,19 +965,77 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
     // unlock
     OSSpinLockUnlock(&_lock);
 
+    // low priority animations step last
+    std::vector<POPAnimatorItemRef> lowPriorityItems;
     for (auto item : vector) {
+      POPAnimationState *state = POPAnimationGetState(item->animation);
+      if (state->isDeferrable()) {
+        lowPriorityItems.push_back(item);
+        continue;
+      }
+      const CFTimeInterval stepTime = NULL != trace ? CACurrentMediaTime() : 0;
       [self _renderTime:time item:item];
+      if (!item->deferred) {
+        traceStep(state, stepTime);
+        framesPerSecond = combineFrameRates(framesPerSecond, state->preferredFramesPerSecond);
+      }
+    }
+
+    if (!lowPriorityItems.empty()) {
+      std::stable_sort(lowPriorityItems.begin(), lowPriorityItems.end(), [](const POPAnimatorItemRef &a, const POPAnimatorItemRef &b) {
+        return POPAnimationGetState(a->animation)->priority > POPAnimationGetState(b->animation)->priority;
+      });
+
+      // once over budget, defer the rest, advancing each over the skipped time at least every maximum frame interval; deferrals depend on wall time, so captures step every animation
+      const CFTimeInterval budget = frameBudget(self, refreshPeriod);
+      const bool governed = nil == _capture;
+      bool overBudget = false;
+      bool deferredAny = false;
+      for (auto item : lowPriorityItems) {
+        POPAnimationState *state = POPAnimationGetState(item->animation);
+        if (governed && !overBudget) {
+          overBudget = CACurrentMediaTime() - frameBeginTime > budget;
+        }
+        if (overBudget && time - state->lastTime < _maximumFrameInterval) {
+          if (metrics) {
+            metrics->didDefer();
+          }
+          deferredAny = true;
+          framesPerSecond = combineFrameRates(framesPerSecond, state->preferredFramesPerSecond);
+          continue;
+        }
+
+        const CFTimeInterval stepTime = NULL != trace ? CACurrentMediaTime() : 0;
+        [self _renderTime:time item:item];
+        if (!item->deferred) {
+          traceStep(state, stepTime);
+          framesPerSecond = combineFrameRates(framesPerSecond, state->preferredFramesPerSecond);
+        }
+      }
+
+      if (deferredAny && metrics) {
+        metrics->didExceedBudget();
+      }
     }
   }
 
   // notify observers
-  for (id observer in self.observers) {
-    [observer animatorDidAnimate:(id)self];
+  {
+    POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseObservers);
+    for (id observer in self.observers) {
+      [observer animatorDidAnimate:(id)self];
+    }
   }
 
   // lock
   OSSpinLockLock(&_lock);
 
+  // park animations not yet due
+  deferItems(self);
+
+  // pending animations run in the list too, so only raise the rate of the list
+  _preferredFramesPerSecond = pending ? combineFrameRates(_preferredFramesPerSecond, framesPerSecond) : MAX(framesPerSecond, (NSInteger)0);
+
   // update display link
   updateDisplayLink(self);
 
@@ -552,8 +1043,28 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
   OSSpinLockUnlock(&_lock);
 
   // notify delegate and commit
-  [delegate animatorDidAnimate:self];
+  {
+    POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseDelegate);
+    [delegate animatorDidAnimate:self];
+  }
   [CATransaction commit];
+
+  if (NULL != trace) {
+    const CFTimeInterval values[1] = {(CFTimeInterval)count};
+    trace->record(kTraceRecordFrameEnd, 0, CACurrentMediaTime(), 0, values, 1);
+  }
+
+  if (metrics) {
+    metrics->endFrame(refreshPeriod);
+
+    // lock
+    OSSpinLockLock(&_lock);
+
+    metrics->publishFrame();
+
+    // unlock
+    OSSpinLockUnlock(&_lock);
+  }
 }
 
 - (void)_renderTime:(CFTimeInterval)time item:(POPAnimatorItemRef)item
@@ -561,25 +1072,63 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
   id obj = item->object;
   POPAnimation *anim = item->animation;
   POPAnimationState *state = POPAnimationGetState(anim);
+  POPAnimatorMetricsRecorder *metrics = activeMetrics(self);
 
   if (nil == obj) {
     // object exists not; stop animating
     NSAssert(item->unretainedObject, @"object should exist");
+    POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseDelegate);
     stopAndCleanup(self, item, true, false);
   } else {
 
     // start if needed
-    state->startIfNeeded(obj, time, _slowMotionAccumulator);
+    bool started;
+    {
+      POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseStart);
+      started = state->startIfNeeded(obj, time, item->beginOffset);
+    }
+
+    // defer animations not yet due, avoiding per frame start checks
+    item->deferred = !state->isStarted() && time < state->beginTime + item->beginOffset;
+    if (item->deferred) {
+      _needsDeferral = YES;
+      return;
+    }
 
     // only run active, not paused animations
     if (state->active && !state->paused) {
+      // throttled animations advance over the skipped frames on their next step
+      if (!started && state->isThrottled(time, _throttleTolerance)) {
+        if (metrics) {
+          metrics->didThrottle();
+        }
+        return;
+      }
+
+      // culled animations advance without writing every culled step interval, over the culled time once visible
+      const bool culled = !started && kPOPAnimationGroup != state->type && !isVisible(self, state, obj);
+      if (culled) {
+        if (metrics) {
+          metrics->didCull();
+        }
+        if (time - state->lastTime < kCulledStepInterval) {
+          return;
+        }
+      }
+
       // object exists; animate
-      applyAnimationTime(obj, state, time);
+      if (kPOPAnimationGroup == state->type) {
+        applyGroupTime(static_cast<POPAnimationGroupState *>(state), time, metrics);
+      } else {
+        applyAnimationTime(obj, state, time, metrics, culled);
+      }
 
       FBLogAnimDebug(@"time:%f running:%@", time, item->animation);
       if (state->isDone()) {
         // set end value
-        applyAnimationToValue(obj, state);
+        applyAnimationToValue(obj, state, metrics);
+
+        POPAnimatorPhaseTimer timer(metrics, kPOPAnimatorPhaseDelegate);
 
         state->repeatCount--;
         if (state->repeatForever || state->repeatCount > 0) {
@@ -590,8 +1139,9 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
 
             if (state->autoreverses) {
               if (state->tracing) {
-                [state->tracer autoreversed];
+                [state->cold->tracer autoreversed];
               }
+              state->traceRecord(kPOPAnimationEventAutoreversed);
 
               if (state->type == kPOPAnimationDecay) {
                 POPDecayAnimation *decayAnimation = (POPDecayAnimation *)propAnim;
@@ -613,7 +1163,7 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
           state->stop(NO, NO);
           state->reset(true);
 
-          state->startIfNeeded(obj, time, _slowMotionAccumulator);
+          state->startIfNeeded(obj, time, item->beginOffset);
         } else {
           stopAndCleanup(self, item, state->removedOnCompletion, YES);
         }
@@ -624,6 +1174,79 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
 
 #pragma mark - API
 
+- (void)setSpeed:(CGFloat)speed
+{
+  NSAssert(speed >= 0, @"unexpected negative speed %f", speed);
+  _speed = MAX(speed, 0);
+  updateClock(self, [self _currentRenderTime]);
+}
+
+- (void)setPaused:(BOOL)paused
+{
+  _paused = paused;
+  updateClock(self, [self _currentRenderTime]);
+
+  // lock
+  OSSpinLockLock(&_lock);
+
+  // update display link
+  updateDisplayLink(self);
+
+  // unlock
+  OSSpinLockUnlock(&_lock);
+}
+
+- (CFTimeInterval)currentTime
+{
+  return clockTime(self, [self _currentRenderTime]);
+}
+
+- (std::shared_ptr<FrameClock>)frameClock
+{
+  return _frameClock;
+}
+
+- (void)setFrameClock:(std::shared_ptr<FrameClock>)frameClock
+{
+  if (frameClock == _frameClock) {
+    return;
+  }
+
+  // animator time to carry over into the timebase of the new clock
+  CFTimeInterval time = clockTime(self, [self _currentRenderTime]);
+
+  if (frameClock) {
+    __weak POPAnimator *weakSelf = self;
+    frameClock->setFrameCallback([weakSelf](const FrameTime &frame) {
+      __strong POPAnimator *strongSelf = weakSelf;
+      if (__builtin_expect(nil != strongSelf, 1)) {
+        [strongSelf _renderFrame:frame];
+      }
+    });
+  }
+
+  // lock
+  OSSpinLockLock(&_lock);
+
+  if (_frameClock) {
+    _frameClock->setRunning(false);
+    _frameClock->setFrameCallback(nullptr);
+  }
+  _frameClock = frameClock;
+
+  // rebase on the new timebase
+  _lastMediaTime = 0;
+  _lastTargetTime = 0;
+  _clockMediaOrigin = [self _currentRenderTime];
+  _clockTimeOrigin = time;
+
+  // update display link
+  updateDisplayLink(self);
+
+  // unlock
+  OSSpinLockUnlock(&_lock);
+}
+
 - (NSArray *)observers
 {
   // lock
@@ -679,12 +1302,25 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
   // create entry after potential removal
   POPAnimatorItemRef item(new POPAnimatorItem(obj, key, anim));
 
+  // begin times convert to animator time once, keeping the delay from now; later pauses and speed changes apply to it
+  CFTimeInterval mediaTime = [self _currentRenderTime];
+  item->beginOffset = clockTime(self, mediaTime) - mediaTime;
+
   // add to list and pending list
   _list.push_back(item);
   _pendingList.push_back(item);
 
   // support animation re-use, reset all animation state
-  POPAnimationGetState(anim)->reset(true);
+  POPAnimationState *state = POPAnimationGetState(anim);
+  state->reset(true);
+
+  // raise the display rate right away, lowered again by the next frame
+  _preferredFramesPerSecond = 1 == _list.size() ? state->preferredFramesPerSecond : combineFrameRates(_preferredFramesPerSecond, state->preferredFramesPerSecond);
+
+  TraceBuffer *trace = TraceBuffer::active();
+  if (NULL != trace) {
+    trace->record(kTraceRecordAdd, (uint32_t)state->ID, CACurrentMediaTime());
+  }
 
   // update display link
   updateDisplayLink(self);
@@ -694,10 +1330,14 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
 
   // schedule runloop processing of pending animations
   [self _scheduleProcessPendingList];
+
+  [_capture animator:self didAddAnimation:anim forObject:obj key:key];
 }
 
 - (void)removeAllAnimationsForObject:(id)obj
 {
+  [_capture animator:self didRemoveAnimationForObject:obj key:nil];
+
   // lock
   OSSpinLockLock(&_lock);
 
@@ -729,6 +1369,11 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
     }
   }
 
+  // remove from deferred heap
+  removeDeferredItems(self, ^BOOL(POPAnimatorItemRef deferredItem) {
+    return [animationSet containsObject:deferredItem->animation];
+  });
+
   // unlock
   OSSpinLockUnlock(&_lock);
 
@@ -771,6 +1416,11 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
     }
   }
 
+  // remove from deferred heap
+  removeDeferredItems(self, ^BOOL(POPAnimatorItemRef deferredItem) {
+    return anim == deferredItem->animation;
+  });
+
   // unlock
   OSSpinLockUnlock(&_lock);
 
@@ -781,6 +1431,7 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
 
 - (void)removeAnimationForObject:(id)obj key:(NSString *)key
 {
+  [_capture animator:self didRemoveAnimationForObject:obj key:key];
   [self removeAnimationForObject:obj key:key cleanupDict:YES];
 }
 
@@ -813,6 +1464,10 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
 
 - (CFTimeInterval)refreshPeriod
 {
+  if (_frameClock) {
+    return _frameClock->framePeriod();
+  }
+
 #if TARGET_OS_IPHONE
   return self->_displayLink.duration;
 #else
@@ -829,40 +1484,94 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
 
 - (CFTimeInterval)_currentRenderTime
 {
-  CFTimeInterval time = CACurrentMediaTime();
+  // rebase at the latest of wall clock and externally rendered time
+  CFTimeInterval time = _frameClock ? _frameClock->now() : CACurrentMediaTime();
+  return MAX(time, _lastMediaTime);
+}
 
-#if TARGET_IPHONE_SIMULATOR
-  // support slow-motion animations
-  time += _slowMotionAccumulator;
-  float f = POPAnimationDragCoefficient();
+- (void)_renderFrame:(const FrameTime &)frame
+{
+#if TARGET_OS_IPHONE
+  BOOL renderOnMainThread = YES;
+#else
+  BOOL renderOnMainThread = _disableBackgroundThread;
+#endif
 
-  if (f > 1.0) {
-    if (!_slowMotionStartTime) {
-      _slowMotionStartTime = time;
-    } else {
-      time = (time - _slowMotionStartTime) / f + _slowMotionStartTime;
-      _slowMotionLastTime = time;
-    }
-  } else if (_slowMotionStartTime) {
-    CFTimeInterval dt = (_slowMotionLastTime - time);
-    time += dt;
-    _slowMotionAccumulator += dt;
-    _slowMotionStartTime = 0;
+  if (!renderOnMainThread || [NSThread isMainThread]) {
+    renderFrame(self, frame);
+    return;
   }
-#endif
 
-  return time;
+  // frames arriving while one is enqueued are dropped
+  if (_enqueuedRender == 0) {
+    OSAtomicIncrement32(&_enqueuedRender);
+    const FrameTime enqueuedFrame = frame;
+    dispatch_async(dispatch_get_main_queue(), ^{
+      renderFrame(self, enqueuedFrame);
+      OSAtomicDecrement32(&self->_enqueuedRender);
+    });
+  }
 }
 
+#if TARGET_OS_IPHONE
+- (void)_renderDisplayLink:(CADisplayLink *)displayLink
+{
+  if (_targetsPresentationTime) {
+    renderFrame(self, display_link_frame_time(displayLink));
+  } else {
+    [self render];
+  }
+}
+#endif
+
 - (void)render
 {
-  CFTimeInterval time = [self _currentRenderTime];
+  CFTimeInterval time = CACurrentMediaTime();
   [self renderTime:time];
 }
 
 - (void)renderTime:(CFTimeInterval)time
 {
-  [self _renderTime:time items:_list];
+  [_capture animator:self willRenderTime:time pending:NO];
+
+  // convert media time to animator time
+  updateClock(self, time);
+  _lastMediaTime = time;
+  time = applyHitchPolicy(self, clockTime(self, time), false);
+
+  // lock
+  OSSpinLockLock(&_lock);
+
+  // promote deferred animations now due
+  promoteItems(self, time);
+
+  // unlock
+  OSSpinLockUnlock(&_lock);
+
+  [self _renderTime:time items:_list pending:NO];
+
+  // lock
+  OSSpinLockLock(&_lock);
+
+  // gaps are measured between frames running animations
+  _lastFrameTime = _list.empty() ? 0 : time;
+
+  // unlock
+  OSSpinLockUnlock(&_lock);
+
+  [_capture animatorDidRender:self];
+}
+
+- (NSUInteger)deferredAnimationCount
+{
+  // lock
+  OSSpinLockLock(&_lock);
+
+  NSUInteger count = _deferredHeap.size();
+
+  // unlock
+  OSSpinLockUnlock(&_lock);
+  return count;
 }
 
 - (void)addObserver:(id<POPAnimatorObserving>)observer
@@ -904,4 +1613,80 @@ static void stopAndCleanup(POPAnimator *self, POPAnimatorItemRef item, bool shou
   OSSpinLockUnlock(&_lock);
 }
 
+#pragma mark - Capture
+
+void POPAnimatorSetCapture(POPAnimator *animator, POPAnimatorCapture *capture)
+{
+  animator->_capture = capture;
+}
+
+POPAnimatorCapture *POPAnimatorGetCapture(POPAnimator *animator)
+{
+  return animator->_capture;
+}
+
+#pragma mark - Metrics
+
+void POPAnimatorSetMetricsEnabled(POPAnimator *animator, BOOL enabled)
+{
+  animator->_metrics.setEnabled(enabled);
+}
+
+BOOL POPAnimatorGetMetricsEnabled(POPAnimator *animator)
+{
+  return animator->_metrics.enabled;
+}
+
+void POPAnimatorGetMetrics(POPAnimator *animator, POPAnimatorMetrics *outMetrics)
+{
+  // lock
+  OSSpinLockLock(&animator->_lock);
+
+  animator->_metrics.copyMetrics(outMetrics);
+  outMetrics->activeAnimationCount = animator->_list.size();
+  outMetrics->pendingAnimationCount = animator->_pendingList.size();
+  outMetrics->deferredAnimationCount = animator->_deferredHeap.size();
+
+  // unlock
+  OSSpinLockUnlock(&animator->_lock);
+}
+
+void POPAnimatorResetMetrics(POPAnimator *animator)
+{
+  // lock
+  OSSpinLockLock(&animator->_lock);
+
+  animator->_metrics.reset();
+
+  // unlock
+  OSSpinLockUnlock(&animator->_lock);
+}
+
+void POPAnimatorGetHistogram(POPAnimator *animator, POPAnimatorPhase phase, NSUInteger outBuckets[kPOPAnimatorHistogramBucketCount])
+{
+  NSCAssert(phase < kPOPAnimatorPhaseCount, @"unexpected phase %lu", (unsigned long)phase);
+
+  // lock
+  OSSpinLockLock(&animator->_lock);
+
+  animator->_metrics.copyHistogram(phase, outBuckets);
+
+  // unlock
+  OSSpinLockUnlock(&animator->_lock);
+}
+
+CFTimeInterval POPAnimatorHistogramBucketUpperBound(NSUInteger bucket)
+{
+  return POPAnimatorMetricsRecorder::bucketUpperBound(bucket);
+}
+
+void POPGetAllocationStatistics(POPAllocationStatistics *outStatistics)
+{
+  const POP::PoolStatistics s = POP::pool_statistics();
+  outStatistics->allocationCount = s.allocationCount;
+  outStatistics->freeCount = s.freeCount;
+  outStatistics->refillCount = s.refillCount;
+  outStatistics->mallocCount = s.mallocCount;
+}
+
 @end
@@ -0,0 +1,51 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class POPAnimator;
+
+/**
+ @abstract Captures an animator session for deterministic replay.
+ @discussion Records animation additions and removals, to value changes, speed changes and render timestamps, along with values produced each frame, into compact binary data. Replay with POPAnimatorReplayer. Spring, basic and decay property animations are captured; custom animations and groups are not. To value, speed and hitch policy changes are captured at the next frame boundary, where they take effect. Visibility is not captured: capturing requires animator and animation visibility blocks to be nil, asserting otherwise, and objects are treated as visible while capturing. The animator frame budget is not applied while capturing, so low priority animations step every frame.
+ */
+@interface POPAnimatorCapture : NSObject
+
+/**
+ @abstract Designated initializer.
+ @param animator The animator to capture.
+ */
+- (instancetype)initWithAnimator:(POPAnimator *)animator;
+
+/**
+ @abstract The animator captured.
+ */
+@property (readonly, weak, nonatomic) POPAnimator *animator;
+
+/**
+ @abstract Flag indicating whether the session is being captured.
+ */
+@property (readonly, nonatomic, getter=isCapturing) BOOL capturing;
+
+/**
+ @abstract Start capturing, replacing any capture previously started on the animator. Animations added before start are not captured.
+ */
+- (void)start;
+
+/**
+ @abstract Stop capturing.
+ */
+- (void)stop;
+
+/**
+ @abstract Returns the data captured so far.
+ */
+- (NSData *)data;
+
+@end
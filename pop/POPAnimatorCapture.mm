@@ -0,0 +1,312 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "POPAnimatorCaptureInternal.h"
+
+#import <algorithm>
+#import <vector>
+
+#import "POPAnimator.h"
+#import "POPBasicAnimationInternal.h"
+#import "POPDecayAnimationInternal.h"
+#import "POPSpringAnimationInternal.h"
+
+/**
+ Captured animation, tracked until it stops.
+ */
+struct POPAnimatorCaptureEntry
+{
+  __weak POPPropertyAnimation *animation;
+  __weak id object;
+  NSString *key;
+  uint32_t index;
+  VectorRef toVec;
+  bool written;
+  bool recordedObjectValue;
+};
+
+static bool is_capturable(POPAnimationState *state)
+{
+  switch (state->type) {
+    case kPOPAnimationSpring:
+    case kPOPAnimationBasic:
+    case kPOPAnimationDecay:
+      return nil != static_cast<POPPropertyAnimationState *>(state)->property;
+    default:
+      return false;
+  }
+}
+
+static VectorRef copy_vector(const VectorRef &vec)
+{
+  return vec ? VectorRef(Vector::new_vector(vec.get())) : VectorRef(nullptr);
+}
+
+@implementation POPAnimatorCapture
+{
+  NSMutableData *_data;
+  NSMapTable *_objects;
+  uint32_t _objectCount;
+  uint32_t _animationCount;
+  std::vector<POPAnimatorCaptureEntry> _entries;
+  CGFloat _speed;
+  bool _capturedHitchPolicy;
+  POPHitchPolicy _hitchPolicy;
+  CFTimeInterval _maximumFrameInterval;
+  NSUInteger _hitchRecoveryFrameCount;
+}
+
+- (instancetype)initWithAnimator:(POPAnimator *)animator
+{
+  self = [super init];
+  if (nil != self) {
+    _animator = animator;
+    _data = [NSMutableData data];
+    _objects = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+    _speed = 1;
+
+    POPCaptureHeader header = {kPOPCaptureMagic, kPOPCaptureVersion, 0};
+    [_data appendBytes:&header length:sizeof(header)];
+  }
+  return self;
+}
+
+- (BOOL)isCapturing
+{
+  POPAnimator *animator = _animator;
+  return nil != animator && POPAnimatorGetCapture(animator) == self;
+}
+
+- (void)start
+{
+  POPAnimator *animator = _animator;
+  if (nil != animator) {
+    POPAnimatorSetCapture(animator, self);
+  }
+}
+
+- (void)stop
+{
+  if (self.isCapturing) {
+    POPAnimatorSetCapture(_animator, nil);
+  }
+}
+
+- (NSData *)data
+{
+  return [_data copy];
+}
+
+#pragma mark - Utility
+
+/**
+ Writes additions. Deferred until the next frame or removal, before which additions take no effect, so that values configured after adding are captured.
+ */
+- (void)_writeAdditions
+{
+  POPCaptureWriter w = {_data};
+
+  for (POPAnimatorCaptureEntry &entry : _entries) {
+    POPPropertyAnimation *anim = entry.animation;
+    id obj = entry.object;
+    if (entry.written || nil == anim || nil == obj) {
+      continue;
+    }
+    entry.written = true;
+
+    POPPropertyAnimationState *ps = static_cast<POPPropertyAnimationState *>(POPAnimationGetState(anim));
+    entry.toVec = copy_vector(ps->toVec);
+
+    w.write<uint8_t>(kPOPCaptureOpAdd);
+    w.write<uint32_t>(entry.index);
+    w.write<uint32_t>([self _indexForObject:obj]);
+    w.writeString(entry.key);
+    w.write<uint8_t>(ps->type);
+    w.writeString(ps->property.name);
+    w.write<double>(ps->property.threshold);
+    w.write<uint8_t>(ps->valueType);
+    w.write<uint8_t>((uint8_t)ps->valueCount);
+
+    // common
+    uint8_t flags = 0;
+    flags |= ps->additive ? kPOPCaptureFlagAdditive : 0;
+    flags |= ps->autoreverses ? kPOPCaptureFlagAutoreverses : 0;
+    flags |= ps->repeatForever ? kPOPCaptureFlagRepeatForever : 0;
+    flags |= ps->removedOnCompletion ? kPOPCaptureFlagRemovedOnCompletion : 0;
+    flags |= ps->convergesWithinPixel ? kPOPCaptureFlagConvergesWithinPixel : 0;
+    w.write<uint8_t>(flags);
+    w.write<double>(ps->beginTime);
+    w.write<int32_t>((int32_t)ps->repeatCount);
+    w.write<double>(ps->roundingFactor);
+    w.write<uint8_t>((uint8_t)ps->clampMode);
+    w.write<uint16_t>(ps->preferredFramesPerSecond);
+    w.write<int8_t>(ps->priority);
+    w.writeVector(ps->fromVec);
+    w.writeVector(ps->toVec);
+
+    // type specific
+    if (kPOPAnimationSpring == ps->type) {
+      POPSpringAnimationState *s = static_cast<POPSpringAnimationState *>(ps);
+      w.writeVector(s->velocityVec);
+      w.write<uint8_t>(s->userSpecifiedDynamics);
+      w.write<double>(s->springSpeed);
+      w.write<double>(s->springBounciness);
+      w.write<double>(s->dynamicsTension);
+      w.write<double>(s->dynamicsFriction);
+      w.write<double>(s->dynamicsMass);
+    } else if (kPOPAnimationBasic == ps->type) {
+      POPBasicAnimationState *s = static_cast<POPBasicAnimationState *>(ps);
+      w.write<double>(s->duration);
+      w.write<uint8_t>(nil != s->timingFunction);
+      for (NSUInteger idx = 0; idx < 4; idx++) {
+        w.write<double>(s->timingControlPoints[idx]);
+      }
+    } else {
+      POPDecayAnimationState *s = static_cast<POPDecayAnimationState *>(ps);
+      w.writeVector(s->velocityVec);
+      w.write<double>(s->deceleration);
+    }
+  }
+}
+
+- (uint32_t)_indexForObject:(id)obj
+{
+  NSNumber *index = [_objects objectForKey:obj];
+  if (nil == index) {
+    index = @(_objectCount++);
+    [_objects setObject:index forKey:obj];
+  }
+  return index.unsignedIntValue;
+}
+
+@end
+
+@implementation POPAnimatorCapture (Internal)
+
+- (void)animator:(POPAnimator *)animator didAddAnimation:(POPAnimation *)anim forObject:(id)obj key:(NSString *)key
+{
+  if (!is_capturable(POPAnimationGetState(anim))) {
+    return;
+  }
+
+  // re-added animations are tracked anew
+  _entries.erase(std::remove_if(_entries.begin(), _entries.end(), [anim](const POPAnimatorCaptureEntry &entry) {
+    return entry.animation == anim;
+  }), _entries.end());
+
+  [self _indexForObject:obj];
+  _entries.push_back({(POPPropertyAnimation *)anim, obj, [key copy], _animationCount++, nullptr, false, false});
+}
+
+- (void)animator:(POPAnimator *)animator didRemoveAnimationForObject:(id)obj key:(NSString *)key
+{
+  // removals of uncaptured objects need not replay
+  if (nil == [_objects objectForKey:obj]) {
+    return;
+  }
+
+  [self _writeAdditions];
+
+  POPCaptureWriter w = {_data};
+  w.write<uint8_t>(kPOPCaptureOpRemove);
+  w.write<uint32_t>([self _indexForObject:obj]);
+  w.writeString(nil != key ? key : @"");
+}
+
+- (void)animator:(POPAnimator *)animator willRenderTime:(CFTimeInterval)time pending:(BOOL)pending
+{
+  [self _writeAdditions];
+
+  POPCaptureWriter w = {_data};
+
+  // speed changes take effect on render
+  CGFloat speed = animator.isPaused ? 0 : animator.speed;
+  if (speed != _speed) {
+    _speed = speed;
+    w.write<uint8_t>(kPOPCaptureOpSpeed);
+    w.write<double>(speed);
+  }
+
+  // hitch handling as of the first frame and on change, since it alters frame times
+  if (!_capturedHitchPolicy || animator.hitchPolicy != _hitchPolicy || animator.maximumFrameInterval != _maximumFrameInterval || animator.hitchRecoveryFrameCount != _hitchRecoveryFrameCount) {
+    _capturedHitchPolicy = true;
+    _hitchPolicy = animator.hitchPolicy;
+    _maximumFrameInterval = animator.maximumFrameInterval;
+    _hitchRecoveryFrameCount = animator.hitchRecoveryFrameCount;
+    w.write<uint8_t>(kPOPCaptureOpHitchPolicy);
+    w.write<uint8_t>((uint8_t)_hitchPolicy);
+    w.write<double>(_maximumFrameInterval);
+    w.write<uint32_t>((uint32_t)_hitchRecoveryFrameCount);
+  }
+
+  for (POPAnimatorCaptureEntry &entry : _entries) {
+    POPPropertyAnimation *anim = entry.animation;
+    if (!entry.written || nil == anim) {
+      continue;
+    }
+    POPPropertyAnimationState *state = static_cast<POPPropertyAnimationState *>(POPAnimationGetState(anim));
+
+    // to value changes since the last frame; decay computes its own
+    if (kPOPAnimationDecay != state->type && !vec_equal(state->toVec, entry.toVec)) {
+      entry.toVec = copy_vector(state->toVec);
+      w.write<uint8_t>(kPOPCaptureOpSetToValue);
+      w.write<uint32_t>(entry.index);
+      w.writeVector(entry.toVec);
+    }
+
+    // property value as read on start
+    id obj = entry.object;
+    if (!entry.recordedObjectValue && !state->isStarted() && state->hasValue() && nil != state->property.readBlock && nil != obj) {
+      std::vector<CGFloat> values(state->valueCount, 0.);
+      state->property.readBlock(obj, values.data());
+      w.write<uint8_t>(kPOPCaptureOpObjectValue);
+      w.write<uint32_t>(entry.index);
+      w.writeVector(VectorRef(Vector::new_vector(values.size(), values.data())));
+      entry.recordedObjectValue = true;
+    }
+  }
+
+  w.write<uint8_t>(kPOPCaptureOpRender);
+  w.write<double>(time);
+  w.write<uint8_t>(pending);
+}
+
+- (void)animatorDidRender:(POPAnimator *)animator
+{
+  POPCaptureWriter w = {_data};
+
+  // drop stopped animations
+  _entries.erase(std::remove_if(_entries.begin(), _entries.end(), [](const POPAnimatorCaptureEntry &entry) {
+    POPPropertyAnimation *anim = entry.animation;
+    if (nil == anim) {
+      return true;
+    }
+    POPAnimationState *state = POPAnimationGetState(anim);
+    return state->isStarted() && !state->active;
+  }), _entries.end());
+
+  std::vector<const POPAnimatorCaptureEntry *> written;
+  for (const POPAnimatorCaptureEntry &entry : _entries) {
+    POPPropertyAnimation *anim = entry.animation;
+    POPPropertyAnimationState *state = static_cast<POPPropertyAnimationState *>(POPAnimationGetState(anim));
+    if (state->isStarted() && state->currentVec) {
+      written.push_back(&entry);
+    }
+  }
+
+  w.write<uint8_t>(kPOPCaptureOpValues);
+  w.write<uint32_t>((uint32_t)written.size());
+  for (const POPAnimatorCaptureEntry *entry : written) {
+    POPPropertyAnimation *anim = entry->animation;
+    w.write<uint32_t>(entry->index);
+    w.writeVector(static_cast<POPPropertyAnimationState *>(POPAnimationGetState(anim))->currentVec);
+  }
+}
+
+@end
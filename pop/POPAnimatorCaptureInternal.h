@@ -0,0 +1,158 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "POPAnimatorCapture.h"
+
+#import "POPDefines.h"
+#import "POPVector.h"
+
+using namespace POP;
+
+// capture header
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t reserved;
+} POPCaptureHeader;
+
+static const uint32_t kPOPCaptureMagic = 'POPC';
+static const uint16_t kPOPCaptureVersion = 4;
+
+/**
+ Captured operations, each a tag byte followed by its fields.
+ */
+enum POPCaptureOp : uint8_t
+{
+  kPOPCaptureOpAdd = 1,       // index, object, key, animation configuration
+  kPOPCaptureOpRemove,        // object, key; empty key removes all
+  kPOPCaptureOpObjectValue,   // index, property value read before start
+  kPOPCaptureOpSetToValue,    // index, values
+  kPOPCaptureOpSpeed,         // effective animator speed
+  kPOPCaptureOpRender,        // media time, pending flag
+  kPOPCaptureOpValues,        // count, then index and values of each animation
+  kPOPCaptureOpHitchPolicy,   // hitch policy, maximum frame interval, recovery frame count
+};
+
+/**
+ Animation flags of additions.
+ */
+enum POPCaptureFlags : uint8_t
+{
+  kPOPCaptureFlagAdditive = 1 << 0,
+  kPOPCaptureFlagAutoreverses = 1 << 1,
+  kPOPCaptureFlagRepeatForever = 1 << 2,
+  kPOPCaptureFlagRemovedOnCompletion = 1 << 3,
+  kPOPCaptureFlagConvergesWithinPixel = 1 << 4,
+};
+
+/**
+ Appends little-endian fields to capture data.
+ */
+struct POPCaptureWriter
+{
+  NSMutableData *data;
+
+  template <typename T>
+  void write(T value) {
+    [data appendBytes:&value length:sizeof(value)];
+  }
+
+  void writeString(NSString *string) {
+    NSData *utf8 = [string dataUsingEncoding:NSUTF8StringEncoding];
+    write<uint32_t>((uint32_t)utf8.length);
+    [data appendData:utf8];
+  }
+
+  void writeVector(const VectorConstRef &vec) {
+    const NSUInteger count = vec ? vec->size() : 0;
+    write<uint8_t>((uint8_t)count);
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      write<double>(vec->data()[idx]);
+    }
+  }
+};
+
+/**
+ Reads fields of capture data; ok is cleared on reading past the end.
+ */
+struct POPCaptureReader
+{
+  const uint8_t *p;
+  const uint8_t *end;
+  bool ok;
+
+  POPCaptureReader(NSData *data) :
+  p((const uint8_t *)data.bytes),
+  end((const uint8_t *)data.bytes + data.length),
+  ok(true) {}
+
+  bool atEnd() const {
+    return p >= end;
+  }
+
+  template <typename T>
+  T read() {
+    T value = T();
+    if (ok && (size_t)(end - p) >= sizeof(T)) {
+      memcpy(&value, p, sizeof(T));
+      p += sizeof(T);
+    } else {
+      ok = false;
+    }
+    return value;
+  }
+
+  NSString *readString() {
+    const uint32_t length = read<uint32_t>();
+    if (!ok || (size_t)(end - p) < length) {
+      ok = false;
+      return nil;
+    }
+    NSString *string = [[NSString alloc] initWithBytes:p length:length encoding:NSUTF8StringEncoding];
+    p += length;
+    return string;
+  }
+
+  VectorRef readVector() {
+    const NSUInteger count = read<uint8_t>();
+    if (0 == count) {
+      return VectorRef(nullptr);
+    }
+    CGFloat values[UINT8_MAX];
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      values[idx] = read<double>();
+    }
+    return ok ? VectorRef(Vector::new_vector(count, values)) : VectorRef(nullptr);
+  }
+};
+
+/**
+ Animator hooks, called only while capturing.
+ */
+@interface POPAnimatorCapture (Internal)
+- (void)animator:(POPAnimator *)animator didAddAnimation:(POPAnimation *)anim forObject:(id)obj key:(NSString *)key;
+- (void)animator:(POPAnimator *)animator didRemoveAnimationForObject:(id)obj key:(NSString *)key;
+- (void)animator:(POPAnimator *)animator willRenderTime:(CFTimeInterval)time pending:(BOOL)pending;
+- (void)animatorDidRender:(POPAnimator *)animator;
+@end
+
+POP_EXTERN_C_BEGIN
+
+/**
+ Sets the capture receiving animator hooks; nil to clear.
+ */
+extern void POPAnimatorSetCapture(POPAnimator *animator, POPAnimatorCapture *capture);
+
+/**
+ Returns the capture receiving animator hooks.
+ */
+extern POPAnimatorCapture *POPAnimatorGetCapture(POPAnimator *animator);
+
+POP_EXTERN_C_END
@@ -0,0 +1,112 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <pop/POPDefines.h>
+
+@class POPAnimator;
+
+/**
+ @abstract Phases of animator frame work.
+ */
+typedef NS_ENUM(NSUInteger, POPAnimatorPhase) {
+  kPOPAnimatorPhaseStart = 0, // starting animations
+  kPOPAnimatorPhaseAdvance,   // advancing animation time
+  kPOPAnimatorPhaseWrite,     // writing animated values
+  kPOPAnimatorPhaseDelegate,  // delegate and block callouts
+  kPOPAnimatorPhaseObservers, // animator observer callouts
+  kPOPAnimatorPhaseFrame,     // entire frame
+  kPOPAnimatorPhaseCount
+};
+
+/**
+ @abstract Number of buckets of phase duration histograms.
+ */
+#define kPOPAnimatorHistogramBucketCount 12
+
+/**
+ @abstract Number of most recent frames sampled by histograms.
+ */
+#define kPOPAnimatorHistogramFrameCount 256
+
+/**
+ @abstract Snapshot of animator metrics.
+ */
+typedef struct
+{
+  uint64_t frameCount;              // frames rendered since reset
+  uint64_t jankCount;               // frames taking longer than the refresh period
+  uint64_t hitchCount;              // frames following a gap longer than the maximum frame interval
+  uint64_t writeCount;              // property writes
+  uint64_t skippedWriteCount;       // property writes avoided as values were unchanged
+  uint64_t throttledStepCount;      // animation steps skipped below the display rate, per preferred frame rates
+  uint64_t deferredStepCount;       // low priority animation steps deferred over the frame budget
+  uint64_t overBudgetFrameCount;    // frames deferring low priority animations over the frame budget
+  uint64_t culledStepCount;         // animation steps skipped or taken without writing as objects were not visible
+  uint64_t solverStepCount;         // spring solver integration steps of animations of the animator
+  uint64_t processVectorAllocationCount; // value vector allocations process wide, including other animators and threads, during frames of the animator
+  CFTimeInterval phaseDuration[kPOPAnimatorPhaseCount];     // total seconds per phase since reset
+  CFTimeInterval lastPhaseDuration[kPOPAnimatorPhaseCount]; // seconds per phase of the most recent frame
+  NSUInteger activeAnimationCount;  // animations on the active list
+  NSUInteger pendingAnimationCount; // animations added since last frame
+  NSUInteger deferredAnimationCount; // animations waiting on a future begin time
+} POPAnimatorMetrics;
+
+/**
+ @abstract Process wide allocation statistics of animation states, spring solvers and value vectors.
+ @discussion These are allocated from pools of fixed size blocks with per thread free lists. Compare mallocCount with allocationCount to measure reuse.
+ */
+typedef struct
+{
+  uint64_t allocationCount; // allocations
+  uint64_t freeCount;       // frees
+  uint64_t refillCount;     // allocations refilling a per thread free list, taking a lock
+  uint64_t mallocCount;     // allocations reaching malloc, pool slabs and oversized blocks
+} POPAllocationStatistics;
+
+POP_EXTERN_C_BEGIN
+
+/**
+ @abstract Enables or disables metrics collection. Disabled by default; collection adds a few clock reads per animation per frame.
+ */
+extern void POPAnimatorSetMetricsEnabled(POPAnimator *animator, BOOL enabled);
+
+/**
+ @abstract Returns whether metrics collection is enabled.
+ */
+extern BOOL POPAnimatorGetMetricsEnabled(POPAnimator *animator);
+
+/**
+ @abstract Copies current metrics. Animation counts are always current; other metrics accumulate while enabled.
+ */
+extern void POPAnimatorGetMetrics(POPAnimator *animator, POPAnimatorMetrics *outMetrics);
+
+/**
+ @abstract Resets accumulated metrics and histograms.
+ */
+extern void POPAnimatorResetMetrics(POPAnimator *animator);
+
+/**
+ @abstract Copies a histogram of phase durations over the most recent frames.
+ @discussion Bucket i counts frames with phase duration below POPAnimatorHistogramBucketUpperBound(i), and at or above that of bucket i - 1. The last bucket is unbounded.
+ */
+extern void POPAnimatorGetHistogram(POPAnimator *animator, POPAnimatorPhase phase, NSUInteger outBuckets[kPOPAnimatorHistogramBucketCount]);
+
+/**
+ @abstract Copies process wide allocation statistics, which accumulate regardless of metrics collection.
+ */
+extern void POPGetAllocationStatistics(POPAllocationStatistics *outStatistics);
+
+/**
+ @abstract Returns the exclusive upper bound of a histogram bucket in seconds; 125µs doubling per bucket.
+ */
+extern CFTimeInterval POPAnimatorHistogramBucketUpperBound(NSUInteger bucket);
+
+POP_EXTERN_C_END
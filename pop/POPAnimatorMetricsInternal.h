@@ -0,0 +1,208 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "POPAnimatorMetrics.h"
+
+#import <cmath>
+
+#import <QuartzCore/QuartzCore.h>
+
+#import "POPVector.h"
+
+// smallest histogram bucket bound, in seconds
+static const CFTimeInterval kPOPAnimatorHistogramResolution = 0.000125;
+
+/**
+ Accumulates animator metrics. Counts of the frame in progress accumulate on the rendering thread, and are published at the end of the frame under the animator lock, which also guards copies and resets.
+ */
+class POPAnimatorMetricsRecorder
+{
+  POPAnimatorMetrics _metrics;
+  POPAnimatorMetrics _frameMetrics;
+  float _samples[kPOPAnimatorHistogramFrameCount][kPOPAnimatorPhaseCount];
+  NSUInteger _sampleCount;
+  CFTimeInterval _frame[kPOPAnimatorPhaseCount];
+  CFTimeInterval _frameBeginTime;
+  uint64_t _frameVectorAllocationCount;
+
+public:
+  bool enabled;
+
+  POPAnimatorMetricsRecorder() : enabled(false)
+  {
+    memset(&_frameMetrics, 0, sizeof(_frameMetrics));
+    memset(_frame, 0, sizeof(_frame));
+    reset();
+  }
+
+  ~POPAnimatorMetricsRecorder()
+  {
+    setEnabled(false);
+  }
+
+  // process wide vector allocation counts advance while any recorder is enabled
+  void setEnabled(bool e)
+  {
+    if (e != enabled) {
+      POP::metricsCounterClients().fetch_add(e ? 1 : -1, std::memory_order_relaxed);
+      enabled = e;
+    }
+  }
+
+  // call while holding the animator lock
+  void reset()
+  {
+    memset(&_metrics, 0, sizeof(_metrics));
+    memset(_samples, 0, sizeof(_samples));
+    _sampleCount = 0;
+  }
+
+  void beginFrame()
+  {
+    memset(_frame, 0, sizeof(_frame));
+    _frameVectorAllocationCount = POP::Vector::allocationCount();
+    _frameBeginTime = CACurrentMediaTime();
+  }
+
+  void endFrame(CFTimeInterval refreshPeriod)
+  {
+    _frame[kPOPAnimatorPhaseFrame] = CACurrentMediaTime() - _frameBeginTime;
+
+    _frameMetrics.frameCount++;
+    if (_frame[kPOPAnimatorPhaseFrame] > (0 != refreshPeriod ? refreshPeriod : 1.0 / 60.0)) {
+      _frameMetrics.jankCount++;
+    }
+    _frameMetrics.processVectorAllocationCount += POP::Vector::allocationCount() - _frameVectorAllocationCount;
+  }
+
+  // call while holding the animator lock, following endFrame
+  void publishFrame()
+  {
+    _metrics.frameCount += _frameMetrics.frameCount;
+    _metrics.jankCount += _frameMetrics.jankCount;
+    _metrics.hitchCount += _frameMetrics.hitchCount;
+    _metrics.writeCount += _frameMetrics.writeCount;
+    _metrics.skippedWriteCount += _frameMetrics.skippedWriteCount;
+    _metrics.throttledStepCount += _frameMetrics.throttledStepCount;
+    _metrics.deferredStepCount += _frameMetrics.deferredStepCount;
+    _metrics.overBudgetFrameCount += _frameMetrics.overBudgetFrameCount;
+    _metrics.culledStepCount += _frameMetrics.culledStepCount;
+    _metrics.solverStepCount += _frameMetrics.solverStepCount;
+    _metrics.processVectorAllocationCount += _frameMetrics.processVectorAllocationCount;
+    memset(&_frameMetrics, 0, sizeof(_frameMetrics));
+
+    // accumulate and sample phases
+    float *sample = _samples[_sampleCount++ % kPOPAnimatorHistogramFrameCount];
+    for (NSUInteger phase = 0; phase < kPOPAnimatorPhaseCount; phase++) {
+      _metrics.phaseDuration[phase] += _frame[phase];
+      _metrics.lastPhaseDuration[phase] = _frame[phase];
+      sample[phase] = _frame[phase];
+    }
+  }
+
+  void didHitch()
+  {
+    _frameMetrics.hitchCount++;
+  }
+
+  void didThrottle()
+  {
+    _frameMetrics.throttledStepCount++;
+  }
+
+  void didDefer()
+  {
+    _frameMetrics.deferredStepCount++;
+  }
+
+  void didExceedBudget()
+  {
+    _frameMetrics.overBudgetFrameCount++;
+  }
+
+  void didCull()
+  {
+    _frameMetrics.culledStepCount++;
+  }
+
+  void didStepSolver(uint64_t count)
+  {
+    _frameMetrics.solverStepCount += count;
+  }
+
+  void addPhaseDuration(POPAnimatorPhase phase, CFTimeInterval duration)
+  {
+    _frame[phase] += duration;
+  }
+
+  void didWrite(bool skipped)
+  {
+    if (skipped) {
+      _frameMetrics.skippedWriteCount++;
+    } else {
+      _frameMetrics.writeCount++;
+    }
+  }
+
+  // call while holding the animator lock
+  void copyMetrics(POPAnimatorMetrics *outMetrics) const
+  {
+    *outMetrics = _metrics;
+  }
+
+  // call while holding the animator lock
+  void copyHistogram(POPAnimatorPhase phase, NSUInteger outBuckets[kPOPAnimatorHistogramBucketCount]) const
+  {
+    memset(outBuckets, 0, sizeof(NSUInteger) * kPOPAnimatorHistogramBucketCount);
+
+    NSUInteger count = MIN(_sampleCount, (NSUInteger)kPOPAnimatorHistogramFrameCount);
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      outBuckets[bucket(_samples[idx][phase])]++;
+    }
+  }
+
+  static NSUInteger bucket(CFTimeInterval duration)
+  {
+    if (duration < kPOPAnimatorHistogramResolution) {
+      return 0;
+    }
+    NSUInteger idx = (NSUInteger)floor(log2(duration / kPOPAnimatorHistogramResolution)) + 1;
+    return MIN(idx, (NSUInteger)kPOPAnimatorHistogramBucketCount - 1);
+  }
+
+  static CFTimeInterval bucketUpperBound(NSUInteger idx)
+  {
+    if (idx >= kPOPAnimatorHistogramBucketCount - 1) {
+      return INFINITY;
+    }
+    return ldexp(kPOPAnimatorHistogramResolution, (int)idx);
+  }
+};
+
+/**
+ Scoped phase timer; no-op without metrics.
+ */
+struct POPAnimatorPhaseTimer
+{
+  POPAnimatorMetricsRecorder *metrics;
+  POPAnimatorPhase phase;
+  CFTimeInterval beginTime;
+
+  POPAnimatorPhaseTimer(POPAnimatorMetricsRecorder *m, POPAnimatorPhase p) :
+  metrics(m),
+  phase(p),
+  beginTime(NULL != m ? CACurrentMediaTime() : 0) {}
+
+  ~POPAnimatorPhaseTimer()
+  {
+    if (NULL != metrics) {
+      metrics->addPhaseDuration(phase, CACurrentMediaTime() - beginTime);
+    }
+  }
+};
@@ -9,6 +9,14 @@
 
 #import <pop/POPAnimator.h>
 
+#ifdef __cplusplus
+#import <memory>
+
+namespace POP {
+  class FrameClock;
+}
+#endif
+
 @class POPAnimation;
 
 @protocol POPAnimatorObserving <NSObject>
@@ -52,6 +60,19 @@
  */
 - (void)renderTime:(CFTimeInterval)time;
 
+#ifdef __cplusplus
+/**
+ Frame clock driving the animator in lieu of its display link, eg a manual clock stepping tests at unlimited speed, a timer rendering offline at any rate, or a display link clock. Frames render at their target timestamps, or at their timestamps unless targeting presentation time, in the timebase of the clock; animator time carries over when the clock changes. Frames delivered off the main thread render on the main queue, unless the background thread is enabled on OS X. Defaults to none, using the display link. Set on the main thread.
+ */
+- (std::shared_ptr<POP::FrameClock>)frameClock;
+- (void)setFrameClock:(std::shared_ptr<POP::FrameClock>)frameClock;
+#endif
+
+/**
+ Number of animations waiting on a future begin time. Exposed for unit testing.
+ */
+@property (readonly, nonatomic) NSUInteger deferredAnimationCount;
+
 /**
  Funnel methods for category additions.
  */
@@ -0,0 +1,59 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <CoreGraphics/CoreGraphics.h>
+
+#import <Foundation/Foundation.h>
+
+/**
+ @abstract Replays a captured animator session headlessly.
+ @discussion Feeds captured operations to a private animator at full speed, with captured render timestamps and synthetic targets in place of the original objects. Reports the cost of each frame and the divergence of replayed values from those captured.
+
+ Replay drives a POPAnimator rather than POP::HeadlessAnimator, so it requires Foundation and QuartzCore, and frame durations include Objective-C dispatch, value boxing and property block calls alongside solver costs. Compare them only with other replays, not with headless benchmarks. HeadlessAnimator does not yet support what captures record beyond spring, decay and basic configurations: to value changes, animator speed, hitch policies, pending renders, additive, autoreversing and repeating animations, and rounding.
+ */
+@interface POPAnimatorReplayer : NSObject
+
+/**
+ @abstract Designated initializer.
+ @param data The data returned from a POPAnimatorCapture.
+ */
+- (instancetype)initWithData:(NSData *)data;
+
+/**
+ @abstract Divergence above which a frame is considered divergent. Defaults to 1e-6.
+ */
+@property (assign, nonatomic) CGFloat divergenceTolerance;
+
+/**
+ @abstract Replays the session, updating results.
+ @returns NO if data is invalid.
+ */
+- (BOOL)replay;
+
+/**
+ @abstract The number of frames replayed.
+ */
+@property (readonly, nonatomic) NSUInteger frameCount;
+
+/**
+ @abstract Seconds taken rendering each frame replayed, as NSNumber instances.
+ */
+@property (readonly, copy, nonatomic) NSArray *frameDurations;
+
+/**
+ @abstract The largest absolute difference between a replayed and captured value. Infinite if a captured animation did not run on replay.
+ */
+@property (readonly, nonatomic) CGFloat maximumDivergence;
+
+/**
+ @abstract The number of frames with divergence above tolerance.
+ */
+@property (readonly, nonatomic) NSUInteger divergentFrameCount;
+
+@end
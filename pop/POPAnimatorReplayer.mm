@@ -0,0 +1,315 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "POPAnimatorReplayer.h"
+
+#import <unordered_map>
+
+#import <QuartzCore/QuartzCore.h>
+
+#import "POPAnimatableProperty.h"
+#import "POPAnimatorCaptureInternal.h"
+#import "POPAnimatorPrivate.h"
+#import "POPBasicAnimationInternal.h"
+#import "POPDecayAnimationInternal.h"
+#import "POPSpringAnimationInternal.h"
+
+@interface POPAnimator (Replay)
+- (void)_processPendingList;
+@end
+
+/**
+ Stands in for a captured object, storing values by property name.
+ */
+@interface POPAnimatorReplayTarget : NSObject
+- (void)getValues:(CGFloat *)values forProperty:(NSString *)name;
+- (void)setValues:(const CGFloat *)values count:(NSUInteger)count forProperty:(NSString *)name;
+@end
+
+@implementation POPAnimatorReplayTarget
+{
+  NSMutableDictionary *_values;
+}
+
+- (instancetype)init
+{
+  self = [super init];
+  if (nil != self) {
+    _values = [NSMutableDictionary dictionary];
+  }
+  return self;
+}
+
+- (void)getValues:(CGFloat *)values forProperty:(NSString *)name
+{
+  NSData *data = _values[name];
+  [data getBytes:values length:data.length];
+}
+
+- (void)setValues:(const CGFloat *)values count:(NSUInteger)count forProperty:(NSString *)name
+{
+  NSMutableData *data = _values[name];
+  if (nil == data) {
+    data = [NSMutableData dataWithLength:count * sizeof(CGFloat)];
+    _values[name] = data;
+  }
+  memcpy(data.mutableBytes, values, MIN(count * sizeof(CGFloat), data.length));
+}
+
+@end
+
+// property of the same name backed by replay target storage
+static POPAnimatableProperty *replay_property(NSString *name, CGFloat threshold, NSUInteger count)
+{
+  return [POPAnimatableProperty propertyWithName:[@"com.facebook.pop.replay." stringByAppendingString:name] initializer:^(POPMutableAnimatableProperty *prop) {
+    prop.readBlock = ^(id obj, CGFloat values[]) {
+      [(POPAnimatorReplayTarget *)obj getValues:values forProperty:name];
+    };
+    prop.writeBlock = ^(id obj, const CGFloat values[]) {
+      [(POPAnimatorReplayTarget *)obj setValues:values count:count forProperty:name];
+    };
+    prop.threshold = threshold;
+  }];
+}
+
+static id box(const VectorRef &vec, POPValueType valueType)
+{
+  return vec ? POPBox(vec, valueType, true) : nil;
+}
+
+/**
+ Replayed animation and its target.
+ */
+struct POPAnimatorReplayEntry
+{
+  POPPropertyAnimation *animation;
+  POPAnimatorReplayTarget *target;
+  NSString *propertyName;
+  POPValueType valueType;
+};
+
+@implementation POPAnimatorReplayer
+{
+  NSData *_data;
+}
+
+- (instancetype)init
+{
+  return [self initWithData:nil];
+}
+
+- (instancetype)initWithData:(NSData *)data
+{
+  self = [super init];
+  if (nil != self) {
+    _data = [data copy];
+    _divergenceTolerance = 1e-6;
+  }
+  return self;
+}
+
+- (BOOL)replay
+{
+  _frameCount = 0;
+  _frameDurations = nil;
+  _maximumDivergence = 0;
+  _divergentFrameCount = 0;
+
+  POPCaptureHeader header;
+  if (_data.length < sizeof(header)) {
+    return NO;
+  }
+  [_data getBytes:&header length:sizeof(header)];
+  if (kPOPCaptureMagic != header.magic || kPOPCaptureVersion != header.version) {
+    return NO;
+  }
+
+  POPAnimator *animator = [[POPAnimator alloc] init];
+  animator.disableDisplayLink = YES;
+
+  NSMutableDictionary *targets = [NSMutableDictionary dictionary];
+  std::unordered_map<uint32_t, POPAnimatorReplayEntry> entries;
+  NSMutableArray *frameDurations = [NSMutableArray array];
+
+  POPCaptureReader r(_data);
+  r.p += sizeof(header);
+
+  while (r.ok && !r.atEnd()) {
+    switch (r.read<uint8_t>()) {
+      case kPOPCaptureOpAdd: {
+        const uint32_t index = r.read<uint32_t>();
+        NSNumber *objectIndex = @(r.read<uint32_t>());
+        NSString *key = r.readString();
+        const POPAnimationType type = (POPAnimationType)r.read<uint8_t>();
+        NSString *propertyName = r.readString();
+        const CGFloat threshold = r.read<double>();
+        const POPValueType valueType = (POPValueType)r.read<uint8_t>();
+        const NSUInteger valueCount = r.read<uint8_t>();
+        const uint8_t flags = r.read<uint8_t>();
+        const CFTimeInterval beginTime = r.read<double>();
+        const int32_t repeatCount = r.read<int32_t>();
+        const CGFloat roundingFactor = r.read<double>();
+        const uint8_t clampMode = r.read<uint8_t>();
+        const uint16_t preferredFramesPerSecond = r.read<uint16_t>();
+        const int8_t priority = r.read<int8_t>();
+        VectorRef fromVec = r.readVector();
+        VectorRef toVec = r.readVector();
+
+        POPPropertyAnimation *anim;
+        if (kPOPAnimationSpring == type) {
+          POPSpringAnimation *spring = [POPSpringAnimation animation];
+          spring.velocity = box(r.readVector(), valueType);
+          const bool userSpecifiedDynamics = r.read<uint8_t>();
+          const CGFloat springSpeed = r.read<double>();
+          const CGFloat springBounciness = r.read<double>();
+          const CGFloat tension = r.read<double>();
+          const CGFloat friction = r.read<double>();
+          const CGFloat mass = r.read<double>();
+          if (userSpecifiedDynamics) {
+            spring.dynamicsTension = tension;
+            spring.dynamicsFriction = friction;
+            spring.dynamicsMass = mass;
+          } else {
+            spring.springSpeed = springSpeed;
+            spring.springBounciness = springBounciness;
+          }
+          anim = spring;
+        } else if (kPOPAnimationBasic == type) {
+          POPBasicAnimation *basic = [POPBasicAnimation animation];
+          basic.duration = r.read<double>();
+          const bool hasTimingFunction = r.read<uint8_t>();
+          float points[4];
+          for (NSUInteger idx = 0; idx < 4; idx++) {
+            points[idx] = r.read<double>();
+          }
+          if (hasTimingFunction) {
+            basic.timingFunction = [CAMediaTimingFunction functionWithControlPoints:points[0] :points[1] :points[2] :points[3]];
+          }
+          anim = basic;
+        } else if (kPOPAnimationDecay == type) {
+          POPDecayAnimation *decay = [POPDecayAnimation animation];
+          VectorRef velocityVec = r.readVector();
+          decay.deceleration = r.read<double>();
+          decay.velocity = box(velocityVec, valueType);
+          anim = decay;
+        } else {
+          r.ok = false;
+          break;
+        }
+
+        anim.property = replay_property(propertyName, threshold, valueCount);
+        anim.fromValue = box(fromVec, valueType);
+        if (kPOPAnimationDecay != type) {
+          anim.toValue = box(toVec, valueType);
+        }
+        anim.roundingFactor = roundingFactor;
+        anim.clampMode = clampMode;
+        anim.additive = 0 != (flags & kPOPCaptureFlagAdditive);
+        anim.autoreverses = 0 != (flags & kPOPCaptureFlagAutoreverses);
+        anim.repeatForever = 0 != (flags & kPOPCaptureFlagRepeatForever);
+        anim.removedOnCompletion = 0 != (flags & kPOPCaptureFlagRemovedOnCompletion);
+        anim.convergesWithinPixel = 0 != (flags & kPOPCaptureFlagConvergesWithinPixel);
+        anim.repeatCount = repeatCount;
+        anim.beginTime = beginTime;
+        anim.preferredFramesPerSecond = preferredFramesPerSecond;
+        anim.priority = (POPAnimationPriority)priority;
+
+        POPAnimatorReplayTarget *target = targets[objectIndex];
+        if (nil == target) {
+          target = [[POPAnimatorReplayTarget alloc] init];
+          targets[objectIndex] = target;
+        }
+        entries[index] = {anim, target, propertyName, valueType};
+        [animator addAnimation:anim forObject:target key:key];
+        break;
+      }
+      case kPOPCaptureOpRemove: {
+        POPAnimatorReplayTarget *target = targets[@(r.read<uint32_t>())];
+        NSString *key = r.readString();
+        if (0 == key.length) {
+          [animator removeAllAnimationsForObject:target];
+        } else {
+          [animator removeAnimationForObject:target key:key];
+        }
+        break;
+      }
+      case kPOPCaptureOpObjectValue: {
+        auto iter = entries.find(r.read<uint32_t>());
+        VectorRef vec = r.readVector();
+        if (iter != entries.end() && vec) {
+          [iter->second.target setValues:vec->data() count:vec->size() forProperty:iter->second.propertyName];
+        }
+        break;
+      }
+      case kPOPCaptureOpSetToValue: {
+        auto iter = entries.find(r.read<uint32_t>());
+        VectorRef vec = r.readVector();
+        if (iter != entries.end()) {
+          iter->second.animation.toValue = box(vec, iter->second.valueType);
+        }
+        break;
+      }
+      case kPOPCaptureOpSpeed:
+        animator.speed = r.read<double>();
+        break;
+      case kPOPCaptureOpHitchPolicy:
+        animator.hitchPolicy = (POPHitchPolicy)r.read<uint8_t>();
+        animator.maximumFrameInterval = r.read<double>();
+        animator.hitchRecoveryFrameCount = r.read<uint32_t>();
+        break;
+      case kPOPCaptureOpRender: {
+        const CFTimeInterval time = r.read<double>();
+        const bool pending = r.read<uint8_t>();
+
+        const CFTimeInterval renderBeginTime = CACurrentMediaTime();
+        if (pending) {
+          animator.beginTime = time;
+          [animator _processPendingList];
+          animator.beginTime = 0;
+        } else {
+          [animator renderTime:time];
+        }
+        [frameDurations addObject:@(CACurrentMediaTime() - renderBeginTime)];
+        _frameCount++;
+        break;
+      }
+      case kPOPCaptureOpValues: {
+        const uint32_t count = r.read<uint32_t>();
+        CGFloat divergence = 0;
+        for (uint32_t idx = 0; idx < count && r.ok; idx++) {
+          auto iter = entries.find(r.read<uint32_t>());
+          VectorRef vec = r.readVector();
+          POPPropertyAnimationState *state = iter != entries.end() ? static_cast<POPPropertyAnimationState *>(POPAnimationGetState(iter->second.animation)) : NULL;
+
+          // captured animation failed to run
+          if (NULL == state || !state->currentVec || !vec || state->currentVec->size() != vec->size()) {
+            divergence = INFINITY;
+            continue;
+          }
+          for (NSUInteger i = 0; i < vec->size(); i++) {
+            divergence = MAX(divergence, std::abs(state->currentVec->data()[i] - vec->data()[i]));
+          }
+        }
+        _maximumDivergence = MAX(_maximumDivergence, divergence);
+        if (divergence > _divergenceTolerance) {
+          _divergentFrameCount++;
+        }
+        break;
+      }
+      default:
+        r.ok = false;
+        break;
+    }
+  }
+
+  _frameDurations = [frameDurations copy];
+  return r.ok;
+}
+
+@end
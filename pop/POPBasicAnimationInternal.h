@@ -14,9 +14,6 @@
 // default animation duration
 static CGFloat const kPOPAnimationDurationDefault = 0.4;
 
-// progress threshold for computing done
-static CGFloat const kPOPProgressThreshold = 1e-6;
-
 static void interpolate(POPValueType valueType, NSUInteger count, const CGFloat *fromVec, const CGFloat *toVec, CGFloat *outVec, CGFloat p)
 {
   switch (valueType) {
@@ -55,7 +52,7 @@ struct _POPBasicAnimationState : _POPPropertyAnimationState
     if (_POPPropertyAnimationState::isDone()) {
       return true;
     }
-    return timeProgress + kPOPProgressThreshold >= 1.;
+    return basic_done(timeProgress);
   }
 
   void updatedTimingFunction()
@@ -75,15 +72,7 @@ struct _POPBasicAnimationState : _POPPropertyAnimationState
     }
 
     // solve for normalized time, aka progress [0, 1]
-    CGFloat p = 1.0f;
-    if (duration > 0.0f) {
-        // cap local time to duration
-        CFTimeInterval t = MIN(time - startTime, duration) / duration;
-        p = POPTimingFunctionSolve(timingControlPoints, t, SOLVE_EPS(duration));
-        timeProgress = t;
-    } else {
-        timeProgress = 1.;
-    }
+    CGFloat p = basic_progress(timingControlPoints, duration, time - startTime, timeProgress);
 
     // interpolate and advance
     interpolate(valueType, valueCount, fromVec->data(), toVec->data(), currentVec->data(), p);
@@ -136,8 +136,9 @@ DEFINE_RW_PROPERTY(POPDecayAnimationState, deceleration, setDeceleration:, CGFlo
       __state->originalVelocityVec = origVec;
 
       if (__state->tracing) {
-        [__state->tracer updateVelocity:aValue];
+        [__state->cold->tracer updateVelocity:aValue];
       }
+      __state->traceValue(kPOPAnimationEventVelocityUpdate, vec);
 
       [self _invalidateComputedProperties];
 
@@ -13,32 +13,6 @@
 
 #import "POPPropertyAnimationInternal.h"
 
-// minimal velocity factor before decay animation is considered complete, in units / s
-static CGFloat kPOPAnimationDecayMinimalVelocityFactor = 5.;
-
-// default decay animation deceleration
-static CGFloat kPOPAnimationDecayDecelerationDefault = 0.998;
-
-static void decay_position(CGFloat *x, CGFloat *v, NSUInteger count, CFTimeInterval dt, CGFloat deceleration)
-{
-  dt *= 1000;
-
-  // v0 = v / 1000
-  // v = v0 * powf(deceleration, dt);
-  // v = v * 1000;
-
-  // x0 = x;
-  // x = x0 + v0 * deceleration * (1 - powf(deceleration, dt)) / (1 - deceleration)
-  float v0[count];
-  float kv = powf(deceleration, dt);
-  float kx = deceleration * (1 - kv) / (1 - deceleration);
-
-  for (NSUInteger idx = 0; idx < count; idx++) {
-    v0[idx] = v[idx] / 1000.;
-    v[idx] = v0[idx] * kv * 1000.;
-    x[idx] = x[idx] + v0[idx] * kx;
-  }
-}
 
 struct _POPDecayAnimationState : _POPPropertyAnimationState
 {
@@ -47,7 +21,7 @@ struct _POPDecayAnimationState : _POPPropertyAnimationState
 
   _POPDecayAnimationState(id __unsafe_unretained anim) :
   _POPPropertyAnimationState(anim),
-  deceleration(kPOPAnimationDecayDecelerationDefault),
+  deceleration(kDecayDecelerationDefault),
   duration(0)
   {
     type = kPOPAnimationDecay;
@@ -58,33 +32,19 @@ struct _POPDecayAnimationState : _POPPropertyAnimationState
       return true;
     }
 
-    CGFloat f = dynamicsThreshold * kPOPAnimationDecayMinimalVelocityFactor;
-    const CGFloat *velocityValues = vec_data(velocityVec);
-    for (NSUInteger idx = 0; idx < valueCount; idx++) {
-      if (std::abs((velocityValues[idx])) >= f)
-        return false;
+    if (decay_done(vec_data(velocityVec), valueCount, dynamicsThreshold)) {
+      return true;
     }
-    return true;
 
+    // remaining travel within the pixel tolerance
+    const CGFloat tolerance = pixelTolerance();
+    return 0 != tolerance && velocityVec && decay_travel_within(velocityVec->data(), valueCount, deceleration, tolerance);
   }
 
   void computeDuration() {
 
     // compute duration till threshold velocity
-    Vector4r scaledVelocity = vector4(velocityVec) / 1000.;
-
-    double k = dynamicsThreshold * kPOPAnimationDecayMinimalVelocityFactor / 1000.;
-    double vx = k / scaledVelocity.x;
-    double vy = k / scaledVelocity.y;
-    double vz = k / scaledVelocity.z;
-    double vw = k / scaledVelocity.w;
-    double d = log(deceleration) * 1000.;
-    duration = MAX(MAX(MAX(log(fabs(vx)) / d, log(fabs(vy)) / d), log(fabs(vz)) / d), log(fabs(vw)) / d);
-
-    // ensure velocity threshold is exceeded
-    if (std::isnan(duration) || duration < 0) {
-      duration = 0;
-    }
+    duration = decay_duration(vec_data(velocityVec), valueCount, dynamicsThreshold, deceleration);
   }
 
   void computeToValue() {
@@ -10,7 +10,9 @@
 #ifndef POP_POPDefines_h
 #define POP_POPDefines_h
 
+#if defined(__APPLE__)
 #import <Availability.h>
+#endif
 
 #ifdef __cplusplus
 # define POP_EXTERN_C_BEGIN extern "C" {
@@ -29,6 +31,13 @@
 # define POP_NOTHROW
 #endif
 
+// conversions between spring constants of animations and of Quartz Composer springs
+#define POP_ANIMATION_FRICTION_FOR_QC_FRICTION(qcFriction) (25.0 + (((qcFriction - 8.0) / 2.0) * (25.0 - 19.0)))
+#define POP_ANIMATION_TENSION_FOR_QC_TENSION(qcTension) (194.0 + (((qcTension - 30.0) / 50.0) * (375.0 - 194.0)))
+
+#define QC_FRICTION_FOR_POP_ANIMATION_FRICTION(fbFriction) (8.0 + 2.0 * ((fbFriction - 25.0)/(25.0 - 19.0)))
+#define QC_TENSION_FOR_POP_ANIMATION_TENSION(fbTension) (30.0 + 50.0 * ((fbTension - 194.0)/(375.0 - 194.0)))
+
 //如果要使用SceneKit 添加POP_USE_SCENEKIT=1到预编译宏中
 #if defined(POP_USE_SCENEKIT)
 # if TARGET_OS_MAC || TARGET_OS_IPHONE
@@ -0,0 +1,82 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+#if !TARGET_OS_IPHONE
+#import <CoreVideo/CoreVideo.h>
+#endif
+
+#import "POPFrameClock.h"
+
+#if TARGET_OS_IPHONE
+@class CADisplayLink;
+#endif
+
+namespace POP {
+
+#if TARGET_OS_IPHONE
+  /**
+   Returns the frame of a display link callback. Before iOS 10, the target timestamp is one refresh past the timestamp.
+   */
+  FrameTime display_link_frame_time(CADisplayLink *displayLink);
+
+  /**
+   Slows a display link down to a rate of at least framesPerSecond, or restores the display rate for zero. Before iOS 10, rates are whole divisors of 60 Hz.
+   */
+  void display_link_set_preferred_frames_per_second(CADisplayLink *displayLink, NSInteger framesPerSecond);
+#else
+  /**
+   Returns the frame of a display link callback, in media time.
+   */
+  FrameTime display_link_frame_time(const CVTimeStamp *now, const CVTimeStamp *outputTime);
+#endif
+
+  /**
+   Frames at display refresh. Uses a CADisplayLink on the main run loop on iOS and tvOS, delivering frames on the main thread; uses a CVDisplayLink on OS X, delivering frames on its thread. Target timestamps are the times frames are expected on screen. Create and destroy on the main thread.
+   */
+  class DisplayLinkFrameClock : public FrameClock
+  {
+  public:
+    DisplayLinkFrameClock();
+#if !TARGET_OS_IPHONE
+    explicit DisplayLinkFrameClock(CGDirectDisplayID displayID);
+#endif
+    ~DisplayLinkFrameClock();
+
+    /**
+     False if the display link could not be created, in which case no frames are delivered.
+     */
+    bool isValid() const;
+
+    CFTimeInterval now() const;
+    CFTimeInterval framePeriod() const;
+    void setRunning(bool running);
+    bool isRunning() const;
+#if TARGET_OS_IPHONE
+    void setPreferredFramesPerSecond(NSInteger framesPerSecond);
+#endif
+
+    /**
+     Called by the display link on each refresh.
+     */
+    void displayLinkDidFire(const FrameTime &frame)
+    {
+      deliver(frame);
+    }
+
+  private:
+#if TARGET_OS_IPHONE
+    void *_displayLink; // retained CADisplayLink
+#else
+    CVDisplayLinkRef _displayLink;
+#endif
+  };
+
+}
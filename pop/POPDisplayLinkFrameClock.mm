@@ -0,0 +1,198 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "POPDisplayLinkFrameClock.h"
+
+#import <QuartzCore/QuartzCore.h>
+
+using namespace POP;
+
+#if TARGET_OS_IPHONE
+
+/**
+ Display link target forwarding to a clock, which invalidates the display link before destruction.
+ */
+@interface POPDisplayLinkFrameClockTarget : NSObject
+{
+@public
+  DisplayLinkFrameClock *_clock;
+}
+- (void)render:(CADisplayLink *)displayLink;
+@end
+
+@implementation POPDisplayLinkFrameClockTarget
+
+- (void)render:(CADisplayLink *)displayLink
+{
+  _clock->displayLinkDidFire(display_link_frame_time(displayLink));
+}
+
+@end
+
+FrameTime POP::display_link_frame_time(CADisplayLink *displayLink)
+{
+  FrameTime frame;
+  frame.timestamp = displayLink.timestamp;
+  if ([displayLink respondsToSelector:@selector(targetTimestamp)]) {
+    frame.targetTimestamp = displayLink.targetTimestamp;
+  } else {
+    frame.targetTimestamp = displayLink.timestamp + displayLink.duration;
+  }
+  return frame;
+}
+
+void POP::display_link_set_preferred_frames_per_second(CADisplayLink *displayLink, NSInteger framesPerSecond)
+{
+  if ([displayLink respondsToSelector:@selector(setPreferredFramesPerSecond:)]) {
+    displayLink.preferredFramesPerSecond = framesPerSecond;
+  } else {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    displayLink.frameInterval = 0 != framesPerSecond ? MAX(60 / framesPerSecond, (NSInteger)1) : 1;
+#pragma clang diagnostic pop
+  }
+}
+
+#define __displayLink ((__bridge CADisplayLink *)_displayLink)
+
+DisplayLinkFrameClock::DisplayLinkFrameClock()
+{
+  POPDisplayLinkFrameClockTarget *target = [[POPDisplayLinkFrameClockTarget alloc] init];
+  target->_clock = this;
+  CADisplayLink *displayLink = [CADisplayLink displayLinkWithTarget:target selector:@selector(render:)];
+  displayLink.paused = YES;
+  [displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+  _displayLink = (void *)CFBridgingRetain(displayLink);
+}
+
+DisplayLinkFrameClock::~DisplayLinkFrameClock()
+{
+  [__displayLink invalidate];
+  CFRelease(_displayLink);
+}
+
+bool DisplayLinkFrameClock::isValid() const
+{
+  return NULL != _displayLink;
+}
+
+CFTimeInterval DisplayLinkFrameClock::framePeriod() const
+{
+  return __displayLink.duration;
+}
+
+void DisplayLinkFrameClock::setRunning(bool running)
+{
+  __displayLink.paused = !running;
+}
+
+bool DisplayLinkFrameClock::isRunning() const
+{
+  return !__displayLink.paused;
+}
+
+void DisplayLinkFrameClock::setPreferredFramesPerSecond(NSInteger framesPerSecond)
+{
+  FrameClock::setPreferredFramesPerSecond(framesPerSecond);
+  display_link_set_preferred_frames_per_second(__displayLink, framesPerSecond);
+}
+
+#else
+
+// host time in seconds, the timebase of CACurrentMediaTime
+static CFTimeInterval hostTimeSeconds(uint64_t hostTime)
+{
+  return (CFTimeInterval)hostTime / CVGetHostClockFrequency();
+}
+
+FrameTime POP::display_link_frame_time(const CVTimeStamp *now, const CVTimeStamp *outputTime)
+{
+  FrameTime frame;
+  frame.timestamp = hostTimeSeconds(now->hostTime);
+  frame.targetTimestamp = (outputTime->flags & kCVTimeStampHostTimeValid) ? hostTimeSeconds(outputTime->hostTime) : frame.timestamp;
+  return frame;
+}
+
+static CVReturn displayLinkCallback(CVDisplayLinkRef displayLink, const CVTimeStamp *now, const CVTimeStamp *outputTime, CVOptionFlags flagsIn, CVOptionFlags *flagsOut, void *context)
+{
+  ((DisplayLinkFrameClock *)context)->displayLinkDidFire(display_link_frame_time(now, outputTime));
+  return kCVReturnSuccess;
+}
+
+DisplayLinkFrameClock::DisplayLinkFrameClock() : _displayLink(NULL)
+{
+  CVReturn ret = CVDisplayLinkCreateWithActiveCGDisplays(&_displayLink);
+  if (kCVReturnSuccess != ret) {
+    ret = CVDisplayLinkCreateWithCGDisplay(CGMainDisplayID(), &_displayLink);
+  }
+  if (kCVReturnSuccess == ret) {
+    CVDisplayLinkSetOutputCallback(_displayLink, displayLinkCallback, this);
+  } else {
+    _displayLink = NULL;
+  }
+}
+
+DisplayLinkFrameClock::DisplayLinkFrameClock(CGDirectDisplayID displayID) : _displayLink(NULL)
+{
+  if (kCVReturnSuccess == CVDisplayLinkCreateWithCGDisplay(displayID, &_displayLink)) {
+    CVDisplayLinkSetOutputCallback(_displayLink, displayLinkCallback, this);
+  } else {
+    _displayLink = NULL;
+  }
+}
+
+DisplayLinkFrameClock::~DisplayLinkFrameClock()
+{
+  if (NULL != _displayLink) {
+    // stopping waits for a running callback to return
+    CVDisplayLinkStop(_displayLink);
+    CVDisplayLinkRelease(_displayLink);
+  }
+}
+
+bool DisplayLinkFrameClock::isValid() const
+{
+  return NULL != _displayLink;
+}
+
+CFTimeInterval DisplayLinkFrameClock::framePeriod() const
+{
+  if (NULL == _displayLink) {
+    return 0;
+  }
+  CVTime period = CVDisplayLinkGetNominalOutputVideoRefreshPeriod(_displayLink);
+  if (period.flags & kCVTimeIsIndefinite) {
+    return 0;
+  }
+  return ((CFTimeInterval)period.timeValue / (CFTimeInterval)period.timeScale);
+}
+
+void DisplayLinkFrameClock::setRunning(bool running)
+{
+  if (NULL == _displayLink || running == (bool)CVDisplayLinkIsRunning(_displayLink)) {
+    return;
+  }
+  if (running) {
+    CVDisplayLinkStart(_displayLink);
+  } else {
+    CVDisplayLinkStop(_displayLink);
+  }
+}
+
+bool DisplayLinkFrameClock::isRunning() const
+{
+  return NULL != _displayLink && CVDisplayLinkIsRunning(_displayLink);
+}
+
+#endif
+
+CFTimeInterval DisplayLinkFrameClock::now() const
+{
+  return CACurrentMediaTime();
+}
@@ -0,0 +1,287 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "POPFrameClock.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__APPLE__)
+#include <mach/mach_time.h>
+#endif
+
+namespace POP {
+
+  CFTimeInterval frame_clock_media_time()
+  {
+#if defined(__APPLE__)
+    // the timebase of CACurrentMediaTime
+    static const CFTimeInterval scale = [] {
+      mach_timebase_info_data_t timebase;
+      mach_timebase_info(&timebase);
+      return (CFTimeInterval)timebase.numer / timebase.denom * 1e-9;
+    }();
+    return (CFTimeInterval)mach_absolute_time() * scale;
+#else
+    using namespace std::chrono;
+    return duration_cast<duration<CFTimeInterval>>(steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+
+  void FrameClock::deliver(const FrameTime &frame)
+  {
+    // call outside the lock, so callbacks may replace themselves
+    FrameCallback callback;
+    {
+      std::lock_guard<std::mutex> guard(_callbackMutex);
+      callback = _callback;
+    }
+    if (callback) {
+      callback(frame);
+    }
+  }
+
+  TimerFrameClock::TimerFrameClock(double frequency) :
+  _period(1. / frequency),
+  _nextTime(0),
+  _periodsPerFrame(1),
+  _running(false),
+  _exiting(false)
+  {
+    NSCParameterAssert(frequency > 0);
+  }
+
+  TimerFrameClock::~TimerFrameClock()
+  {
+    {
+      std::lock_guard<std::mutex> guard(_mutex);
+      _exiting = true;
+      _running = false;
+    }
+    _condition.notify_all();
+
+    if (_thread.joinable()) {
+      NSCAssert(std::this_thread::get_id() != _thread.get_id(), @"destroying timer frame clock from its frame callback");
+      _thread.join();
+    }
+  }
+
+  CFTimeInterval TimerFrameClock::now() const
+  {
+    return frame_clock_media_time();
+  }
+
+  CFTimeInterval TimerFrameClock::framePeriod() const
+  {
+    return _period;
+  }
+
+  void TimerFrameClock::setRunning(bool running)
+  {
+    {
+      std::lock_guard<std::mutex> guard(_mutex);
+      if (running == _running) {
+        return;
+      }
+      _running = running;
+      if (running) {
+        // first frame right away, as a resumed display timer
+        _nextTime = frame_clock_media_time();
+        if (!_thread.joinable()) {
+          // lazily started, then parked while stopped
+          _thread = std::thread(&TimerFrameClock::run, this);
+        }
+      }
+    }
+    _condition.notify_all();
+  }
+
+  bool TimerFrameClock::isRunning() const
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _running;
+  }
+
+  void TimerFrameClock::setPreferredFramesPerSecond(NSInteger framesPerSecond)
+  {
+    FrameClock::setPreferredFramesPerSecond(framesPerSecond);
+
+    // whole periods per frame, rounding the rate up
+    std::lock_guard<std::mutex> guard(_mutex);
+    _periodsPerFrame = framesPerSecond > 0 ? MAX((NSUInteger)floor(1. / (_period * framesPerSecond) + 1e-6), (NSUInteger)1) : 1;
+  }
+
+  void TimerFrameClock::run()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_exiting) {
+      if (!_running) {
+        _condition.wait(lock);
+        continue;
+      }
+
+      const CFTimeInterval time = frame_clock_media_time();
+      if (time < _nextTime) {
+        _condition.wait_for(lock, std::chrono::duration<CFTimeInterval>(_nextTime - time));
+        continue;
+      }
+
+      // skip deadlines missed entirely, keeping frames on the period grid
+      const CFTimeInterval timestamp = _nextTime + floor((time - _nextTime) / _period) * _period;
+      _nextTime = timestamp + _period * _periodsPerFrame;
+
+      lock.unlock();
+      const FrameTime frame = {timestamp, timestamp + _period};
+      deliver(frame);
+      lock.lock();
+    }
+  }
+
+  ManualFrameClock::ManualFrameClock(double frequency, CFTimeInterval time) :
+  _period(1. / frequency),
+  _time(time),
+  _running(false)
+  {
+    NSCParameterAssert(frequency > 0);
+  }
+
+  CFTimeInterval ManualFrameClock::now() const
+  {
+    return _time;
+  }
+
+  CFTimeInterval ManualFrameClock::framePeriod() const
+  {
+    return _period;
+  }
+
+  void ManualFrameClock::setRunning(bool running)
+  {
+    _running = running;
+  }
+
+  bool ManualFrameClock::isRunning() const
+  {
+    return _running;
+  }
+
+  bool ManualFrameClock::step()
+  {
+    _time += _period;
+    if (!_running) {
+      return false;
+    }
+    const FrameTime frame = {_time, _time + _period};
+    deliver(frame);
+    return true;
+  }
+
+  NSUInteger ManualFrameClock::step(NSUInteger count)
+  {
+    NSUInteger delivered = 0;
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      if (step()) {
+        delivered++;
+      }
+    }
+    return delivered;
+  }
+
+  void ManualFrameClock::advance(CFTimeInterval dt)
+  {
+    NSCParameterAssert(dt >= 0);
+    _time += dt;
+  }
+
+  FileFrameClock::FileFrameClock() : _index(0), _running(false)
+  {
+  }
+
+  FileFrameClock::FileFrameClock(const std::vector<FrameTime> &frames) : _frames(frames), _index(0), _running(false)
+  {
+  }
+
+  bool FileFrameClock::load(const char *path)
+  {
+    FILE *f = fopen(path, "r");
+    if (NULL == f) {
+      return false;
+    }
+
+    std::vector<FrameTime> frames;
+    char line[256];
+    bool valid = true;
+    while (valid && NULL != fgets(line, sizeof(line), f)) {
+      const char *p = line;
+      while (' ' == *p || '\t' == *p) {
+        p++;
+      }
+      if ('#' == *p || '\n' == *p || '\r' == *p || '\0' == *p) {
+        continue;
+      }
+
+      char *end;
+      FrameTime frame;
+      frame.timestamp = strtod(p, &end);
+      valid = end != p;
+      p = end;
+      frame.targetTimestamp = strtod(p, &end);
+      if (end == p) {
+        frame.targetTimestamp = frame.timestamp;
+      }
+      frames.push_back(frame);
+    }
+    fclose(f);
+
+    if (!valid) {
+      return false;
+    }
+    _frames.swap(frames);
+    _index = 0;
+    return true;
+  }
+
+  CFTimeInterval FileFrameClock::now() const
+  {
+    if (_frames.empty()) {
+      return 0;
+    }
+    return _frames[0 != _index ? _index - 1 : 0].timestamp;
+  }
+
+  CFTimeInterval FileFrameClock::framePeriod() const
+  {
+    if (_frames.size() < 2) {
+      return 0;
+    }
+    return (_frames.back().timestamp - _frames.front().timestamp) / (_frames.size() - 1);
+  }
+
+  void FileFrameClock::setRunning(bool running)
+  {
+    _running = running;
+  }
+
+  bool FileFrameClock::isRunning() const
+  {
+    return _running;
+  }
+
+  bool FileFrameClock::step()
+  {
+    if (!_running || _index >= _frames.size()) {
+      return false;
+    }
+    deliver(_frames[_index++]);
+    return true;
+  }
+
+}
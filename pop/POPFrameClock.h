@@ -0,0 +1,218 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef POP_POPFrameClock_h
+#define POP_POPFrameClock_h
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "POPPlatform.h"
+
+namespace POP {
+
+  /**
+   Timing of a frame, in the timebase of its clock.
+   */
+  struct FrameTime
+  {
+    CFTimeInterval timestamp;       // time the frame began
+    CFTimeInterval targetTimestamp; // time the frame is expected to be presented, timestamp if unknown
+  };
+
+  /**
+   Returns the current media time, in the timebase of CACurrentMediaTime on Apple platforms and of a monotonic clock elsewhere.
+   */
+  CFTimeInterval frame_clock_media_time();
+
+  /**
+   Source of frames driving an animator. Frames are delivered to the frame callback on a thread of the clock's choosing, only while the clock runs.
+   */
+  class FrameClock
+  {
+  public:
+    typedef std::function<void(const FrameTime &frame)> FrameCallback;
+
+    FrameClock() : _preferredFramesPerSecond(0) {}
+    virtual ~FrameClock() {}
+
+    /**
+     Sets the function called on each frame. Safe to call while frames are delivered.
+     */
+    void setFrameCallback(const FrameCallback &callback)
+    {
+      std::lock_guard<std::mutex> guard(_callbackMutex);
+      _callback = callback;
+    }
+
+    /**
+     The current time in the timebase of frame timestamps.
+     */
+    virtual CFTimeInterval now() const = 0;
+
+    /**
+     The nominal interval between frames, zero if unknown.
+     */
+    virtual CFTimeInterval framePeriod() const = 0;
+
+    /**
+     Starts or stops delivering frames.
+     */
+    virtual void setRunning(bool running) = 0;
+    virtual bool isRunning() const = 0;
+
+    /**
+     Sets the lowest frame rate the driven animations need, zero for every frame. Clocks able to slow down deliver fewer frames, at no less than the rate; others only record it.
+     */
+    virtual void setPreferredFramesPerSecond(NSInteger framesPerSecond)
+    {
+      _preferredFramesPerSecond = framesPerSecond;
+    }
+
+    NSInteger preferredFramesPerSecond() const
+    {
+      return _preferredFramesPerSecond;
+    }
+
+  protected:
+    void deliver(const FrameTime &frame);
+
+  private:
+    FrameClock(const FrameClock &);
+    FrameClock &operator=(const FrameClock &);
+
+    std::mutex _callbackMutex;
+    FrameCallback _callback;
+    NSInteger _preferredFramesPerSecond;
+  };
+
+  /**
+   Frames at a fixed rate from a high resolution timer thread, in media time. Frames missed while the callback runs late are dropped, as by a display. Must not be destroyed from its own frame callback.
+   */
+  class TimerFrameClock : public FrameClock
+  {
+  public:
+    explicit TimerFrameClock(double frequency = 60);
+    ~TimerFrameClock();
+
+    CFTimeInterval now() const;
+    CFTimeInterval framePeriod() const;
+    void setRunning(bool running);
+    bool isRunning() const;
+    void setPreferredFramesPerSecond(NSInteger framesPerSecond);
+
+  private:
+    const CFTimeInterval _period;
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    std::thread _thread;
+    CFTimeInterval _nextTime;
+    NSUInteger _periodsPerFrame;
+    bool _running;
+    bool _exiting;
+
+    void run();
+  };
+
+  /**
+   Virtual time advanced by its owner, delivering frames on the calling thread as fast as they are stepped, eg for tests and offline rendering at any rate. Not thread safe.
+   */
+  class ManualFrameClock : public FrameClock
+  {
+  public:
+    explicit ManualFrameClock(double frequency = 60, CFTimeInterval time = 0);
+
+    CFTimeInterval now() const;
+    CFTimeInterval framePeriod() const;
+    void setRunning(bool running);
+    bool isRunning() const;
+
+    /**
+     Advances time by one frame period and delivers a frame at the new time if running. Returns whether a frame was delivered.
+     */
+    bool step();
+
+    /**
+     Steps count frames. Returns the number of frames delivered.
+     */
+    NSUInteger step(NSUInteger count);
+
+    /**
+     Advances time without delivering a frame, eg to simulate a stall.
+     */
+    void advance(CFTimeInterval dt);
+
+  private:
+    CFTimeInterval _period;
+    CFTimeInterval _time;
+    bool _running;
+  };
+
+  /**
+   Frames replayed from a list, eg timestamps recorded from a display link, delivered one per step on the calling thread regardless of wall time. Files hold a frame per line, a timestamp optionally followed by a target timestamp; empty lines and lines starting with # are skipped. Not thread safe.
+   */
+  class FileFrameClock : public FrameClock
+  {
+  public:
+    FileFrameClock();
+    explicit FileFrameClock(const std::vector<FrameTime> &frames);
+
+    /**
+     Replaces frames with those read from path and rewinds. Returns false if the file cannot be read or holds a malformed line, leaving frames unchanged.
+     */
+    bool load(const char *path);
+
+    NSUInteger frameCount() const
+    {
+      return _frames.size();
+    }
+
+    /**
+     Index of the next frame to deliver.
+     */
+    NSUInteger frameIndex() const
+    {
+      return _index;
+    }
+
+    void rewind()
+    {
+      _index = 0;
+    }
+
+    /**
+     The timestamp of the last frame delivered, or of the first frame before any.
+     */
+    CFTimeInterval now() const;
+
+    /**
+     The mean interval between frames.
+     */
+    CFTimeInterval framePeriod() const;
+
+    void setRunning(bool running);
+    bool isRunning() const;
+
+    /**
+     Delivers the next frame if running. Returns false once all frames are delivered.
+     */
+    bool step();
+
+  private:
+    std::vector<FrameTime> _frames;
+    NSUInteger _index;
+    bool _running;
+  };
+
+}
+
+#endif
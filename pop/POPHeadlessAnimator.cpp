@@ -0,0 +1,301 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "POPHeadlessAnimator.h"
+
+#include <cstring>
+
+namespace POP {
+
+  // threshold of point and scalar layer properties
+  static const CGFloat kHeadlessThresholdDefault = 0.01;
+
+  HeadlessAnimation::HeadlessAnimation() :
+  type(kHeadlessAnimationBasic),
+  count(0),
+  fromValue{0.},
+  hasFromValue(false),
+  toValue{0.},
+  velocity{0.},
+  threshold(kHeadlessThresholdDefault),
+  clampMode(0),
+  beginTime(0),
+  tension(0),
+  friction(0),
+  mass(1),
+  deceleration(kDecayDecelerationDefault),
+  duration(0),
+  timingControlPoints{0., 0., 1., 1.}
+  {
+  }
+
+  HeadlessAnimation HeadlessAnimation::spring(NSUInteger count, const CGFloat *toValue, double tension, double friction, double mass)
+  {
+    NSCParameterAssert(count <= 4);
+    HeadlessAnimation a;
+    a.type = kHeadlessAnimationSpring;
+    a.count = count;
+    memcpy(a.toValue, toValue, count * sizeof(CGFloat));
+    a.tension = tension;
+    a.friction = friction;
+    a.mass = mass;
+    return a;
+  }
+
+  HeadlessAnimation HeadlessAnimation::decay(NSUInteger count, const CGFloat *velocity, double deceleration)
+  {
+    NSCParameterAssert(count <= 4);
+    HeadlessAnimation a;
+    a.type = kHeadlessAnimationDecay;
+    a.count = count;
+    memcpy(a.velocity, velocity, count * sizeof(CGFloat));
+    a.deceleration = deceleration;
+    return a;
+  }
+
+  HeadlessAnimation HeadlessAnimation::basic(NSUInteger count, const CGFloat *toValue, CFTimeInterval duration, const double timingControlPoints[4])
+  {
+    NSCParameterAssert(count <= 4);
+    HeadlessAnimation a;
+    a.type = kHeadlessAnimationBasic;
+    a.count = count;
+    memcpy(a.toValue, toValue, count * sizeof(CGFloat));
+    a.duration = duration;
+    memcpy(a.timingControlPoints, timingControlPoints, sizeof(a.timingControlPoints));
+    return a;
+  }
+
+  void HeadlessAnimation::setFromValue(const CGFloat *values)
+  {
+    memcpy(fromValue, values, count * sizeof(CGFloat));
+    hasFromValue = true;
+  }
+
+  HeadlessAnimator::Entry::Entry(HeadlessAnimationID i, const HeadlessAnimation &a, const POPMemoryBinding &b) :
+  ID(i),
+  animation(a),
+  binding(b),
+  solver(a.tension, a.friction, a.mass),
+  currentValue{0.},
+  velocity{0.},
+  previousValue{0.},
+  previous2Value{0.},
+  writeCount(0),
+  startTime(0),
+  lastTime(0),
+  timeProgress(0),
+  started(false)
+  {
+    solver.setThreshold(a.threshold);
+    solver.setIntegrator(kSpringSolverIntegratorRK4Matrix);
+  }
+
+  void HeadlessAnimator::Entry::start(CFTimeInterval time)
+  {
+    const NSUInteger count = animation.count;
+
+    // use current target value as from value
+    if (!animation.hasFromValue) {
+      CGFloat values[4];
+      memory_read(binding, values);
+      animation.setFromValue(values);
+    }
+
+    memcpy(currentValue, animation.fromValue, count * sizeof(CGFloat));
+    if (kHeadlessAnimationBasic != animation.type) {
+      memcpy(velocity, animation.velocity, count * sizeof(CGFloat));
+    }
+
+    // compute decay to value, used to clamp the end of the animation
+    if (kHeadlessAnimationDecay == animation.type) {
+      CGFloat v[4];
+      memcpy(v, velocity, sizeof(v));
+      memcpy(animation.toValue, animation.fromValue, count * sizeof(CGFloat));
+      decay_position(animation.toValue, v, count, decay_duration(velocity, count, animation.threshold, animation.deceleration), animation.deceleration);
+    }
+
+    startTime = lastTime = time;
+    started = true;
+  }
+
+  void HeadlessAnimator::Entry::advance(CFTimeInterval time)
+  {
+    const NSUInteger count = animation.count;
+    const CFTimeInterval dt = time - lastTime;
+
+    switch (animation.type) {
+      case kHeadlessAnimationSpring:
+        spring_advance(solver, currentValue, velocity, animation.toValue, count, time - startTime, dt);
+        clamp_values(currentValue, animation.fromValue, animation.toValue, count, animation.clampMode);
+        break;
+      case kHeadlessAnimationDecay:
+        decay_position(currentValue, velocity, count, dt, animation.deceleration);
+        // clamp to compute end value; avoid possibility of decaying past
+        clamp_values(currentValue, animation.fromValue, animation.toValue, count, kClampEnd | animation.clampMode);
+        break;
+      case kHeadlessAnimationBasic: {
+        CGFloat p = basic_progress(animation.timingControlPoints, animation.duration, time - startTime, timeProgress);
+        POPInterpolateVector(count, currentValue, animation.fromValue, animation.toValue, p);
+        clamp_values(currentValue, animation.fromValue, animation.toValue, count, animation.clampMode);
+        break;
+      }
+    }
+
+    lastTime = time;
+  }
+
+  bool HeadlessAnimator::Entry::isDone()
+  {
+    const NSUInteger count = animation.count;
+
+    // consider an animation with no values done
+    if (0 == count) {
+      return true;
+    }
+
+    switch (animation.type) {
+      case kHeadlessAnimationSpring:
+        return solver.started() && (spring_converged(animation.toValue, writeCount > 0 ? previousValue : NULL, writeCount > 1 ? previous2Value : NULL, count, animation.threshold) || solver.hasConverged());
+      case kHeadlessAnimationDecay:
+        return decay_done(velocity, count, animation.threshold);
+      case kHeadlessAnimationBasic:
+        return basic_done(timeProgress);
+    }
+    return true;
+  }
+
+  void HeadlessAnimator::Entry::write(bool shouldAvoidExtraneousWrite)
+  {
+    const size_t size = animation.count * sizeof(CGFloat);
+    if (shouldAvoidExtraneousWrite) {
+      CGFloat values[4];
+      memory_read(binding, values);
+      if (0 == memcmp(values, currentValue, size)) {
+        return;
+      }
+    }
+
+    // update previous values; support animation convergence
+    memcpy(previous2Value, previousValue, size);
+    memcpy(previousValue, currentValue, size);
+    writeCount++;
+
+    memory_write(binding, currentValue);
+  }
+
+  HeadlessAnimator::HeadlessAnimator() : _nextID(1)
+  {
+  }
+
+  HeadlessAnimationID HeadlessAnimator::addAnimation(const HeadlessAnimation &animation, CGFloat *target)
+  {
+    NSCParameterAssert(NULL != target || 0 == animation.count);
+    return addAnimation(animation, POPMemoryBindingMake(target, 0, 0, animation.count, CGFLOAT_IS_DOUBLE ? kPOPScalarTypeDouble : kPOPScalarTypeFloat));
+  }
+
+  HeadlessAnimationID HeadlessAnimator::addAnimation(const HeadlessAnimation &animation, const POPMemoryBinding &binding)
+  {
+    NSCParameterAssert(animation.count <= 4);
+    NSCParameterAssert(binding.count == animation.count);
+    NSCParameterAssert(memory_binding_valid(binding) || 0 == animation.count);
+
+    const HeadlessAnimationID animationID = _nextID++;
+    _indices[animationID] = _entries.size();
+    _entries.push_back(Entry(animationID, animation, binding));
+    return animationID;
+  }
+
+  void HeadlessAnimator::eraseAtIndex(size_t idx)
+  {
+    _indices.erase(_entries[idx].ID);
+
+    // swap with last, keeping entries contiguous
+    if (idx + 1 != _entries.size()) {
+      _entries[idx] = _entries.back();
+      _indices[_entries[idx].ID] = idx;
+    }
+    _entries.pop_back();
+  }
+
+  bool HeadlessAnimator::removeAnimation(HeadlessAnimationID animationID)
+  {
+    auto iter = _indices.find(animationID);
+    if (iter == _indices.end()) {
+      return false;
+    }
+    eraseAtIndex(iter->second);
+    if (_completion) {
+      _completion(animationID, false);
+    }
+    return true;
+  }
+
+  void HeadlessAnimator::removeAllAnimations()
+  {
+    std::vector<Entry> entries;
+    entries.swap(_entries);
+    _indices.clear();
+
+    if (_completion) {
+      for (const Entry &entry : entries) {
+        _completion(entry.ID, false);
+      }
+    }
+  }
+
+  const CGFloat *HeadlessAnimator::currentValues(HeadlessAnimationID animationID) const
+  {
+    auto iter = _indices.find(animationID);
+    if (iter == _indices.end() || !_entries[iter->second].started) {
+      return NULL;
+    }
+    return _entries[iter->second].currentValue;
+  }
+
+  void HeadlessAnimator::renderTime(CFTimeInterval time)
+  {
+    std::vector<HeadlessAnimationID> finished;
+
+    for (size_t idx = 0; idx < _entries.size();) {
+      Entry &entry = _entries[idx];
+
+      if (!entry.started) {
+        if (time < entry.animation.beginTime) {
+          idx++;
+          continue;
+        }
+        entry.start(time);
+      }
+
+      entry.advance(time);
+      entry.write(false);
+
+      if (entry.isDone()) {
+        // set end value, updating only if needed
+        memcpy(entry.currentValue, entry.animation.toValue, entry.animation.count * sizeof(CGFloat));
+        clamp_values(entry.currentValue, entry.animation.fromValue, entry.animation.toValue, entry.animation.count, entry.animation.clampMode);
+        entry.write(true);
+
+        finished.push_back(entry.ID);
+        eraseAtIndex(idx);
+        continue;
+      }
+
+      idx++;
+    }
+
+    // notify after stepping, completions may add or remove animations
+    if (_completion) {
+      for (HeadlessAnimationID animationID : finished) {
+        _completion(animationID, true);
+      }
+    }
+  }
+
+}
@@ -0,0 +1,154 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef POP_POPHeadlessAnimator_h
+#define POP_POPHeadlessAnimator_h
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "POPAnimationKernels.h"
+
+namespace POP {
+
+  /**
+   Types of headless animations.
+   */
+  enum HeadlessAnimationType
+  {
+    kHeadlessAnimationSpring,
+    kHeadlessAnimationDecay,
+    kHeadlessAnimationBasic,
+  };
+
+  /**
+   Describes a headless animation of up to four values.
+   */
+  struct HeadlessAnimation
+  {
+    HeadlessAnimationType type;
+    NSUInteger count;
+    CGFloat fromValue[4];
+    bool hasFromValue;                 // target values are read on start otherwise
+    CGFloat toValue[4];                // spring and basic
+    CGFloat velocity[4];               // spring and decay, in units / s
+    CGFloat threshold;
+    NSUInteger clampMode;              // kClampStart, kClampEnd
+    CFTimeInterval beginTime;          // 0 starts on next render
+
+    double tension;                    // spring
+    double friction;                   // spring
+    double mass;                       // spring
+    double deceleration;               // decay
+    CFTimeInterval duration;           // basic
+    double timingControlPoints[4];     // basic
+
+    HeadlessAnimation();
+
+    static HeadlessAnimation spring(NSUInteger count, const CGFloat *toValue, double tension, double friction, double mass = 1);
+    static HeadlessAnimation decay(NSUInteger count, const CGFloat *velocity, double deceleration = kDecayDecelerationDefault);
+    static HeadlessAnimation basic(NSUInteger count, const CGFloat *toValue, CFTimeInterval duration, const double timingControlPoints[4]);
+
+    void setFromValue(const CGFloat *values);
+  };
+
+  typedef uint64_t HeadlessAnimationID;
+
+  /**
+   Animator without Foundation, display link or Objective-C targets. Animations advance with the same steps as their POPAnimation counterparts and write values directly to target memory, packed CGFloats or any memory binding. Advanced by explicit render times.
+   */
+  class HeadlessAnimator
+  {
+  public:
+    typedef std::function<void(HeadlessAnimationID animationID, bool finished)> CompletionFunction;
+
+    HeadlessAnimator();
+
+    /**
+     Adds an animation writing count values to target, which must outlive the animation. Returns the animation identifier.
+     */
+    HeadlessAnimationID addAnimation(const HeadlessAnimation &animation, CGFloat *target);
+
+    /**
+     Adds an animation writing to bound memory, which must outlive the animation. Binding and animation counts must match. Returns the animation identifier.
+     */
+    HeadlessAnimationID addAnimation(const HeadlessAnimation &animation, const POPMemoryBinding &binding);
+
+    /**
+     Removes an animation, without writing its to value. Returns false if not found.
+     */
+    bool removeAnimation(HeadlessAnimationID animationID);
+
+    void removeAllAnimations();
+
+    bool hasAnimation(HeadlessAnimationID animationID) const
+    {
+      return _indices.find(animationID) != _indices.end();
+    }
+
+    NSUInteger animationCount() const
+    {
+      return _entries.size();
+    }
+
+    /**
+     Current values of a running animation, NULL if not found or not started.
+     */
+    const CGFloat *currentValues(HeadlessAnimationID animationID) const;
+
+    /**
+     Called on completion and removal of animations.
+     */
+    void setCompletion(const CompletionFunction &completion)
+    {
+      _completion = completion;
+    }
+
+    /**
+     Starts due animations and advances running ones to time. Finished animations write their to value and are removed.
+     */
+    void renderTime(CFTimeInterval time);
+
+  private:
+    struct Entry
+    {
+      HeadlessAnimationID ID;
+      HeadlessAnimation animation;
+      POPMemoryBinding binding;
+      SpringSolver4d solver;
+      CGFloat currentValue[4];
+      CGFloat velocity[4];
+      CGFloat previousValue[4];
+      CGFloat previous2Value[4];
+      NSUInteger writeCount;
+      CFTimeInterval startTime;
+      CFTimeInterval lastTime;
+      CFTimeInterval timeProgress;
+      bool started;
+
+      Entry(HeadlessAnimationID i, const HeadlessAnimation &a, const POPMemoryBinding &b);
+
+      void start(CFTimeInterval time);
+      void advance(CFTimeInterval time);
+      bool isDone();
+      void write(bool shouldAvoidExtraneousWrite);
+    };
+
+    std::vector<Entry> _entries;
+    std::unordered_map<HeadlessAnimationID, size_t> _indices;
+    HeadlessAnimationID _nextID;
+    CompletionFunction _completion;
+
+    void eraseAtIndex(size_t idx);
+  };
+
+}
+
+#endif
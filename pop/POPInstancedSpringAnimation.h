@@ -0,0 +1,107 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <pop/POPAnimation.h>
+#import <pop/POPMemoryBinding.h>
+
+/**
+ @abstract A spring animation of many homogeneous instances, such as particles, confetti or grid cells.
+ @discussion Instances share dynamics constants and threshold, and each have their own from, to and velocity values of valueCount components. All instances advance with a single kernel per frame and write to memory described by memoryBinding, in place of a spring animation, solver and write block per instance. The animation is done once every instance has converged to its to value.
+ */
+@interface POPInstancedSpringAnimation : POPAnimation
+
+/**
+ @abstract The designated initializer.
+ @param valueCount The number of values of each instance, from 1 to 4.
+ @returns An instance of an instanced spring animation.
+ */
++ (instancetype)animationWithValueCount:(NSUInteger)valueCount;
+
+/**
+ @abstract The number of values of each instance.
+ */
+@property (readonly, nonatomic) NSUInteger valueCount;
+
+/**
+ @abstract Memory of the first instance.
+ @discussion Values of instance idx are written to the binding offset by idx * instanceStride bytes. Values are only available through getValues:forInstanceAtIndex: when unbound. Bindings with a NULL base, or a count other than valueCount, are ignored, leaving the animation unbound.
+ */
+@property (assign, nonatomic) POPMemoryBinding memoryBinding;
+
+/**
+ @abstract The byte distance between the memory of consecutive instances.
+ @discussion Defaults to 0, packing instances valueCount components of the binding apart.
+ */
+@property (assign, nonatomic) size_t instanceStride;
+
+/**
+ @abstract The effective bounciness, see POPSpringAnimation. Defaults to 4.
+ */
+@property (assign, nonatomic) CGFloat springBounciness;
+
+/**
+ @abstract The effective speed, see POPSpringAnimation. Defaults to 12.
+ */
+@property (assign, nonatomic) CGFloat springSpeed;
+
+/**
+ @abstract The tension used in the dynamics simulation.
+ */
+@property (assign, nonatomic) CGFloat dynamicsTension;
+
+/**
+ @abstract The friction used in the dynamics simulation.
+ */
+@property (assign, nonatomic) CGFloat dynamicsFriction;
+
+/**
+ @abstract The mass used in the dynamics simulation.
+ */
+@property (assign, nonatomic) CGFloat dynamicsMass;
+
+/**
+ @abstract The threshold value used when determining completion of instances. Defaults to 0.01.
+ */
+@property (assign, nonatomic) CGFloat threshold;
+
+/**
+ @abstract The number of instances.
+ */
+@property (readonly, nonatomic) NSUInteger instanceCount;
+
+/**
+ @abstract The number of instances yet to converge.
+ */
+@property (readonly, nonatomic) NSUInteger activeInstanceCount;
+
+/**
+ @abstract Adds an instance.
+ @param fromValue The valueCount initial values.
+ @param toValue The valueCount values to converge to.
+ @param velocity The valueCount initial velocities, in units per second. May be NULL.
+ @returns The instance index.
+ */
+- (NSUInteger)addInstanceWithFromValue:(const CGFloat *)fromValue toValue:(const CGFloat *)toValue velocity:(const CGFloat *)velocity;
+
+/**
+ @abstract Retargets an instance, keeping its current value and velocity.
+ */
+- (void)setToValue:(const CGFloat *)toValue forInstanceAtIndex:(NSUInteger)idx;
+
+/**
+ @abstract Copies the valueCount current values of an instance.
+ */
+- (void)getValues:(CGFloat *)values forInstanceAtIndex:(NSUInteger)idx;
+
+/**
+ @abstract Removes all instances.
+ */
+- (void)removeAllInstances;
+
+@end
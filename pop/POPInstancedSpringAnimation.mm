@@ -0,0 +1,194 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "POPInstancedSpringAnimation.h"
+
+#import "POPAnimationExtras.h"
+#import "POPAnimationInternal.h"
+#import "POPSpringInstances.h"
+
+// threshold of point and scalar layer properties
+static const CGFloat kPOPInstancedSpringThresholdDefault = 0.01;
+
+struct _POPInstancedSpringAnimationState : _POPAnimationState
+{
+  SpringInstances instances;
+  POPMemoryBinding memoryBinding;
+  size_t instanceStride;
+  CGFloat springSpeed;
+  CGFloat springBounciness;
+  CGFloat dynamicsTension;
+  CGFloat dynamicsFriction;
+  CGFloat dynamicsMass;
+  CGFloat threshold;
+
+  _POPInstancedSpringAnimationState(id __unsafe_unretained anim, NSUInteger valueCount) : _POPAnimationState(anim),
+  instances(valueCount, 1, 1, 1),
+  memoryBinding(),
+  instanceStride(0),
+  springSpeed(12.),
+  springBounciness(4.),
+  dynamicsTension(0),
+  dynamicsFriction(0),
+  dynamicsMass(0),
+  threshold(kPOPInstancedSpringThresholdDefault)
+  {
+    type = kPOPAnimationInstancedSpring;
+    instances.setThreshold(threshold);
+    updatedBouncinessAndSpeed();
+  }
+
+  bool isDone() {
+    return isStarted() && 0 == instances.activeCount();
+  }
+
+  void updatedDynamics()
+  {
+    instances.setConstants(dynamicsTension, dynamicsFriction, dynamicsMass);
+  }
+
+  void updatedBouncinessAndSpeed() {
+    [POPSpringAnimation convertBounciness:springBounciness speed:springSpeed toTension:&dynamicsTension friction:&dynamicsFriction mass:&dynamicsMass];
+    updatedDynamics();
+  }
+
+  bool advance(CFTimeInterval time, CFTimeInterval dt, id obj) {
+    instances.advance(dt);
+    if (0 != memoryBinding.count) {
+      // zero strides pack instances
+      instances.write(memoryBinding, instanceStride);
+    }
+    return true;
+  }
+};
+
+typedef struct _POPInstancedSpringAnimationState POPInstancedSpringAnimationState;
+
+@interface POPInstancedSpringAnimation ()
+@property (readwrite, nonatomic) NSUInteger valueCount;
+@end
+
+@implementation POPInstancedSpringAnimation
+
+#undef __state
+#define __state ((POPInstancedSpringAnimationState *)_state)
+
+#pragma mark - Lifecycle
+
++ (instancetype)animationWithValueCount:(NSUInteger)valueCount
+{
+  return [[self alloc] _initWithValueCount:valueCount];
+}
+
+- (id)init
+{
+  return [self _initWithValueCount:1];
+}
+
+- (id)_initWithValueCount:(NSUInteger)valueCount
+{
+  NSParameterAssert(valueCount > 0 && valueCount <= 4);
+  _valueCount = valueCount;
+  return [super _init];
+}
+
+- (void)_initState
+{
+  _state = new POPInstancedSpringAnimationState(self, _valueCount);
+}
+
+#pragma mark - Properties
+
+@synthesize valueCount = _valueCount;
+
+FB_PROPERTY_GET(POPInstancedSpringAnimationState, memoryBinding, POPMemoryBinding);
+- (void)setMemoryBinding:(POPMemoryBinding)binding
+{
+  NSAssert(0 == binding.count || binding.count == _valueCount, @"memory binding count %lu does not match value count %lu", (unsigned long)binding.count, (unsigned long)_valueCount);
+
+  // invalid bindings are ignored, leaving the animation unbound
+  __state->memoryBinding = memory_binding_valid(binding) && binding.count == _valueCount ? binding : POPMemoryBinding();
+}
+
+DEFINE_RW_PROPERTY(POPInstancedSpringAnimationState, instanceStride, setInstanceStride:, size_t);
+DEFINE_RW_PROPERTY(POPInstancedSpringAnimationState, dynamicsTension, setDynamicsTension:, CGFloat, __state->updatedDynamics(););
+DEFINE_RW_PROPERTY(POPInstancedSpringAnimationState, dynamicsFriction, setDynamicsFriction:, CGFloat, __state->updatedDynamics(););
+DEFINE_RW_PROPERTY(POPInstancedSpringAnimationState, dynamicsMass, setDynamicsMass:, CGFloat, __state->updatedDynamics(););
+DEFINE_RW_PROPERTY(POPInstancedSpringAnimationState, springSpeed, setSpringSpeed:, CGFloat, __state->updatedBouncinessAndSpeed(););
+DEFINE_RW_PROPERTY(POPInstancedSpringAnimationState, springBounciness, setSpringBounciness:, CGFloat, __state->updatedBouncinessAndSpeed(););
+DEFINE_RW_PROPERTY(POPInstancedSpringAnimationState, threshold, setThreshold:, CGFloat, __state->instances.setThreshold(__state->threshold););
+
+- (NSUInteger)instanceCount
+{
+  return __state->instances.count();
+}
+
+- (NSUInteger)activeInstanceCount
+{
+  return __state->instances.activeCount();
+}
+
+#pragma mark - Instances
+
+- (NSUInteger)addInstanceWithFromValue:(const CGFloat *)fromValue toValue:(const CGFloat *)toValue velocity:(const CGFloat *)velocity
+{
+  NSParameterAssert(NULL != fromValue && NULL != toValue);
+  return __state->instances.addInstance(fromValue, toValue, velocity);
+}
+
+- (void)setToValue:(const CGFloat *)toValue forInstanceAtIndex:(NSUInteger)idx
+{
+  NSParameterAssert(NULL != toValue && idx < __state->instances.count());
+  __state->instances.setToValue(idx, toValue);
+}
+
+- (void)getValues:(CGFloat *)values forInstanceAtIndex:(NSUInteger)idx
+{
+  NSParameterAssert(NULL != values && idx < __state->instances.count());
+  __state->instances.getValues(idx, values);
+}
+
+- (void)removeAllInstances
+{
+  __state->instances.removeAllInstances();
+}
+
+#pragma mark - Utility
+
+- (void)_appendDescription:(NSMutableString *)s debug:(BOOL)debug
+{
+  [s appendFormat:@"; instances = %lu; active = %lu; tension = %f; friction = %f; mass = %f", (unsigned long)self.instanceCount, (unsigned long)self.activeInstanceCount, __state->dynamicsTension, __state->dynamicsFriction, __state->dynamicsMass];
+}
+
+@end
+
+@implementation POPInstancedSpringAnimation (NSCopying)
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+
+  POPInstancedSpringAnimation *copy = [super copyWithZone:zone];
+
+  if (copy) {
+    POPInstancedSpringAnimationState *s = (POPInstancedSpringAnimationState *)POPAnimationGetState(copy);
+    s->instances = __state->instances;
+    s->memoryBinding = __state->memoryBinding;
+    s->instanceStride = __state->instanceStride;
+    s->springSpeed = __state->springSpeed;
+    s->springBounciness = __state->springBounciness;
+    s->dynamicsTension = __state->dynamicsTension;
+    s->dynamicsFriction = __state->dynamicsFriction;
+    s->dynamicsMass = __state->dynamicsMass;
+    s->threshold = __state->threshold;
+    copy.valueCount = self.valueCount;
+  }
+
+  return copy;
+}
+
+@end
@@ -7,11 +7,8 @@
  of patent rights can be found in the PATENTS file in the same directory.
  */
 
-#import <Foundation/Foundation.h>
-
-#import <CoreGraphics/CoreGraphics.h>
-
 #import "POPDefines.h"
+#import "POPPlatform.h"
 #import "POPVector.h"
 
 NS_INLINE CGFloat sqrtr(CGFloat f)
@@ -54,3 +51,37 @@ extern void POPQuadraticSolve(CGFloat a, CGFloat b, CGFloat c, CGFloat &x1, CGFl
 
 // for a given tension return the bouncy 3 friction that produces no bounce
 extern double POPBouncy3NoBounce(double tension);
+
+// bouncy 3 normalization of bounciness and speed
+static const CGFloat POPBouncy3NormalizationRange = 20.0;
+static const CGFloat POPBouncy3NormalizationScale = 1.7;
+static const CGFloat POPBouncy3BouncinessNormalizedMin = 0.0;
+static const CGFloat POPBouncy3BouncinessNormalizedMax = 0.8;
+static const CGFloat POPBouncy3SpeedNormalizedMin = 0.5;
+static const CGFloat POPBouncy3SpeedNormalizedMax = 200;
+static const CGFloat POPBouncy3FrictionInterpolationMax = 0.01;
+
+// for a given bounciness and speed return spring animation tension and friction, of unit mass
+extern void POPBouncy3Convert(double bounciness, double speed, double &outTension, double &outFriction);
+
+// advance decaying position and velocity by dt given per millisecond deceleration
+NS_INLINE void decay_position(CGFloat *x, CGFloat *v, NSUInteger count, CFTimeInterval dt, CGFloat deceleration)
+{
+  dt *= 1000;
+
+  // v0 = v / 1000
+  // v = v0 * powf(deceleration, dt);
+  // v = v * 1000;
+
+  // x0 = x;
+  // x = x0 + v0 * deceleration * (1 - powf(deceleration, dt)) / (1 - deceleration)
+  float v0[count];
+  float kv = powf(deceleration, dt);
+  float kx = deceleration * (1 - kv) / (1 - deceleration);
+
+  for (NSUInteger idx = 0; idx < count; idx++) {
+    v0[idx] = v[idx] / 1000.;
+    v[idx] = v0[idx] * kv * 1000.;
+    x[idx] = x[idx] + v0[idx] * kx;
+  }
+}
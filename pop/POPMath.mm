@@ -9,7 +9,6 @@
 
 #import "POPMath.h"
 
-#import "POPAnimationPrivate.h"
 #import "UnitBezier.h"
 
 void POPInterpolateVector(NSUInteger count, CGFloat *dst, const CGFloat *from, const CGFloat *to, CGFloat f)
@@ -75,6 +74,20 @@ double POPBouncy3NoBounce(double tension)
   return friction;
 }
 
+void POPBouncy3Convert(double bounciness, double speed, double &outTension, double &outFriction)
+{
+  double b = POPNormalize(bounciness / POPBouncy3NormalizationScale, 0, POPBouncy3NormalizationRange);
+  b = POPProjectNormal(b, POPBouncy3BouncinessNormalizedMin, POPBouncy3BouncinessNormalizedMax);
+
+  double s = POPNormalize(speed / POPBouncy3NormalizationScale, 0, POPBouncy3NormalizationRange);
+
+  double tension = POPProjectNormal(s, POPBouncy3SpeedNormalizedMin, POPBouncy3SpeedNormalizedMax);
+  double friction = POPQuadraticOutInterpolation(b, POPBouncy3NoBounce(tension), POPBouncy3FrictionInterpolationMax);
+
+  outTension = POP_ANIMATION_TENSION_FOR_QC_TENSION(tension);
+  outFriction = POP_ANIMATION_FRICTION_FOR_QC_FRICTION(friction);
+}
+
 void POPQuadraticSolve(CGFloat a, CGFloat b, CGFloat c, CGFloat &x1, CGFloat &x2)
 {
   CGFloat discriminant = sqrt(b * b - 4 * a * c);
@@ -0,0 +1,51 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef POP_POPMemoryBinding_h
+#define POP_POPMemoryBinding_h
+
+#include <stddef.h>
+
+/**
+ @abstract Scalar types of memory bound values.
+ */
+typedef enum
+{
+  kPOPScalarTypeFloat,
+  kPOPScalarTypeDouble,
+} POPScalarType;
+
+/**
+ @abstract Describes animated values stored directly in memory.
+ @discussion Component idx is read from and written to base + offset + idx * stride. A stride of zero denotes tightly packed components. A binding with count zero is unbound.
+ */
+typedef struct
+{
+  void *base;
+  size_t offset;
+  size_t stride;
+  size_t count;
+  POPScalarType type;
+} POPMemoryBinding;
+
+/**
+ @abstract Makes a memory binding.
+ @param base The base address, which must outlive animations of the binding.
+ @param offset The byte offset of the first component from base, for instance offsetof of a struct field.
+ @param stride The byte distance between components, zero if tightly packed.
+ @param count The number of components, up to four.
+ @param type The scalar type of components.
+ */
+static inline POPMemoryBinding POPMemoryBindingMake(void *base, size_t offset, size_t stride, size_t count, POPScalarType type)
+{
+  POPMemoryBinding binding = {base, offset, stride, count, type};
+  return binding;
+}
+
+#endif
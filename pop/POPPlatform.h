@@ -0,0 +1,80 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef POP_POPPlatform_h
+#define POP_POPPlatform_h
+
+/**
+ Platform types used by the numerical core. Apple platforms use the system frameworks; elsewhere, minimal equivalents allow the core to build as plain C++.
+ */
+
+#if defined(__APPLE__)
+
+#ifdef __OBJC__
+#import <Foundation/Foundation.h>
+#endif
+
+#import <objc/NSObjCRuntime.h>
+
+#import <CoreGraphics/CoreGraphics.h>
+
+#else
+
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+typedef double CGFloat;
+#define CGFLOAT_IS_DOUBLE 1
+#define CGFLOAT_MIN DBL_MIN
+#define CGFLOAT_MAX DBL_MAX
+
+typedef double CFTimeInterval;
+typedef long NSInteger;
+typedef unsigned long NSUInteger;
+
+struct CGPoint { CGFloat x; CGFloat y; };
+struct CGSize { CGFloat width; CGFloat height; };
+struct CGRect { CGPoint origin; CGSize size; };
+struct CGAffineTransform { CGFloat a, b, c, d, tx, ty; };
+
+static inline CGPoint CGPointMake(CGFloat x, CGFloat y) { CGPoint p = {x, y}; return p; }
+static inline CGSize CGSizeMake(CGFloat width, CGFloat height) { CGSize s = {width, height}; return s; }
+static inline CGRect CGRectMake(CGFloat x, CGFloat y, CGFloat width, CGFloat height) { CGRect r = {{x, y}, {width, height}}; return r; }
+
+static const CGRect CGRectZero = {{0, 0}, {0, 0}};
+static const CGAffineTransform CGAffineTransformIdentity = {1, 0, 0, 1, 0, 0};
+
+#ifndef NS_INLINE
+#define NS_INLINE static inline
+#endif
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
+#endif
+
+#ifndef __OBJC__
+#include <cassert>
+
+// descriptions are Objective-C format strings; assert the condition only
+#define NSCAssert(condition, desc, ...) assert(condition)
+#define NSCParameterAssert(condition) assert(condition)
+#endif
+
+#endif
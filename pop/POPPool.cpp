@@ -0,0 +1,287 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "POPPool.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <pthread.h>
+
+namespace POP {
+
+  // blocks moved between a thread cache and the shared free list at a time
+  static const size_t kBatchCount = 32;
+
+  // free blocks a thread keeps per size class before returning a batch
+  static const size_t kCacheLimit = 2 * kBatchCount;
+
+  // slab bytes, holding at least kBatchCount blocks
+  static const size_t kSlabSize = 16 * 1024;
+
+  static const size_t kClassCount = kPoolMaxSize / kPoolGranularity;
+
+  struct Block
+  {
+    Block *next;
+  };
+
+  struct SizeClass
+  {
+    size_t blockSize;
+    pthread_mutex_t lock;
+    Block *shared; // blocks returned by thread caches, guarded by lock
+    std::atomic<uint64_t> refillCount;
+    std::atomic<uint64_t> slabCount;
+  };
+
+  /**
+   Counters only written by the owning thread, so increments need no atomic read-modify-write.
+   */
+  struct ThreadCounter
+  {
+    std::atomic<uint64_t> value;
+
+    void increment()
+    {
+      value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+  };
+
+  struct ThreadCache
+  {
+    Block *head[kClassCount];
+    size_t count[kClassCount];
+    ThreadCounter allocationCount[kClassCount];
+    ThreadCounter freeCount[kClassCount];
+    ThreadCache *next; // registry, guarded by _registryLock
+  };
+
+  // never destroyed, as blocks may be freed by thread exit after static destruction
+  static SizeClass *_classes;
+  static std::atomic<uint64_t> _oversizeCount(0);
+  static std::atomic<uint64_t> _oversizeFreeCount(0);
+
+  // live thread caches, and counts of exited threads
+  static pthread_mutex_t _registryLock = PTHREAD_MUTEX_INITIALIZER;
+  static ThreadCache *_registry;
+  static uint64_t _exitedAllocationCount[kClassCount];
+  static uint64_t _exitedFreeCount[kClassCount];
+  static pthread_key_t _cacheKey;
+  static pthread_once_t _once = PTHREAD_ONCE_INIT;
+
+  static void release_blocks(SizeClass &c, Block *first, Block *last)
+  {
+    pthread_mutex_lock(&c.lock);
+    last->next = c.shared;
+    c.shared = first;
+    pthread_mutex_unlock(&c.lock);
+  }
+
+  static void thread_cache_destroy(void *ptr)
+  {
+    ThreadCache *cache = (ThreadCache *)ptr;
+    for (size_t idx = 0; idx < kClassCount; idx++) {
+      Block *first = cache->head[idx];
+      if (NULL == first) {
+        continue;
+      }
+      Block *last = first;
+      while (NULL != last->next) {
+        last = last->next;
+      }
+      release_blocks(_classes[idx], first, last);
+    }
+
+    pthread_mutex_lock(&_registryLock);
+    for (ThreadCache **ptr = &_registry; NULL != *ptr; ptr = &(*ptr)->next) {
+      if (cache == *ptr) {
+        *ptr = cache->next;
+        break;
+      }
+    }
+    for (size_t idx = 0; idx < kClassCount; idx++) {
+      _exitedAllocationCount[idx] += cache->allocationCount[idx].value.load(std::memory_order_relaxed);
+      _exitedFreeCount[idx] += cache->freeCount[idx].value.load(std::memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&_registryLock);
+
+    free(cache);
+  }
+
+  static void pool_init()
+  {
+    _classes = new SizeClass[kClassCount];
+    for (size_t idx = 0; idx < kClassCount; idx++) {
+      SizeClass &c = _classes[idx];
+      c.blockSize = (idx + 1) * kPoolGranularity;
+      pthread_mutex_init(&c.lock, NULL);
+      c.shared = NULL;
+      c.refillCount = 0;
+      c.slabCount = 0;
+    }
+    pthread_key_create(&_cacheKey, thread_cache_destroy);
+  }
+
+  static ThreadCache *thread_cache()
+  {
+    pthread_once(&_once, pool_init);
+    ThreadCache *cache = (ThreadCache *)pthread_getspecific(_cacheKey);
+    if (NULL == cache) {
+      // also recreated when freeing during thread exit, flushed again by the next destructor pass
+      cache = (ThreadCache *)calloc(1, sizeof(ThreadCache));
+      pthread_setspecific(_cacheKey, cache);
+
+      pthread_mutex_lock(&_registryLock);
+      cache->next = _registry;
+      _registry = cache;
+      pthread_mutex_unlock(&_registryLock);
+    }
+    return cache;
+  }
+
+  static size_t class_index(size_t size)
+  {
+    return 0 != size ? (size - 1) / kPoolGranularity : 0;
+  }
+
+  static void refill(ThreadCache *cache, size_t idx)
+  {
+    SizeClass &c = _classes[idx];
+    c.refillCount.fetch_add(1, std::memory_order_relaxed);
+
+    // take a batch of shared blocks
+    pthread_mutex_lock(&c.lock);
+    Block *first = c.shared;
+    size_t count = 0;
+    if (NULL != first) {
+      Block *last = first;
+      count = 1;
+      while (count < kBatchCount && NULL != last->next) {
+        last = last->next;
+        count++;
+      }
+      c.shared = last->next;
+      last->next = NULL;
+    }
+    pthread_mutex_unlock(&c.lock);
+
+    if (NULL == first) {
+      // carve a new slab
+      const size_t blockCount = kSlabSize / c.blockSize;
+      char *slab = (char *)malloc(blockCount * c.blockSize);
+      if (NULL == slab) {
+        return;
+      }
+      c.slabCount.fetch_add(1, std::memory_order_relaxed);
+      for (size_t b = blockCount; b > 0; b--) {
+        Block *block = (Block *)(slab + (b - 1) * c.blockSize);
+        block->next = first;
+        first = block;
+      }
+      count = blockCount;
+    }
+
+    cache->head[idx] = first;
+    cache->count[idx] = count;
+  }
+
+  void *pool_allocate(size_t size)
+  {
+    if (size > kPoolMaxSize) {
+      _oversizeCount.fetch_add(1, std::memory_order_relaxed);
+      return malloc(size);
+    }
+
+    ThreadCache *cache = thread_cache();
+    const size_t idx = class_index(size);
+    if (NULL == cache->head[idx]) {
+      refill(cache, idx);
+      if (NULL == cache->head[idx]) {
+        return NULL;
+      }
+    }
+
+    Block *block = cache->head[idx];
+    cache->head[idx] = block->next;
+    cache->count[idx]--;
+    cache->allocationCount[idx].increment();
+    return block;
+  }
+
+  void pool_deallocate(void *ptr, size_t size)
+  {
+    if (NULL == ptr) {
+      return;
+    }
+
+    if (size > kPoolMaxSize) {
+      _oversizeFreeCount.fetch_add(1, std::memory_order_relaxed);
+      free(ptr);
+      return;
+    }
+
+    ThreadCache *cache = thread_cache();
+    const size_t idx = class_index(size);
+    cache->freeCount[idx].increment();
+
+    Block *block = (Block *)ptr;
+    block->next = cache->head[idx];
+    cache->head[idx] = block;
+
+    if (++cache->count[idx] > kCacheLimit) {
+      // return the most recently freed batch, keeping older blocks cached
+      Block *last = block;
+      for (size_t b = 1; b < kBatchCount; b++) {
+        last = last->next;
+      }
+      cache->head[idx] = last->next;
+      cache->count[idx] -= kBatchCount;
+      release_blocks(_classes[idx], block, last);
+    }
+  }
+
+  PoolStatistics pool_statistics(size_t size)
+  {
+    pthread_once(&_once, pool_init);
+
+    PoolStatistics s = {};
+    if (size > kPoolMaxSize) {
+      return s;
+    }
+
+    const size_t begin = 0 != size ? class_index(size) : 0;
+    const size_t end = 0 != size ? begin + 1 : kClassCount;
+    pthread_mutex_lock(&_registryLock);
+    for (size_t idx = begin; idx < end; idx++) {
+      s.allocationCount += _exitedAllocationCount[idx];
+      s.freeCount += _exitedFreeCount[idx];
+      for (const ThreadCache *cache = _registry; NULL != cache; cache = cache->next) {
+        s.allocationCount += cache->allocationCount[idx].value.load(std::memory_order_relaxed);
+        s.freeCount += cache->freeCount[idx].value.load(std::memory_order_relaxed);
+      }
+    }
+    pthread_mutex_unlock(&_registryLock);
+
+    for (size_t idx = begin; idx < end; idx++) {
+      const SizeClass &c = _classes[idx];
+      s.refillCount += c.refillCount.load(std::memory_order_relaxed);
+      s.slabCount += c.slabCount.load(std::memory_order_relaxed);
+    }
+    s.mallocCount = s.slabCount;
+
+    if (0 == size) {
+      const uint64_t oversizeCount = _oversizeCount.load(std::memory_order_relaxed);
+      s.allocationCount += oversizeCount;
+      s.freeCount += _oversizeFreeCount.load(std::memory_order_relaxed);
+      s.mallocCount += oversizeCount;
+    }
+    return s;
+  }
+
+}
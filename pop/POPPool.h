@@ -0,0 +1,105 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef POP_POPPool_h
+#define POP_POPPool_h
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace POP {
+
+  /**
+   Allocation counts of a pool, or of all pools combined.
+   */
+  struct PoolStatistics
+  {
+    uint64_t allocationCount; // blocks allocated
+    uint64_t freeCount;       // blocks freed
+    uint64_t refillCount;     // thread cache refills, the only allocations taking a lock
+    uint64_t slabCount;       // slabs allocated
+    uint64_t mallocCount;     // calls to malloc, slabs plus requests too large to pool
+
+    uint64_t liveCount() const
+    {
+      return allocationCount - freeCount;
+    }
+  };
+
+  /**
+   Size classes are multiples of kPoolGranularity up to kPoolMaxSize; larger requests go to malloc.
+   */
+  static const size_t kPoolGranularity = 16;
+  static const size_t kPoolMaxSize = 1024;
+
+  /**
+   Allocates size bytes from the pool of its size class. Blocks are carved from slabs that are never returned to malloc. Freed blocks go on a free list of the freeing thread and move to a shared list in batches, so allocation and free take no lock in steady state, from any thread.
+   */
+  void *pool_allocate(size_t size);
+
+  /**
+   Allocates as pool_allocate, throwing std::bad_alloc rather than returning NULL when out of memory, as operator new does.
+   */
+  inline void *pool_new(size_t size)
+  {
+    void *ptr = pool_allocate(size);
+    if (NULL == ptr) {
+      throw std::bad_alloc();
+    }
+    return ptr;
+  }
+
+  /**
+   Frees a block of pool_allocate. Size must be the size it was allocated with.
+   */
+  void pool_deallocate(void *ptr, size_t size);
+
+  /**
+   Returns statistics of the pool serving size, or of all pools when size is 0. Oversized allocations count towards the combined statistics only.
+   */
+  PoolStatistics pool_statistics(size_t size = 0);
+
+  /**
+   Standard allocator on pools, for containers and shared pointer control blocks.
+   */
+  template <typename T>
+  struct PoolAllocator
+  {
+    typedef T value_type;
+
+    PoolAllocator() {}
+    template <typename U> PoolAllocator(const PoolAllocator<U> &) {}
+
+    template <typename U> struct rebind { typedef PoolAllocator<U> other; };
+
+    T *allocate(size_t n)
+    {
+      return static_cast<T *>(pool_new(n * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, size_t n)
+    {
+      pool_deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U> bool operator==(const PoolAllocator<U> &) const { return true; }
+    template <typename U> bool operator!=(const PoolAllocator<U> &) const { return false; }
+  };
+
+}
+
+/**
+ Declares class operator new and delete on pools. Sized delete passes the dynamic size of classes with virtual destructors, so one declaration in a base class serves all subclasses.
+ */
+#define POP_POOL_ALLOCATED \
+  static void *operator new(size_t size) { return POP::pool_new(size); } \
+  static void operator delete(void *ptr, size_t size) { POP::pool_deallocate(ptr, size); }
+
+#endif
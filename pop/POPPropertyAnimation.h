@@ -50,6 +50,12 @@ typedef NS_OPTIONS(NSUInteger, POPAnimationClampFlags)
  */
 @property (assign, nonatomic) CGFloat roundingFactor;
 
+/**
+ @abstract Flag indicating whether springs and decays finish once remaining motion cannot change a rounded value.
+ @discussion Convergence otherwise follows the property threshold, often far finer than a device pixel, so animations keep stepping and writing values that round to the same pixel for many frames. Set the roundingFactor to the size of a pixel, such as 0.5 on a 2x screen, to finish writing the final value once the remaining motion, bounded analytically, stays below half the rounding factor. Has no effect without a rounding factor. Defaults to NO.
+ */
+@property (assign, nonatomic) BOOL convergesWithinPixel;
+
 /**
  @abstract The clamp mode applied to the current animated value.
  @discussion See {@ref POPAnimationClampFlags} for possible values. Defaults to kPOPAnimationClampNone.
@@ -25,8 +25,9 @@
 
 DEFINE_RW_FLAG(POPPropertyAnimationState, additive, isAdditive, setAdditive:);
 DEFINE_RW_PROPERTY(POPPropertyAnimationState, roundingFactor, setRoundingFactor:, CGFloat);
+DEFINE_RW_FLAG(POPPropertyAnimationState, convergesWithinPixel, convergesWithinPixel, setConvergesWithinPixel:);
 DEFINE_RW_PROPERTY(POPPropertyAnimationState, clampMode, setClampMode:, NSUInteger);
-DEFINE_RW_PROPERTY_OBJ(POPPropertyAnimationState, property, setProperty:, POPAnimatableProperty*, ((POPPropertyAnimationState*)_state)->updatedDynamicsThreshold(););
+DEFINE_RW_PROPERTY_OBJ(POPPropertyAnimationState, property, setProperty:, POPAnimatableProperty*, ((POPPropertyAnimationState*)_state)->updatedDynamicsThreshold(); ((POPPropertyAnimationState*)_state)->updatedMemoryBinding(););
 DEFINE_RW_PROPERTY_OBJ_COPY(POPPropertyAnimationState, progressMarkers, setProgressMarkers:, NSArray*, ((POPPropertyAnimationState*)_state)->updatedProgressMarkers(););
 
 - (id)fromValue
@@ -42,8 +43,9 @@ DEFINE_RW_PROPERTY_OBJ_COPY(POPPropertyAnimationState, progressMarkers, setProgr
     s->fromVec = vec;
 
     if (s->tracing) {
-      [s->tracer updateFromValue:aValue];
+      [s->cold->tracer updateFromValue:aValue];
     }
+    s->traceValue(kPOPAnimationEventFromValueUpdate, vec);
   }
 }
 
@@ -65,8 +67,9 @@ DEFINE_RW_PROPERTY_OBJ_COPY(POPPropertyAnimationState, progressMarkers, setProgr
     s->distanceVec = NULL;
 
     if (s->tracing) {
-      [s->tracer updateToValue:aValue];
+      [s->cold->tracer updateToValue:aValue];
     }
+    s->traceValue(kPOPAnimationEventToValueUpdate, vec);
 
     // automatically unpause active animations
     if (s->active && s->paused) {
@@ -115,6 +118,7 @@ DEFINE_RW_PROPERTY_OBJ_COPY(POPPropertyAnimationState, progressMarkers, setProgr
     copy.fromValue = self.fromValue;
     copy.toValue = self.toValue;
     copy.roundingFactor = self.roundingFactor;
+    copy.convergesWithinPixel = self.convergesWithinPixel;
     copy.clampMode = self.clampMode;
     copy.additive = self.additive;
   }
@@ -8,65 +8,60 @@
  */
 
 #import "POPAnimationInternal.h"
+#import "POPAnimationKernels.h"
 #import "POPPropertyAnimation.h"
 
-static void clampValue(CGFloat &value, CGFloat fromValue, CGFloat toValue, NSUInteger clamp)
-{
-  BOOL increasing = (toValue > fromValue);
-
-  // Clamp start of animation.
-  if ((kPOPAnimationClampStart & clamp) &&
-      ((increasing && (value < fromValue)) || (!increasing && (value > fromValue)))) {
-    value = fromValue;
-  }
-
-  // Clamp end of animation.
-  if ((kPOPAnimationClampEnd & clamp) &&
-      ((increasing && (value > toValue)) || (!increasing && (value < toValue)))) {
-    value = toValue;
-  }
-}
+static_assert(kPOPAnimationClampStart == (NSUInteger)kClampStart && kPOPAnimationClampEnd == (NSUInteger)kClampEnd, "clamp flags must match kernel flags");
 
 struct _POPPropertyAnimationState : _POPAnimationState
 {
+  // stepping state
   POPAnimatableProperty *property;
-  POPValueType valueType;
   NSUInteger valueCount;
-  VectorRef fromVec;
-  VectorRef toVec;
+  POPValueType valueType;
+  bool convergesWithinPixel;
+  CGFloat roundingFactor;
+  NSUInteger clampMode;
+  CGFloat dynamicsThreshold;
+  POPProgressMarker *progressMarkerState;
+  NSUInteger progressMarkerCount;
+  NSUInteger nextProgressMarkerIdx;
   VectorRef currentVec;
+  VectorRef toVec;
+  VectorRef fromVec;
+  VectorRef velocityVec;
   VectorRef previousVec;
   VectorRef previous2Vec;
-  VectorRef velocityVec;
+  VectorRef writtenVec; // last value written, if still current
+  POPMemoryBinding memoryBinding;
+
+  // set on start or configuration
   VectorRef originalVelocityVec;
   VectorRef distanceVec;
-  CGFloat roundingFactor;
-  NSUInteger clampMode;
   NSArray *progressMarkers;
-  POPProgressMarker *progressMarkerState;
-  NSUInteger progressMarkerCount;
-  NSUInteger nextProgressMarkerIdx;
-  CGFloat dynamicsThreshold;
 
   _POPPropertyAnimationState(id __unsafe_unretained anim) : _POPAnimationState(anim),
   property(nil),
-  valueType((POPValueType)0),
   valueCount(0),
-  fromVec(nullptr),
-  toVec(nullptr),
-  currentVec(nullptr),
-  previousVec(nullptr),
-  previous2Vec(nullptr),
-  velocityVec(nullptr),
-  originalVelocityVec(nullptr),
-  distanceVec(nullptr),
+  valueType((POPValueType)0),
+  convergesWithinPixel(false),
   roundingFactor(0),
   clampMode(0),
-  progressMarkers(nil),
+  dynamicsThreshold(0),
   progressMarkerState(nil),
   progressMarkerCount(0),
   nextProgressMarkerIdx(0),
-  dynamicsThreshold(0)
+  currentVec(nullptr),
+  toVec(nullptr),
+  fromVec(nullptr),
+  velocityVec(nullptr),
+  previousVec(nullptr),
+  previous2Vec(nullptr),
+  writtenVec(nullptr),
+  memoryBinding(),
+  originalVelocityVec(nullptr),
+  distanceVec(nullptr),
+  progressMarkers(nil)
   {
     type = kPOPAnimationBasic;
   }
@@ -91,6 +86,17 @@ struct _POPPropertyAnimationState : _POPAnimationState
     return 0 != valueCount;
   }
 
+  // remaining motion below which rounded values cannot change, zero without pixel convergence
+  CGFloat pixelTolerance() {
+    return convergesWithinPixel ? roundingFactor / 2 : 0;
+  }
+
+  void traceValue(POPAnimationEventType eventType, const VectorConstRef &vec) {
+    if (vec) {
+      traceRecord(eventType, vec->data(), vec->size(), valueType);
+    }
+  }
+
   bool isDone() {
     // inherit done
     if (_POPAnimationState::isDone()) {
@@ -147,6 +153,31 @@ struct _POPPropertyAnimationState : _POPAnimationState
     dynamicsThreshold = property.threshold;
   }
 
+  void updatedMemoryBinding()
+  {
+    // cache binding, avoiding a message send per write
+    memoryBinding = nil != property ? property.memoryBinding : POPMemoryBinding();
+  }
+
+  // properties of mutable classes are not validated on assignment
+  bool hasMemoryBinding() const
+  {
+    return memory_binding_valid(memoryBinding);
+  }
+
+  bool canReadValues()
+  {
+    return hasMemoryBinding() || nil != property.readBlock;
+  }
+
+  Vector4r readValues(id obj)
+  {
+    if (hasMemoryBinding()) {
+      return read_values(memoryBinding, valueCount);
+    }
+    return read_values(property.readBlock, obj, valueCount);
+  }
+
   void finalizeProgress()
   {
     progress = 1.0;
@@ -187,7 +218,7 @@ struct _POPPropertyAnimationState : _POPAnimationState
 
         if (!progressMarkerState[nextProgressMarkerIdx].reached) {
           ActionEnabler enabler;
-          [delegate pop_animation:self didReachProgress:progressMarkerState[nextProgressMarkerIdx].progress];
+          [cold->delegate pop_animation:self didReachProgress:progressMarkerState[nextProgressMarkerIdx].progress];
           progressMarkerState[nextProgressMarkerIdx].reached = true;
         }
 
@@ -228,32 +259,33 @@ struct _POPPropertyAnimationState : _POPAnimationState
 
     if (delegateDidReachToValue) {
       ActionEnabler enabler;
-      [delegate pop_animationDidReachToValue:self];
+      [cold->delegate pop_animationDidReachToValue:self];
     }
 
-    POPAnimationDidReachToValueBlock block = animationDidReachToValueBlock;
+    POPAnimationDidReachToValueBlock block = cold ? cold->animationDidReachToValueBlock : NULL;
     if (block != NULL) {
       ActionEnabler enabler;
       block(self);
     }
 
     if (tracing) {
-      [tracer didReachToValue:POPBox(currentValue(), valueType, true)];
+      [cold->tracer didReachToValue:POPBox(currentValue(), valueType, true)];
     }
+    traceValue(kPOPAnimationEventDidReachToValue, currentVec);
   }
 
   void readObjectValue(VectorRef *ptrVec, id obj)
   {
     // use current object value as from value
-    pop_animatable_read_block read = property.readBlock;
-    if (NULL != read) {
+    if (canReadValues()) {
 
-      Vector4r vec = read_values(read, obj, valueCount);
+      Vector4r vec = readValues(obj);
       *ptrVec = VectorRef(Vector::new_vector(valueCount, vec));
 
       if (tracing) {
-        [tracer readPropertyValue:POPBox(*ptrVec, valueType, true)];
+        [cold->tracer readPropertyValue:POPBox(*ptrVec, valueType, true)];
       }
+      traceValue(kPOPAnimationEventPropertyRead, *ptrVec);
     }
   }
 
@@ -324,6 +356,8 @@ struct _POPPropertyAnimationState : _POPAnimationState
       previousVec = NULL;
       previous2Vec = NULL;
     }
+    // the object may change while paused
+    writtenVec = NULL;
     progress = 0;
     resetProgressMarkerState();
     didReachToValue = false;
@@ -336,13 +370,7 @@ struct _POPPropertyAnimationState : _POPAnimationState
       return;
 
     // Clamp all vector values
-    CGFloat *currentValues = currentVec->data();
-    const CGFloat *fromValues = fromVec->data();
-    const CGFloat *toValues = toVec->data();
-
-    for (NSUInteger idx = 0; idx < valueCount; idx++) {
-      clampValue(currentValues[idx], fromValues[idx], toValues[idx], clamp);
-    }
+    clamp_values(currentVec->data(), fromVec->data(), toVec->data(), valueCount, clamp);
   }
 
   void clampCurrentValue()
@@ -64,4 +64,10 @@
  */
 @property (assign, nonatomic) CGFloat dynamicsMass;
 
+/**
+ @abstract The estimated time remaining until the animation converges, in seconds.
+ @discussion Computed analytically from the dynamics constants, the current or from value, the to value, the velocity and the property threshold. Useful to schedule work ahead of completion without polling. Returns 0 while values are unknown, and INFINITY for springs without friction or springs estimated to take longer than 30 seconds to settle.
+ */
+@property (readonly, nonatomic) CFTimeInterval estimatedSettlingDuration;
+
 @end
@@ -38,6 +38,7 @@
   self = [super _init];
   if (nil != self) {
     __state->solver = new SpringSolver4d(1, 1, 1);
+    __state->solver->setIntegrator(kSpringSolverIntegratorRK4Matrix);
     __state->updatedDynamicsThreshold();
     __state->updatedBouncinessAndSpeed();
   }
@@ -69,8 +70,9 @@
     s->originalVelocityVec = origVec;
 
     if (s->tracing) {
-      [s->tracer updateVelocity:aValue];
+      [s->cold->tracer updateVelocity:aValue];
     }
+    s->traceValue(kPOPAnimationEventVelocityUpdate, vec);
   }
 }
 
@@ -87,8 +89,9 @@ FB_PROPERTY_GET(POPSpringAnimationState, springSpeed, CGFloat);
     s->userSpecifiedDynamics = false;
     s->updatedBouncinessAndSpeed();
     if (s->tracing) {
-      [s->tracer updateSpeed:aFloat];
+      [s->cold->tracer updateSpeed:aFloat];
     }
+    s->traceRecord(kPOPAnimationEventSpeedUpdate, &aFloat, 1);
   }
 }
 
@@ -101,11 +104,17 @@ FB_PROPERTY_GET(POPSpringAnimationState, springBounciness, CGFloat);
     s->userSpecifiedDynamics = false;
     s->updatedBouncinessAndSpeed();
     if (s->tracing) {
-      [s->tracer updateBounciness:aFloat];
+      [s->cold->tracer updateBounciness:aFloat];
     }
+    s->traceRecord(kPOPAnimationEventBouncinessUpdate, &aFloat, 1);
   }
 }
 
+- (CFTimeInterval)estimatedSettlingDuration
+{
+  return __state->estimatedSettlingDuration();
+}
+
 - (SpringSolver4d *)solver
 {
   return __state->solver;
@@ -127,8 +136,9 @@ FB_PROPERTY_GET(POPSpringAnimationState, springBounciness, CGFloat);
 {
   __state->userSpecifiedDynamics = true;
   if(__state->tracing) {
-    [__state->tracer updateTension:__state->dynamicsTension];
+    [__state->cold->tracer updateTension:__state->dynamicsTension];
   }
+  __state->traceRecord(kPOPAnimationEventTensionUpdate, &__state->dynamicsTension, 1);
   __state->updatedDynamics();
 }
 
@@ -136,8 +146,9 @@ FB_PROPERTY_GET(POPSpringAnimationState, springBounciness, CGFloat);
 {
   __state->userSpecifiedDynamics = true;
   if(__state->tracing) {
-    [__state->tracer updateFriction:__state->dynamicsFriction];
+    [__state->cold->tracer updateFriction:__state->dynamicsFriction];
   }
+  __state->traceRecord(kPOPAnimationEventFrictionUpdate, &__state->dynamicsFriction, 1);
   __state->updatedDynamics();
 }
 
@@ -145,8 +156,9 @@ FB_PROPERTY_GET(POPSpringAnimationState, springBounciness, CGFloat);
 {
   __state->userSpecifiedDynamics = true;
   if(__state->tracing) {
-    [__state->tracer updateMass:__state->dynamicsMass];
+    [__state->cold->tracer updateMass:__state->dynamicsMass];
   }
+  __state->traceRecord(kPOPAnimationEventMassUpdate, &__state->dynamicsMass, 1);
   __state->updatedDynamics();
 }
 
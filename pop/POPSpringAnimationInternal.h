@@ -34,33 +34,33 @@ struct _POPSpringAnimationState : _POPPropertyAnimationState
 
   bool hasConverged()
   {
-    NSUInteger count = valueCount;
     if (shouldRound()) {
       return vec_equal(previous2Vec, previousVec) && vec_equal(previousVec, toVec);
     } else {
-      if (!previousVec || !previous2Vec)
-        return false;
-
-      CGFloat t  = dynamicsThreshold / 5;
-
-      const CGFloat *toValues = toVec->data();
-      const CGFloat *previousValues = previousVec->data();
-      const CGFloat *previous2Values = previous2Vec->data();
+      return spring_converged(toVec->data(), vec_data(previousVec), vec_data(previous2Vec), valueCount, dynamicsThreshold);
+    }
+  }
 
-      for (NSUInteger idx = 0; idx < count; idx++) {
-          if ((std::abs(toValues[idx] - previousValues[idx]) >= t) || (std::abs(previous2Values[idx] - previousValues[idx]) >= t)) {
-          return false;
-        }
-      }
-      return true;
+  // whether remaining motion, bounded analytically, stays within the pixel tolerance
+  bool hasConvergedWithinPixel()
+  {
+    const CGFloat tolerance = pixelTolerance();
+    if (0 == tolerance || !currentVec || !toVec) {
+      return false;
     }
+
+    // solver perspective, see advance
+    SSState4d state;
+    state.p = vector4d(toVec) - vector4d(currentVec);
+    state.v = vector4d(velocityVec) * -1;
+    return solver->maximumDisplacement(state) < tolerance;
   }
 
   bool isDone() {
     if (_POPPropertyAnimationState::isDone()) {
       return true;
     }
-    return solver->started() && (hasConverged() || solver->hasConverged());
+    return solver->started() && (hasConverged() || solver->hasConverged() || hasConvergedWithinPixel());
   }
 
   void updatedDynamics()
@@ -83,6 +83,25 @@ struct _POPSpringAnimationState : _POPPropertyAnimationState
     updatedDynamics();
   }
 
+  CFTimeInterval estimatedSettlingDuration()
+  {
+    // prefer current value of running animations
+    VectorRef value = NULL != currentVec ? currentVec : fromVec;
+    if (NULL == solver || !value || !toVec || 0 == dynamicsThreshold) {
+      return 0;
+    }
+
+    // solver perspective, see advance
+    SSState4d state;
+    state.p = vector4d(toVec) - vector4d(value);
+    state.v = vector4d(velocityVec) * -1;
+    return solver->settlingTime(state);
+  }
+
+  NSUInteger solverStepCount() {
+    return NULL != solver ? solver->stepCount() : 0;
+  }
+
   bool advance(CFTimeInterval time, CFTimeInterval dt, id obj) {
     // advance past not yet initialized animations
     if (NULL == currentVec) {
@@ -91,28 +110,7 @@ struct _POPSpringAnimationState : _POPPropertyAnimationState
 
     CFTimeInterval localTime = time - startTime;
 
-    Vector4d value = vector4d(currentVec);
-    Vector4d toValue = vector4d(toVec);
-    Vector4d velocity = vector4d(velocityVec);
-
-    SSState4d state;
-    state.p = toValue - value;
-
-    // the solver assumes a spring of size zero
-    // flip the velocity from user perspective to solver perspective
-    state.v = velocity * -1;
-
-    solver->advance(state, localTime, dt);
-    value = toValue - state.p;
-
-    // flip velocity back to user perspective
-    velocity = state.v * -1;
-
-    *currentVec = value;
-
-    if (velocityVec) {
-      *velocityVec = velocity;
-    }
+    spring_advance(*solver, currentVec->data(), vec_data(velocityVec), vec_data(toVec), valueCount, localTime, dt);
 
     clampCurrentValue();
 
@@ -0,0 +1,213 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "POPSpringInstances.h"
+
+#include <algorithm>
+
+namespace POP {
+
+  SpringInstances::SpringInstances(NSUInteger valueCount, double tension, double friction, double mass) :
+  _valueCount(valueCount),
+  _accumulatedTime(0),
+  _activeCount(0)
+  {
+    NSCParameterAssert(valueCount > 0 && valueCount <= 4);
+    setConstants(tension, friction, mass);
+    setThreshold(1.);
+  }
+
+  void SpringInstances::setConstants(double tension, double friction, double mass)
+  {
+    _k = tension;
+    _b = friction;
+    _m = mass;
+    updateStep();
+  }
+
+  void SpringInstances::setThreshold(CGFloat threshold)
+  {
+    // see SpringSolver::setThreshold
+    _tp = threshold / 2;
+    _tv = 25.0 * threshold;
+    _ta = 625.0 * threshold * threshold;
+  }
+
+  void SpringInstances::updateStep()
+  {
+    spring_step_matrix(_step, _k, _b, _m, solverDt);
+  }
+
+  size_t SpringInstances::addInstance(const CGFloat *fromValue, const CGFloat *toValue, const CGFloat *velocity)
+  {
+    for (NSUInteger c = 0; c < _valueCount; c++) {
+      _x[c].push_back(fromValue[c] - toValue[c]);
+      _v[c].push_back(NULL != velocity ? velocity[c] : 0.);
+      _to[c].push_back(toValue[c]);
+    }
+    _done.push_back(0);
+    _maxX.push_back(0);
+    _v2.push_back(0);
+    _a2.push_back(0);
+    _activeCount++;
+    return _done.size() - 1;
+  }
+
+  void SpringInstances::setToValue(size_t idx, const CGFloat *toValue)
+  {
+    for (NSUInteger c = 0; c < _valueCount; c++) {
+      _x[c][idx] += _to[c][idx] - toValue[c];
+      _to[c][idx] = toValue[c];
+    }
+    if (_done[idx]) {
+      _done[idx] = 0;
+      _activeCount++;
+    }
+  }
+
+  void SpringInstances::getValues(size_t idx, CGFloat *values) const
+  {
+    for (NSUInteger c = 0; c < _valueCount; c++) {
+      values[c] = _to[c][idx] + _x[c][idx];
+    }
+  }
+
+  void SpringInstances::getVelocity(size_t idx, CGFloat *velocity) const
+  {
+    for (NSUInteger c = 0; c < _valueCount; c++) {
+      velocity[c] = _v[c][idx];
+    }
+  }
+
+  void SpringInstances::removeAllInstances()
+  {
+    for (NSUInteger c = 0; c < _valueCount; c++) {
+      _x[c].clear();
+      _v[c].clear();
+      _to[c].clear();
+    }
+    _done.clear();
+    _maxX.clear();
+    _v2.clear();
+    _a2.clear();
+    _activeCount = 0;
+    _accumulatedTime = 0;
+  }
+
+  void SpringInstances::advance(CFTimeInterval dt)
+  {
+    const size_t count = _done.size();
+    if (0 == _activeCount) {
+      return;
+    }
+
+    if (dt > maxSolverDt) {
+      // excessive time step, force shut down
+      for (NSUInteger c = 0; c < _valueCount; c++) {
+        std::fill(_x[c].begin(), _x[c].end(), 0.);
+        std::fill(_v[c].begin(), _v[c].end(), 0.);
+      }
+      std::fill(_done.begin(), _done.end(), 1);
+      _activeCount = 0;
+      return;
+    }
+
+    // count fixed steps exactly as the solver accumulates time
+    NSUInteger steps = 0;
+    _accumulatedTime += dt;
+    while (_accumulatedTime >= solverDt) {
+      steps++;
+      _accumulatedTime -= solverDt;
+    }
+    if (0 == steps) {
+      // the solver interpolates between equal states, leaving values unchanged
+      return;
+    }
+    const double alpha = _accumulatedTime / solverDt;
+
+    // previous = M^(steps - 1) y, current = M previous, result interpolates both
+    double previous[2][2];
+    spring_matrix_power(previous, _step, steps - 1);
+    double blend[2][2] = {
+      {alpha * _step[0][0] + (1 - alpha), alpha * _step[0][1]},
+      {alpha * _step[1][0], alpha * _step[1][1] + (1 - alpha)},
+    };
+    double frame[2][2];
+    spring_matrix_multiply(frame, blend, previous);
+
+    // average acceleration of the last step, (M - I) / h applied to previous, for convergence
+    const double h = solverDt;
+    const double a0 = (_step[1][0] * previous[0][0] + (_step[1][1] - 1) * previous[1][0]) / h;
+    const double a1 = (_step[1][0] * previous[0][1] + (_step[1][1] - 1) * previous[1][1]) / h;
+
+    const double f00 = frame[0][0], f01 = frame[0][1], f10 = frame[1][0], f11 = frame[1][1];
+    double *__restrict maxX = _maxX.data();
+    double *__restrict v2 = _v2.data();
+    double *__restrict a2 = _a2.data();
+    std::fill(_maxX.begin(), _maxX.end(), 0.);
+    std::fill(_v2.begin(), _v2.end(), 0.);
+    std::fill(_a2.begin(), _a2.end(), 0.);
+
+    // kernel; branch free so the compiler vectorizes, done instances rest at zero
+    for (NSUInteger c = 0; c < _valueCount; c++) {
+      double *__restrict x = _x[c].data();
+      double *__restrict v = _v[c].data();
+      for (size_t idx = 0; idx < count; idx++) {
+        const double xi = x[idx], vi = v[idx];
+        const double a = a0 * xi + a1 * vi;
+        x[idx] = f00 * xi + f01 * vi;
+        v[idx] = f10 * xi + f11 * vi;
+        maxX[idx] = std::max(maxX[idx], std::abs(x[idx]));
+        v2[idx] += v[idx] * v[idx];
+        a2[idx] += a * a;
+      }
+    }
+
+    converge();
+  }
+
+  void SpringInstances::converge()
+  {
+    const size_t count = _done.size();
+    for (size_t idx = 0; idx < count; idx++) {
+      // see SpringSolver::hasConverged
+      if (_done[idx] || _maxX[idx] >= _tp || _v2[idx] >= _tv || _a2[idx] >= _ta) {
+        continue;
+      }
+
+      // rest on to value
+      for (NSUInteger c = 0; c < _valueCount; c++) {
+        _x[c][idx] = 0;
+        _v[c][idx] = 0;
+      }
+      _done[idx] = 1;
+      _activeCount--;
+    }
+  }
+
+  void SpringInstances::write(const POPMemoryBinding &binding, size_t instanceStride) const
+  {
+    if (!memory_binding_valid(binding)) {
+      return;
+    }
+    if (0 == instanceStride) {
+      instanceStride = binding.count * (0 != binding.stride ? binding.stride : memory_scalar_size(binding.type));
+    }
+
+    const size_t count = _done.size();
+    POPMemoryBinding b = binding;
+    b.count = MIN(b.count, (size_t)_valueCount);
+    CGFloat values[4];
+    for (size_t idx = 0; idx < count; idx++, b.offset += instanceStride) {
+      getValues(idx, values);
+      memory_write(b, values);
+    }
+  }
+
+}
@@ -0,0 +1,110 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef POP_POPSpringInstances_h
+#define POP_POPSpringInstances_h
+
+#include <vector>
+
+#include "POPAnimationKernels.h"
+
+namespace POP {
+
+  /**
+   Springs of up to four values sharing dynamics constants and threshold, such as particles or grid cells. Per instance values are stored as structures of arrays and all instances advance with a single kernel per frame, in place of a solver, state and animator item per spring.
+
+   Instances step like SpringSolver4d with the RK4 integrator. Since the spring equation is linear, a frame of fixed steps and interpolation reduces to one 2x2 matrix per frame, applied to the displacement and velocity of every component. An instance is done once the solver convergence test holds, at which point it rests exactly on its to value.
+   */
+  class SpringInstances
+  {
+  public:
+    SpringInstances(NSUInteger valueCount, double tension, double friction, double mass = 1);
+
+    NSUInteger valueCount() const
+    {
+      return _valueCount;
+    }
+
+    void setConstants(double tension, double friction, double mass);
+
+    void setThreshold(CGFloat threshold);
+
+    size_t count() const
+    {
+      return _done.size();
+    }
+
+    size_t activeCount() const
+    {
+      return _activeCount;
+    }
+
+    /**
+     Adds an instance. Velocity may be NULL. Returns the instance index.
+     */
+    size_t addInstance(const CGFloat *fromValue, const CGFloat *toValue, const CGFloat *velocity = NULL);
+
+    /**
+     Retargets an instance, keeping its current value and velocity. Done instances resume.
+     */
+    void setToValue(size_t idx, const CGFloat *toValue);
+
+    void getValues(size_t idx, CGFloat *values) const;
+
+    void getVelocity(size_t idx, CGFloat *velocity) const;
+
+    bool isDone(size_t idx) const
+    {
+      return 0 != _done[idx];
+    }
+
+    void removeAllInstances();
+
+    /**
+     Advances all instances by dt, as SpringSolver4d::advance does.
+     */
+    void advance(CFTimeInterval dt);
+
+    /**
+     Writes current values of all instances, instance idx to binding offset by idx * instanceStride bytes. A zero stride packs instances, binding count components apart. Invalid bindings are not written.
+     */
+    void write(const POPMemoryBinding &binding, size_t instanceStride) const;
+
+  private:
+    NSUInteger _valueCount;
+    double _k;
+    double _b;
+    double _m;
+    double _tp;
+    double _tv;
+    double _ta;
+    double _step[2][2];
+    CFTimeInterval _accumulatedTime;
+    size_t _activeCount;
+
+    // per component, per instance
+    std::vector<double> _x[4];    // displacement from to value
+    std::vector<double> _v[4];
+    std::vector<double> _to[4];
+
+    // per instance
+    std::vector<uint8_t> _done;
+
+    // per instance convergence terms, reused across frames
+    std::vector<double> _maxX;
+    std::vector<double> _v2;
+    std::vector<double> _a2;
+
+    void updateStep();
+    void converge();
+  };
+
+}
+
+#endif
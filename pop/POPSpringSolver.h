@@ -7,7 +7,9 @@
  of patent rights can be found in the PATENTS file in the same directory.
  */
 
-#import <Foundation/Foundation.h>
+#import <cstring>
+
+#import "POPPlatform.h"
 
 #import "POPVector.h"
 
@@ -32,6 +34,83 @@ namespace POP {
   
   const CFTimeInterval solverDt = 0.001f;
   const CFTimeInterval maxSolverDt = 30.0f;
+
+  // fixed steps per advance beyond which RK4 jumps with transition matrix powers, bounding the cost of frames after a hitch
+  const NSUInteger maxSolverLoopSteps = 100;
+
+  // adaptive step size bounds
+  const CFTimeInterval minAdaptiveSolverDt = 0.00001f;
+  const CFTimeInterval maxAdaptiveSolverDt = 0.1f;
+
+  // adaptive local error tolerance, as a factor of threshold
+  const double adaptiveSolverTolerance = 0.001;
+
+  /**
+   Integration schemes supported by the spring solver.
+   */
+  enum SpringSolverIntegrator
+  {
+    // classic fourth order Runge-Kutta, fixed steps of solverDt
+    kSpringSolverIntegratorRK4,
+    // embedded Dormand-Prince 5(4), step size chosen from threshold derived tolerance
+    kSpringSolverIntegratorDormandPrince,
+    // RK4 steps of solverDt applied as a precomputed transition matrix, matching kSpringSolverIntegratorRK4 to round-off
+    kSpringSolverIntegratorRK4Matrix,
+  };
+
+  /**
+   2x2 matrix product, out may alias a or b.
+   */
+  NS_INLINE void spring_matrix_multiply(double out[2][2], const double a[2][2], const double b[2][2])
+  {
+    const double r00 = a[0][0] * b[0][0] + a[0][1] * b[1][0];
+    const double r01 = a[0][0] * b[0][1] + a[0][1] * b[1][1];
+    const double r10 = a[1][0] * b[0][0] + a[1][1] * b[1][0];
+    const double r11 = a[1][0] * b[0][1] + a[1][1] * b[1][1];
+    out[0][0] = r00;
+    out[0][1] = r01;
+    out[1][0] = r10;
+    out[1][1] = r11;
+  }
+
+  /**
+   Computes m^n by repeated squaring.
+   */
+  NS_INLINE void spring_matrix_power(double out[2][2], const double m[2][2], NSUInteger n)
+  {
+    double result[2][2] = {{1, 0}, {0, 1}};
+    double square[2][2] = {{m[0][0], m[0][1]}, {m[1][0], m[1][1]}};
+    while (0 != n) {
+      if (n & 1) {
+        spring_matrix_multiply(result, result, square);
+      }
+      n >>= 1;
+      if (0 != n) {
+        spring_matrix_multiply(square, square, square);
+      }
+    }
+    memcpy(out, result, sizeof(result));
+  }
+
+  /**
+   Computes the transition matrix of one RK4 step of size h, applied to (p, v) of each component. As the spring equation y' = Ay is linear, with y = (p, v), a step is I + hA + (hA)^2/2 + (hA)^3/6 + (hA)^4/24.
+   */
+  NS_INLINE void spring_step_matrix(double out[2][2], double k, double b, double m, double h)
+  {
+    const double ha[2][2] = {{0, h}, {-h * k / m, -h * b / m}};
+    double term[2][2] = {{1, 0}, {0, 1}};
+    double sum[2][2] = {{1, 0}, {0, 1}};
+    for (int order = 1; order <= 4; order++) {
+      spring_matrix_multiply(term, term, ha);
+      for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+          term[i][j] /= order;
+          sum[i][j] += term[i][j];
+        }
+      }
+    }
+    memcpy(out, sum, sizeof(sum));
+  }
   
   /**
    Templated spring solver class.
@@ -47,19 +126,34 @@ namespace POP {
     double _tv; // threshold velocity
     double _ta; // threshold acceleration
     
+    double _tol; // adaptive local error tolerance
+    
     CFTimeInterval _accumulatedTime;
+    CFTimeInterval _adaptiveDt;
     SSState<T> _lastState;
     T _lastDv;
+    SpringSolverIntegrator _integrator;
+
+    // transition matrix of one step, and of step count - 1 steps for the last two step counts
+    double _step[2][2];
+    double _power[2][2][2];
+    NSUInteger _powerSteps[2];
+    NSUInteger _stepCount;
+    NSUInteger _rejectedStepCount;
     bool _started;
     
   public:
-    SpringSolver(double k, double b, double m = 1) : _k(k), _b(b), _m(m), _started(false)
+    POP_POOL_ALLOCATED
+
+    SpringSolver(double k, double b, double m = 1) : _k(k), _b(b), _m(m), _integrator(kSpringSolverIntegratorRK4), _stepCount(0), _rejectedStepCount(0), _started(false)
     {
       _accumulatedTime = 0;
+      _adaptiveDt = 0;
       _lastState.p = T::Zero();
       _lastState.v = T::Zero();
       _lastDv = T::Zero();
       setThreshold(1.);
+      updateStepMatrix();
     }
     
     ~SpringSolver()
@@ -71,11 +165,93 @@ namespace POP {
       return _started;
     }
     
+    SpringSolverIntegrator integrator()
+    {
+      return _integrator;
+    }
+    
+    void setIntegrator(SpringSolverIntegrator integrator)
+    {
+      _integrator = integrator;
+      _accumulatedTime = 0;
+      _adaptiveDt = 0;
+    }
+    
+    // number of accepted integration steps since reset
+    NSUInteger stepCount()
+    {
+      return _stepCount;
+    }
+    
+    // number of adaptive steps rejected for exceeding tolerance since reset
+    NSUInteger rejectedStepCount()
+    {
+      return _rejectedStepCount;
+    }
+    
     void setConstants(double k, double b, double m)
     {
       _k = k;
       _b = b;
       _m = m;
+      
+      // restart step size control with new dynamics
+      _adaptiveDt = 0;
+
+      updateStepMatrix();
+    }
+
+    void updateStepMatrix()
+    {
+      spring_step_matrix(_step, _k, _b, _m, solverDt);
+
+      // frames at a steady rate alternate between two step counts; start with identities of zero steps
+      for (int idx = 0; idx < 2; idx++) {
+        _powerSteps[idx] = 0;
+        _power[idx][0][0] = _power[idx][1][1] = 1;
+        _power[idx][0][1] = _power[idx][1][0] = 0;
+      }
+    }
+
+    // returns the transition matrix of steps, caching the last two step counts
+    const double (*stepPower(NSUInteger steps))[2]
+    {
+      for (int idx = 0; idx < 2; idx++) {
+        if (steps == _powerSteps[idx]) {
+          return _power[idx];
+        }
+      }
+      _powerSteps[1] = _powerSteps[0];
+      memcpy(_power[1], _power[0], sizeof(_power[0]));
+      _powerSteps[0] = steps;
+      spring_matrix_power(_power[0], _step, steps);
+      return _power[0];
+    }
+
+    /**
+     Advances state by steps RK4 steps and interpolates by alpha towards one more step, as advance does step by step. Step count zero leaves state unchanged.
+     */
+    void integrateMatrix(SSState<T> &state, NSUInteger steps, double alpha)
+    {
+      if (0 == steps) {
+        return;
+      }
+
+      // previous = M^(steps - 1) y, current = M previous
+      const double (*p)[2] = stepPower(steps - 1);
+      SSState<T> previous;
+      previous.p = state.p*p[0][0] + state.v*p[0][1];
+      previous.v = state.p*p[1][0] + state.v*p[1][1];
+
+      SSState<T> current;
+      current.p = previous.p*_step[0][0] + previous.v*_step[0][1];
+      current.v = previous.p*_step[1][0] + previous.v*_step[1][1];
+
+      // average acceleration of the last step, the RK4 weighted derivative
+      _lastDv = (current.v - previous.v) * (1.0 / solverDt);
+      _stepCount += steps;
+
+      state = interpolate(previous, current, alpha);
     }
     
     void setThreshold(double t)
@@ -83,6 +259,7 @@ namespace POP {
       _tp = t / 2;          // half a unit
       _tv = 25.0 * t;       // 5 units per second, squared for comparison
       _ta = 625.0 * t * t;  // 5 units per second squared, squared for comparison
+      _tol = adaptiveSolverTolerance * t;
     }
     
     T acceleration(const SSState<T> &state, double t)
@@ -123,6 +300,99 @@ namespace POP {
       state.v = state.v + dvdt*dt;
       
       _lastDv = dvdt;
+      _stepCount++;
+    }
+    
+    SSState<T> stage(const SSState<T> &y, double h, const SSDerivative<T> *k, const double *a, size_t count)
+    {
+      SSState<T> state = y;
+      for (size_t idx = 0; idx < count; idx++) {
+        if (0 != a[idx]) {
+          state.p = state.p + k[idx].dp*(h*a[idx]);
+          state.v = state.v + k[idx].dv*(h*a[idx]);
+        }
+      }
+      return state;
+    }
+    
+    double errorRatio(const SSState<T> &y, const SSState<T> &y1, const SSState<T> &e)
+    {
+      // mixed absolute, relative error norm; values <= 1 are accepted
+      double ratio = 0;
+      for (size_t idx = 0; idx < y.p.size(); idx++) {
+        double sp = _tol + _tol * MAX(fabs(y.p(idx)), fabs(y1.p(idx)));
+        double sv = _tol + _tol * MAX(fabs(y.v(idx)), fabs(y1.v(idx)));
+        ratio = MAX(ratio, MAX(fabs(e.p(idx)) / sp, fabs(e.v(idx)) / sv));
+      }
+      return ratio;
+    }
+    
+    /**
+     Integrates state over exactly dt using the Dormand-Prince 5(4) pair, adjusting the step size to keep the estimated local error within tolerance. The last accepted step size is kept as the starting guess for the next call.
+     */
+    void integrateAdaptive(SSState<T> &state, double t, double dt)
+    {
+      static const double c[7] = {0, 1./5., 3./10., 4./5., 8./9., 1., 1.};
+      static const double a[7][6] = {
+        {0, 0, 0, 0, 0, 0},
+        {1./5., 0, 0, 0, 0, 0},
+        {3./40., 9./40., 0, 0, 0, 0},
+        {44./45., -56./15., 32./9., 0, 0, 0},
+        {19372./6561., -25360./2187., 64448./6561., -212./729., 0, 0},
+        {9017./3168., -355./33., 46732./5247., 49./176., -5103./18656., 0},
+        {35./384., 0, 500./1113., 125./192., -2187./6784., 11./84.},
+      };
+      // difference between fifth and fourth order weights
+      static const double e[7] = {71./57600., 0, -71./16695., 71./1920., -17253./339200., 22./525., -1./40.};
+      
+      double h = _adaptiveDt;
+      if (h <= 0) {
+        // start near the spring period to let the controller settle quickly
+        h = MIN(maxAdaptiveSolverDt, 0.1 / sqrt(MAX(_k / _m, 1.)));
+      }
+      
+      SSDerivative<T> k[7];
+      k[0] = evaluate(state, t);
+      
+      double remaining = dt;
+      while (remaining > 0) {
+        double step = MIN(h, remaining);
+        
+        for (size_t idx = 1; idx < 7; idx++) {
+          k[idx] = evaluate(stage(state, step, k, a[idx], idx), t + c[idx] * step);
+        }
+        
+        // the seventh stage is evaluated at the fifth order solution
+        SSState<T> next = stage(state, step, k, a[6], 6);
+        SSState<T> error = stage(SSState<T>{T::Zero(), T::Zero()}, step, k, e, 7);
+        double ratio = errorRatio(state, next, error);
+        
+        // step size controller, safety factor and growth limits
+        double factor = 0 == ratio ? 5. : MIN(5., MAX(0.2, 0.9 * pow(ratio, -0.2)));
+        
+        if (ratio <= 1. || step <= minAdaptiveSolverDt) {
+          state = next;
+          t += step;
+          remaining -= step;
+          _lastDv = k[6].dv;
+          _stepCount++;
+          
+          // first same as last
+          k[0] = k[6];
+          
+          // only grow step from full steps, avoid shrinking on frame remainders
+          if (step == h || factor < 1.) {
+            h = step * factor;
+          }
+        } else {
+          _rejectedStepCount++;
+          h = step * factor;
+        }
+        
+        h = MIN(maxAdaptiveSolverDt, MAX(minAdaptiveSolverDt, h));
+      }
+      
+      _adaptiveDt = h;
     }
     
     SSState<T> interpolate(const SSState<T> &previous, const SSState<T> &current, double alpha)
@@ -140,6 +410,23 @@ namespace POP {
       if (dt > maxSolverDt) {
         // excessive time step, force shut down
         _lastDv = _lastState.v = _lastState.p = T::Zero();
+      } else if (kSpringSolverIntegratorDormandPrince == _integrator) {
+        this->integrateAdaptive(state, t, dt);
+        _lastState = state;
+      } else if (kSpringSolverIntegratorRK4Matrix == _integrator || _accumulatedTime + dt >= (maxSolverLoopSteps + 1) * solverDt) {
+        // count steps exactly as the loop below accumulates time, and in constant time over long gaps
+        NSUInteger steps = 0;
+        _accumulatedTime += dt;
+        if (_accumulatedTime >= (maxSolverLoopSteps + 1) * solverDt) {
+          steps = (NSUInteger)(_accumulatedTime / solverDt) - 1;
+          _accumulatedTime -= steps * solverDt;
+        }
+        while (_accumulatedTime >= solverDt) {
+          steps++;
+          _accumulatedTime -= solverDt;
+        }
+        this->integrateMatrix(state, steps, _accumulatedTime / solverDt);
+        _lastState = state;
       } else {
         _accumulatedTime += dt;
         
@@ -155,6 +442,117 @@ namespace POP {
       }
     }
     
+    /**
+     Returns the envelope bounds of position, velocity and acceleration magnitude for a single component at time t, given its initial position and velocity. Bounds hold for the exact solution of the spring equation.
+     */
+    void envelope(double p0, double v0, double t, double &bp, double &bv, double &ba)
+    {
+      double w0 = sqrt(_k / _m);
+      double z = _b / (2 * sqrt(_k * _m));
+      
+      if (fabs(z - 1) < 1e-6) {
+        // critically damped, p = (c1 + c2 t) e^(-w0 t)
+        double c1 = fabs(p0), c2 = fabs(v0 + w0 * p0);
+        double e = exp(-w0 * t);
+        bp = (c1 + c2 * t) * e;
+        bv = (c2 + w0 * (c1 + c2 * t)) * e;
+        ba = (2 * w0 * c2 + w0 * w0 * (c1 + c2 * t)) * e;
+      } else if (z < 1) {
+        // underdamped, oscillation of amplitude r within a decaying exponential envelope
+        double wd = w0 * sqrt(1 - z * z);
+        double c2 = (v0 + z * w0 * p0) / wd;
+        double r = sqrt(p0 * p0 + c2 * c2) * exp(-z * w0 * t);
+        bp = r;
+        bv = r * w0;
+        ba = r * w0 * w0;
+      } else {
+        // overdamped, sum of two decaying exponentials
+        double d = w0 * sqrt(z * z - 1);
+        double r1 = -z * w0 + d, r2 = -z * w0 - d;
+        double c2 = (v0 - r1 * p0) / (r2 - r1), c1 = p0 - c2;
+        double e1 = fabs(c1) * exp(r1 * t), e2 = fabs(c2) * exp(r2 * t);
+        bp = e1 + e2;
+        bv = e1 * fabs(r1) + e2 * fabs(r2);
+        ba = e1 * r1 * r1 + e2 * r2 * r2;
+      }
+    }
+    
+    // ratio of state envelope to convergence thresholds at time t; values below 1 are converged
+    double envelopeRatio(const SSState<T> &state, double t)
+    {
+      double ratio = 0, v2 = 0, a2 = 0;
+      for (size_t idx = 0; idx < state.p.size(); idx++) {
+        double bp, bv, ba;
+        envelope(state.p(idx), state.v(idx), t, bp, bv, ba);
+        ratio = MAX(ratio, bp / _tp);
+        v2 += bv * bv;
+        a2 += ba * ba;
+      }
+      return MAX(ratio, MAX(v2 / _tv, a2 / _ta));
+    }
+    
+    /**
+     Returns an upper bound of the position magnitude of any component from state onwards, for the exact solution of the spring equation. Returns INFINITY for springs without stiffness.
+     */
+    double maximumDisplacement(const SSState<T> &state)
+    {
+      if (_k <= 0 || _m <= 0 || _b < 0) {
+        return INFINITY;
+      }
+
+      double w0 = sqrt(_k / _m);
+      double z = _b / (2 * sqrt(_k * _m));
+      double bound = 0;
+      for (size_t idx = 0; idx < state.p.size(); idx++) {
+        double bp, bv, ba;
+        envelope(state.p(idx), state.v(idx), 0, bp, bv, ba);
+        if (fabs(z - 1) < 1e-6) {
+          // critically damped envelope peaks after t = 0, c2 t e^(-w0 t) at most c2 / (e w0)
+          bp += fabs(state.v(idx) + w0 * state.p(idx)) / (M_E * w0);
+        }
+        // other envelopes only decay
+        bound = MAX(bound, bp);
+      }
+      return bound;
+    }
+
+    /**
+     Returns an estimate of the time, in seconds, until a spring starting from state satisfies hasConverged(). The estimate is derived from the analytic envelope of the spring equation and is an upper bound of the convergence time of the exact solution. Returns INFINITY for springs without damping, and for springs the envelope does not settle within maxSolverDt.
+     */
+    CFTimeInterval settlingTime(const SSState<T> &state)
+    {
+      if (_k <= 0 || _m <= 0 || _b <= 0 || _tp <= 0) {
+        return INFINITY;
+      }
+      
+      if (envelopeRatio(state, 0) < 1) {
+        return 0;
+      }
+      
+      // bracket, starting from the slowest decay time constant
+      double w0 = sqrt(_k / _m);
+      double z = _b / (2 * sqrt(_k * _m));
+      double lo = 0, hi = z < 1 ? 1. / (z * w0) : 1. / (z * w0 - w0 * sqrt(MAX(z * z - 1, 0.)));
+      while (envelopeRatio(state, hi) >= 1) {
+        lo = hi;
+        hi *= 2;
+        if (hi > maxSolverDt) {
+          return INFINITY;
+        }
+      }
+      
+      // bisect to within a solver step
+      while (hi - lo > solverDt) {
+        double mid = (lo + hi) / 2;
+        if (envelopeRatio(state, mid) < 1) {
+          hi = mid;
+        } else {
+          lo = mid;
+        }
+      }
+      return hi;
+    }
+    
     bool hasConverged()
     {
       if (!_started) {
@@ -173,6 +571,9 @@ namespace POP {
     void reset()
     {
       _accumulatedTime = 0;
+      _adaptiveDt = 0;
+      _stepCount = 0;
+      _rejectedStepCount = 0;
       _lastState.p = T::Zero();
       _lastState.v = T::Zero();
       _lastDv = T::Zero();
@@ -186,5 +587,33 @@ namespace POP {
   typedef SpringSolver<Vector2d> SpringSolver2d;
   typedef SpringSolver<Vector3d> SpringSolver3d;
   typedef SpringSolver<Vector4d> SpringSolver4d;
+
+  /**
+   Exact position and velocity at time t of the spring p'' = -k/m p - b/m p', released from p0 with velocity v0. Reference for solver accuracy.
+   */
+  inline void spring_exact(double k, double b, double m, double p0, double v0, double t, double &p, double &v)
+  {
+    double w0 = sqrt(k / m);
+    double z = b / (2 * sqrt(k * m));
+
+    if (z < 1) {
+      double wd = w0 * sqrt(1 - z * z);
+      double c1 = p0, c2 = (v0 + z * w0 * p0) / wd;
+      double e = exp(-z * w0 * t), c = cos(wd * t), s = sin(wd * t);
+      p = e * (c1 * c + c2 * s);
+      v = e * (-z * w0 * (c1 * c + c2 * s) + wd * (c2 * c - c1 * s));
+    } else if (z > 1) {
+      double d = w0 * sqrt(z * z - 1);
+      double r1 = -z * w0 + d, r2 = -z * w0 - d;
+      double c2 = (v0 - r1 * p0) / (r2 - r1), c1 = p0 - c2;
+      p = c1 * exp(r1 * t) + c2 * exp(r2 * t);
+      v = c1 * r1 * exp(r1 * t) + c2 * r2 * exp(r2 * t);
+    } else {
+      double c1 = p0, c2 = v0 + w0 * p0;
+      double e = exp(-w0 * t);
+      p = (c1 + c2 * t) * e;
+      v = (c2 - w0 * (c1 + c2 * t)) * e;
+    }
+  }
 }
 
@@ -0,0 +1,163 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#ifndef POPTRACEBUFFER_H
+#define POPTRACEBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace POP {
+
+  /**
+   Fixed size trace record. Type values correspond to POPAnimationEventType or TraceRecordType.
+   */
+  struct TraceRecord
+  {
+    double time;
+    uint32_t animationID;
+    uint16_t type;
+    uint8_t valueType;
+    uint8_t valueCount; // count of original values, at most 4 recorded
+    float values[4];
+  };
+
+  static_assert(sizeof(TraceRecord) == 32, "unexpected trace record size");
+
+  static const size_t kTraceRecordMaxValues = 4;
+
+  /**
+   Animator record types, following POPAnimationEventType values. Timed in media time rather than animation time.
+   */
+  enum TraceRecordType : uint16_t
+  {
+    kTraceRecordFrameBegin = 0x100,
+    kTraceRecordFrameEnd,   // values: animation count
+    kTraceRecordAdd,
+    kTraceRecordStep,       // values: duration, animation time
+  };
+
+  /**
+   Fixed capacity ring buffer of trace records. Lock free; any number of threads may record while another copies records out. Once full, the oldest records are overwritten.
+   */
+  class TraceBuffer
+  {
+    struct Slot
+    {
+      // 2n + 1 while record n is written, 2n + 2 once complete
+      std::atomic<uint64_t> sequence;
+      TraceRecord record;
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    uint64_t _mask;
+    std::atomic<uint64_t> _head;
+
+  public:
+    // capacity is rounded up to a power of two
+    explicit TraceBuffer(size_t capacity) : _mask(0), _head(0)
+    {
+      size_t size = 1;
+      while (size < capacity) {
+        size <<= 1;
+      }
+      _slots.reset(new Slot[size]);
+      for (size_t idx = 0; idx < size; idx++) {
+        _slots[idx].sequence.store(0, std::memory_order_relaxed);
+      }
+      _mask = size - 1;
+    }
+
+    size_t capacity() const {
+      return (size_t)_mask + 1;
+    }
+
+    // total records recorded, including overwritten ones
+    uint64_t recordedCount() const {
+      return _head.load(std::memory_order_relaxed);
+    }
+
+    // records overwritten before being copied out
+    uint64_t droppedCount() const {
+      uint64_t head = recordedCount();
+      return head > capacity() ? head - capacity() : 0;
+    }
+
+    template <typename T>
+    void record(uint16_t type, uint32_t animationID, double time, uint8_t valueType = 0, const T *values = NULL, size_t count = 0)
+    {
+      const uint64_t n = _head.fetch_add(1, std::memory_order_relaxed);
+      Slot &slot = _slots[n & _mask];
+
+      slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      TraceRecord &r = slot.record;
+      r.time = time;
+      r.animationID = animationID;
+      r.type = type;
+      r.valueType = valueType;
+      r.valueCount = (uint8_t)(count < 255 ? count : 255);
+      for (size_t idx = 0; idx < kTraceRecordMaxValues; idx++) {
+        r.values[idx] = idx < count ? (float)values[idx] : 0.f;
+      }
+
+      slot.sequence.store(2 * n + 2, std::memory_order_release);
+    }
+
+    void record(uint16_t type, uint32_t animationID, double time)
+    {
+      record<float>(type, animationID, time);
+    }
+
+    // appends records oldest first, skipping any torn by concurrent writers; returns count appended
+    size_t copyRecords(std::vector<TraceRecord> &out) const
+    {
+      const uint64_t head = _head.load(std::memory_order_acquire);
+      const uint64_t begin = head > capacity() ? head - capacity() : 0;
+      size_t count = 0;
+
+      for (uint64_t n = begin; n < head; n++) {
+        const Slot &slot = _slots[n & _mask];
+        if (slot.sequence.load(std::memory_order_acquire) != 2 * n + 2) {
+          continue;
+        }
+
+        TraceRecord r;
+        memcpy(&r, &slot.record, sizeof(r));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (slot.sequence.load(std::memory_order_relaxed) == 2 * n + 2) {
+          out.push_back(r);
+          count++;
+        }
+      }
+      return count;
+    }
+
+    // buffer receiving records; NULL when not recording
+    static std::atomic<TraceBuffer *> &activeBuffer()
+    {
+      static std::atomic<TraceBuffer *> buffer(NULL);
+      return buffer;
+    }
+
+    static TraceBuffer *active()
+    {
+      return activeBuffer().load(std::memory_order_acquire);
+    }
+  };
+
+}
+
+#endif // POPTRACEBUFFER_H
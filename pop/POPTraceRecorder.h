@@ -0,0 +1,83 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class POPAnimation;
+
+/**
+ @abstract Low overhead recorder of animation events across all animations.
+ @discussion Events are recorded as fixed size binary records into a preallocated lock-free ring buffer, without boxing or allocation, making recording suitable for production. Once full, the oldest records are overwritten. Values are recorded as up to 4 floats. Use POPAnimationTracer for full fidelity tracing of individual animations.
+ */
+@interface POPTraceRecorder : NSObject
+
+/**
+ @abstract Designated initializer.
+ @param capacity The number of records retained, rounded up to a power of two.
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/**
+ @abstract The number of records retained.
+ */
+@property (readonly, nonatomic) NSUInteger capacity;
+
+/**
+ @abstract The number of records overwritten since recording began.
+ */
+@property (readonly, nonatomic) NSUInteger droppedCount;
+
+/**
+ @abstract Flag indicating whether the recorder is recording.
+ */
+@property (readonly, nonatomic, getter=isRecording) BOOL recording;
+
+/**
+ @abstract Start recording events, replacing any recorder previously started.
+ */
+- (void)start;
+
+/**
+ @abstract Stop recording events. Call on the thread rendering animations, before releasing the recorder.
+ */
+- (void)stop;
+
+/**
+ @abstract Returns a binary snapshot of recorded events, oldest first.
+ @discussion Safe to call while recording. Decode with eventsFromData:.
+ */
+- (NSData *)data;
+
+/**
+ @abstract Returns a snapshot of recorded events in Chrome Trace Event JSON format.
+ @discussion See chromeTraceDataFromData:.
+ */
+- (NSData *)chromeTraceData;
+
+/**
+ @abstract Returns the identifier recorded with events of an animation.
+ */
++ (NSUInteger)identifierForAnimation:(POPAnimation *)animation;
+
+/**
+ @abstract Decodes a binary snapshot into event streams.
+ @param data The data returned from a recorder.
+ @returns Dictionary of animation identifier to array of POPAnimationEvent instances in order of occurrence, or nil if data is invalid.
+ */
++ (NSDictionary *)eventsFromData:(NSData *)data;
+
+/**
+ @abstract Converts a binary snapshot into Chrome Trace Event JSON, viewable in chrome://tracing or Perfetto.
+ @discussion Animator frames and per-animation steps are complete events, with step duration the cost of advancing and applying the animation. Animation start and stop are async events spanning the animation lifecycle; additions and reaching to value are instant events. Timestamps are CACurrentMediaTime() in microseconds, lining up with other traces of the process.
+ @param data The data returned from a recorder.
+ @returns JSON data, or nil if data is invalid.
+ */
++ (NSData *)chromeTraceDataFromData:(NSData *)data;
+
+@end
@@ -0,0 +1,312 @@
+/**
+ Copyright (c) 2014-present, Facebook, Inc.
+ All rights reserved.
+
+ This source code is licensed under the BSD-style license found in the
+ LICENSE file in the root directory of this source tree. An additional grant
+ of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#import "POPTraceRecorder.h"
+
+#import <unordered_map>
+
+#import "POPAnimationEventInternal.h"
+#import "POPAnimationInternal.h"
+#import "POPAnimationRuntime.h"
+#import "POPTraceBuffer.h"
+
+using namespace POP;
+
+// binary snapshot header
+typedef struct
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;
+  uint64_t count;
+} POPTraceHeader;
+
+static const uint32_t kPOPTraceMagic = 'POPT';
+static const uint16_t kPOPTraceVersion = 1;
+
+// returns records of a valid snapshot, else NULL
+static const TraceRecord *decode_records(NSData *data, uint64_t *outCount)
+{
+  POPTraceHeader header;
+  if (data.length < sizeof(header)) {
+    return NULL;
+  }
+
+  [data getBytes:&header length:sizeof(header)];
+  if (kPOPTraceMagic != header.magic || kPOPTraceVersion != header.version || sizeof(TraceRecord) != header.recordSize || data.length != sizeof(header) + header.count * sizeof(TraceRecord)) {
+    return NULL;
+  }
+
+  *outCount = header.count;
+  return (const TraceRecord *)((const uint8_t *)data.bytes + sizeof(header));
+}
+
+// chrome trace timestamps are in microseconds
+static NSNumber *trace_timestamp(CFTimeInterval time)
+{
+  return @(time * 1e6);
+}
+
+static NSMutableDictionary *trace_event(NSString *name, NSString *phase, CFTimeInterval time)
+{
+  return [@{@"name" : name, @"cat" : @"pop", @"ph" : phase, @"ts" : trace_timestamp(time), @"pid" : @([NSProcessInfo processInfo].processIdentifier), @"tid" : @0} mutableCopy];
+}
+
+static NSString *trace_animation_name(uint32_t animationID)
+{
+  return [NSString stringWithFormat:@"animation %u", animationID];
+}
+
+// lifecycle event of an animation step, or nil
+static NSDictionary *trace_lifecycle_event(const TraceRecord &r, CFTimeInterval beginTime, CFTimeInterval endTime)
+{
+  NSMutableDictionary *event;
+  switch (r.type) {
+    case kPOPAnimationEventDidStart:
+      event = trace_event(trace_animation_name(r.animationID), @"b", beginTime);
+      break;
+    case kPOPAnimationEventDidReachToValue:
+      event = trace_event(@"reach to value", @"n", endTime);
+      break;
+    case kPOPAnimationEventDidStop:
+      event = trace_event(trace_animation_name(r.animationID), @"e", endTime);
+      event[@"args"] = @{@"finished" : @(0 != r.values[0])};
+      break;
+    default:
+      return nil;
+  }
+  event[@"id"] = @(r.animationID);
+  return event;
+}
+
+static id decode_value(const TraceRecord &r)
+{
+  if (0 == r.valueCount) {
+    return nil;
+  }
+
+  NSUInteger count = MIN(r.valueCount, kTraceRecordMaxValues);
+  CGFloat values[kTraceRecordMaxValues];
+  for (NSUInteger idx = 0; idx < count; idx++) {
+    values[idx] = r.values[idx];
+  }
+
+  // truncated values cannot be boxed as their original type
+  if (r.valueCount > kTraceRecordMaxValues) {
+    NSMutableArray *array = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger idx = 0; idx < count; idx++) {
+      [array addObject:@(values[idx])];
+    }
+    return array;
+  }
+
+  VectorConstRef vec(Vector::new_vector(count, values));
+  return POPBox(vec, (POPValueType)r.valueType, true);
+}
+
+@implementation POPTraceRecorder
+{
+  std::unique_ptr<TraceBuffer> _buffer;
+}
+
+- (instancetype)init
+{
+  return [self initWithCapacity:4096];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+  self = [super init];
+  if (nil != self) {
+    _buffer.reset(new TraceBuffer(MAX(capacity, (NSUInteger)1)));
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  [self stop];
+}
+
+- (NSUInteger)capacity
+{
+  return _buffer->capacity();
+}
+
+- (NSUInteger)droppedCount
+{
+  return (NSUInteger)_buffer->droppedCount();
+}
+
+- (BOOL)isRecording
+{
+  return TraceBuffer::active() == _buffer.get();
+}
+
+- (void)start
+{
+  TraceBuffer::activeBuffer().store(_buffer.get(), std::memory_order_release);
+}
+
+- (void)stop
+{
+  TraceBuffer *buffer = _buffer.get();
+  TraceBuffer::activeBuffer().compare_exchange_strong(buffer, NULL);
+}
+
+- (NSData *)data
+{
+  std::vector<TraceRecord> records;
+  records.reserve(_buffer->capacity());
+  _buffer->copyRecords(records);
+
+  POPTraceHeader header = {kPOPTraceMagic, kPOPTraceVersion, sizeof(TraceRecord), records.size()};
+  NSMutableData *data = [NSMutableData dataWithCapacity:sizeof(header) + records.size() * sizeof(TraceRecord)];
+  [data appendBytes:&header length:sizeof(header)];
+  if (!records.empty()) {
+    [data appendBytes:records.data() length:records.size() * sizeof(TraceRecord)];
+  }
+  return data;
+}
+
++ (NSUInteger)identifierForAnimation:(POPAnimation *)animation
+{
+  return nil != animation ? POPAnimationGetState(animation)->ID : 0;
+}
+
++ (NSDictionary *)eventsFromData:(NSData *)data
+{
+  uint64_t count = 0;
+  const TraceRecord *records = decode_records(data, &count);
+  if (NULL == records) {
+    return nil;
+  }
+
+  NSMutableDictionary *streams = [NSMutableDictionary dictionary];
+
+  for (uint64_t idx = 0; idx < count; idx++) {
+    const TraceRecord &r = records[idx];
+    if (r.type >= kTraceRecordFrameBegin) {
+      continue;
+    }
+
+    POPAnimationEvent *event;
+    id value = decode_value(r);
+    if (nil == value) {
+      event = [[POPAnimationEvent alloc] initWithType:(POPAnimationEventType)r.type time:r.time];
+    } else {
+      event = [[POPAnimationValueEvent alloc] initWithType:(POPAnimationEventType)r.type time:r.time value:value];
+    }
+
+    NSNumber *key = @(r.animationID);
+    NSMutableArray *stream = streams[key];
+    if (nil == stream) {
+      stream = [NSMutableArray array];
+      streams[key] = stream;
+    }
+    [stream addObject:event];
+  }
+
+  return streams;
+}
+
+- (NSData *)chromeTraceData
+{
+  return [POPTraceRecorder chromeTraceDataFromData:[self data]];
+}
+
++ (NSData *)chromeTraceDataFromData:(NSData *)data
+{
+  uint64_t count = 0;
+  const TraceRecord *records = decode_records(data, &count);
+  if (NULL == records) {
+    return nil;
+  }
+
+  NSMutableArray *events = [NSMutableArray array];
+  NSMutableDictionary *thread = trace_event(@"thread_name", @"M", 0);
+  thread[@"args"] = @{@"name" : @"POPAnimator"};
+  [events addObject:thread];
+
+  // lifecycle events carry animation time; place them at the media time of the step they occur in
+  std::unordered_map<uint32_t, std::vector<TraceRecord>> pending;
+  CFTimeInterval frameBeginTime = 0;
+  CFTimeInterval lastTime = 0;
+
+  for (uint64_t idx = 0; idx < count; idx++) {
+    const TraceRecord &r = records[idx];
+
+    switch (r.type) {
+      case kTraceRecordFrameBegin:
+        frameBeginTime = r.time;
+        lastTime = r.time;
+        break;
+      case kTraceRecordFrameEnd:
+        // skip frames whose beginning was overwritten
+        if (0 != frameBeginTime) {
+          NSMutableDictionary *event = trace_event(@"frame", @"X", frameBeginTime);
+          event[@"dur"] = trace_timestamp(r.time - frameBeginTime);
+          event[@"args"] = @{@"animations" : @(r.values[0])};
+          [events addObject:event];
+        }
+        frameBeginTime = 0;
+        lastTime = r.time;
+        break;
+      case kTraceRecordAdd: {
+        NSMutableDictionary *event = trace_event(@"add", @"i", r.time);
+        event[@"s"] = @"t";
+        event[@"args"] = @{@"id" : @(r.animationID)};
+        [events addObject:event];
+        lastTime = r.time;
+        break;
+      }
+      case kTraceRecordStep: {
+        const CFTimeInterval endTime = r.time + r.values[0];
+        NSMutableDictionary *event = trace_event(trace_animation_name(r.animationID), @"X", r.time);
+        event[@"dur"] = trace_timestamp(r.values[0]);
+        event[@"args"] = @{@"id" : @(r.animationID), @"time" : @(r.values[1])};
+        [events addObject:event];
+
+        auto iter = pending.find(r.animationID);
+        if (iter != pending.end()) {
+          for (const TraceRecord &p : iter->second) {
+            NSDictionary *lifecycle = trace_lifecycle_event(p, r.time, endTime);
+            if (nil != lifecycle) {
+              [events addObject:lifecycle];
+            }
+          }
+          pending.erase(iter);
+        }
+        lastTime = endTime;
+        break;
+      }
+      case kPOPAnimationEventDidStart:
+      case kPOPAnimationEventDidReachToValue:
+      case kPOPAnimationEventDidStop:
+        pending[r.animationID].push_back(r);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // events outside of steps, such as removals, are placed at the last known time
+  for (const auto &entry : pending) {
+    for (const TraceRecord &p : entry.second) {
+      NSDictionary *lifecycle = trace_lifecycle_event(p, lastTime, lastTime);
+      if (nil != lifecycle) {
+        [events addObject:lifecycle];
+      }
+    }
+  }
+
+  return [NSJSONSerialization dataWithJSONObject:@{@"traceEvents" : events, @"displayTimeUnit" : @"ms"} options:0 error:NULL];
+}
+
+@end
@@ -10,14 +10,13 @@
 #ifndef __POP__FBVector__
 #define __POP__FBVector__
 
+#include <atomic>
 #include <iostream>
+#include <memory>
 #include <vector>
 
-#import <objc/NSObjCRuntime.h>
-
-#import <CoreGraphics/CoreGraphics.h>
-
 #import "POPDefines.h"
+#import "POPPlatform.h"
 
 #if SCENEKIT_SDK_AVAILABLE
 #import <SceneKit/SceneKit.h>
@@ -28,9 +27,24 @@
 #endif
 
 #import "POPMath.h"
+#import "POPPool.h"
 
 namespace POP {
 
+  /**
+   Count of enabled animator metrics recorders. Process wide counters sampled by metrics, such as vector allocations, advance only while nonzero, costing hot paths a relaxed load otherwise.
+   */
+  inline std::atomic<int> &metricsCounterClients()
+  {
+    static std::atomic<int> count(0);
+    return count;
+  }
+
+  inline bool metricsCountersEnabled()
+  {
+    return metricsCounterClients().load(std::memory_order_relaxed) > 0;
+  }
+
   /** Fixed two-size vector class */
   template <typename T>
   struct Vector2
@@ -295,6 +309,9 @@ namespace POP {
   public:
     ~Vector();
 
+    // Vectors and their values are pool allocated
+    POP_POOL_ALLOCATED
+
     // Creates a new vector instance of count with values. Initializing a vector of size 0 returns NULL.
     static Vector *new_vector(NSUInteger count, const CGFloat *values);
 
@@ -307,6 +324,9 @@ namespace POP {
     // Size of vector
     NSUInteger size() const { return _count; }
 
+    // Count of vectors allocated while metrics counters are enabled
+    static uint64_t allocationCount();
+
     // Returns array of values
     CGFloat *data () { return _values; }
     const CGFloat *data () const { return _values; };
@@ -342,9 +362,11 @@ namespace POP {
     CGAffineTransform cg_affine_transform() const;
     static Vector *new_cg_affine_transform(const CGAffineTransform &t);
 
+#ifdef __OBJC__
     // CGColorRef support
     CGColorRef cg_color() const CF_RETURNS_RETAINED;
     static Vector *new_cg_color(CGColorRef color);
+#endif
     
 #if SCENEKIT_SDK_AVAILABLE
     // SCNVector3 support
@@ -369,8 +391,10 @@ namespace POP {
     // Round to nearest sub
     void subRound(CGFloat sub);
 
+#ifdef __OBJC__
     // Returns string description
     NSString * toString() const;
+#endif
 
     // Operator overloads
     template<typename U> Vector& operator= (const Vector4<U>& other) {
@@ -386,8 +410,19 @@ namespace POP {
     bool operator!=(const Vector &other) const;
   };
 
+  /** Shared vector, allocating its control block from pools */
+  class VectorRef : public std::shared_ptr<Vector>
+  {
+  public:
+    VectorRef() {}
+    VectorRef(std::nullptr_t) {}
+
+    // a template like the shared_ptr constructor, so that NULL selects the constructor above
+    template <typename T>
+    explicit VectorRef(T *vec) : std::shared_ptr<Vector>(vec, std::default_delete<Vector>(), PoolAllocator<Vector>()) {}
+  };
+
   /** Convenience typedefs */
-  typedef std::shared_ptr<Vector> VectorRef;
   typedef std::shared_ptr<const Vector> VectorConstRef;
 
 }
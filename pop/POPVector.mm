@@ -9,22 +9,43 @@
 
 #import "POPVector.h"
 
+#import <atomic>
+
 #import "POPDefines.h"
+
+#ifdef __OBJC__
 #import "POPCGUtils.h"
+#endif
 
 namespace POP
 {
 
+  static std::atomic<uint64_t> _allocationCount(0);
+
+  uint64_t Vector::allocationCount()
+  {
+    return _allocationCount.load(std::memory_order_relaxed);
+  }
+
   Vector::Vector(const size_t count)
   {
+    if (metricsCountersEnabled()) {
+      _allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
     _count = count;
-    _values = 0 != count ? (CGFloat *)calloc(count, sizeof(CGFloat)) : NULL;
+    _values = 0 != count ? (CGFloat *)pool_new(count * sizeof(CGFloat)) : NULL;
+    if (0 != count) {
+      memset(_values, 0, count * sizeof(CGFloat));
+    }
   }
 
   Vector::Vector(const Vector& other)
   {
+    if (metricsCountersEnabled()) {
+      _allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
     _count = other.size();
-    _values = 0 != _count ? (CGFloat *)calloc(_count, sizeof(CGFloat)) : NULL;
+    _values = 0 != _count ? (CGFloat *)pool_new(_count * sizeof(CGFloat)) : NULL;
     if (0 != _count) {
       memcpy(_values, other.data(), _count * sizeof(CGFloat));
     }
@@ -33,7 +54,7 @@ namespace POP
   Vector::~Vector()
   {
     if (NULL != _values) {
-      free(_values);
+      pool_deallocate(_values, _count * sizeof(CGFloat));
       _values = NULL;
     }
     _count = 0;
@@ -238,6 +259,7 @@ namespace POP
     return v;
   }
 
+#ifdef __OBJC__
   CGColorRef Vector::cg_color() const
   {
     if (_count < 4) {
@@ -252,6 +274,7 @@ namespace POP
     POPCGColorGetRGBAComponents(color, rgba);
     return new_vector(4, rgba);
   }
+#endif
   
 #if SCENEKIT_SDK_AVAILABLE
   SCNVector3 Vector::scn_vector3() const
@@ -305,6 +328,7 @@ namespace POP
     return d;
   }
 
+#ifdef __OBJC__
   NSString * Vector::toString() const
   {
     if (0 == _count)
@@ -331,4 +355,5 @@ namespace POP
     return s;
 
   }
+#endif
 }
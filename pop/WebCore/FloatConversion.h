@@ -29,7 +29,11 @@
 #ifndef FloatConversion_h
 #define FloatConversion_h
 
+#if defined(__APPLE__)
 #include <CoreGraphics/CGBase.h>
+#else
+#include "POPPlatform.h"
+#endif
 
 namespace WebCore {
 
@@ -512,6 +512,7 @@ namespace WebCore {
   
   // End of Supporting Math Functions
   
+#if defined(__APPLE__)
   TransformationMatrix::TransformationMatrix(const CGAffineTransform& t)
   {
     setMatrix(t.a, t.b, t.c, t.d, t.tx, t.ty);
@@ -564,6 +565,7 @@ namespace WebCore {
   {
     return transform3d();
   }
+#endif
   
   TransformationMatrix& TransformationMatrix::scale(double s)
   {
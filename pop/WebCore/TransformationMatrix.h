@@ -28,9 +28,11 @@
 
 #include <string.h> //for memcpy
 
+#if defined(__APPLE__)
 #include <CoreGraphics/CGAffineTransform.h>
 
 #include <QuartzCore/QuartzCore.h>
+#endif
 
 namespace WebCore {
 
@@ -265,6 +267,7 @@ namespace WebCore {
       return result;
     }
 
+#if defined(__APPLE__)
     CATransform3D transform3d () const;
     CGAffineTransform affineTransform () const;
 
@@ -273,6 +276,7 @@ namespace WebCore {
 
     TransformationMatrix(const CGAffineTransform&);
     operator CGAffineTransform() const;
+#endif
 
   private:
 
@@ -282,10 +286,13 @@ namespace WebCore {
     // multiply passed 3D point by matrix
     void multVecMatrix(double x, double y, double z, double& dstX, double& dstY, double& dstZ) const;
 
-    void setMatrix(const Matrix4 m)
+    // copies by row; GCC's -Wstringop-overflow mistakes a memcpy of the whole matrix for one overflowing its first row
+    void setMatrix(const Matrix4& m)
     {
-      if (m && m != m_matrix)
-        memcpy(m_matrix, m, sizeof(Matrix4));
+      if (&m != &m_matrix) {
+        for (int row = 0; row < 4; row++)
+          memcpy(m_matrix[row], m[row], sizeof(m_matrix[row]));
+      }
     }
 
     bool isIdentityOrTranslation() const